@@ -110,7 +110,7 @@ NAByte na_pixelFont5x9[(5*16/8)*9*6] = {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
     glBindTexture(GL_TEXTURE_2D, 0);
-    free(texBuf);
+    naFree(texBuf);
     return (NAInt)fontTex;
   }
 
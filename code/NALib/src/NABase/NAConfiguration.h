@@ -239,6 +239,154 @@
   #define NA_MEMORY_POOL_AGGRESSIVE_CLEANUP 0
 #endif
 
+// Define if memory pools shall be usable from multiple threads.
+//
+// By default, the runtime system assumes that naNew, naCreate, naDelete,
+// naRetain and naRelease are only called from one single thread. If set to 1,
+// each thread gets its own pool parts for every type and allocates from them
+// without any locking. Pointers deleted on a different thread than the one
+// which allocated them are handed back to the owning thread lock-free.
+//
+// When set to 1, NALib needs NAThreading for the runtime system and the
+// aggressive cleanup will only free the memory but keep the types registered.
+//
+// Default is 0
+
+#ifndef NA_MEMORY_POOL_THREAD_SAFE
+  #define NA_MEMORY_POOL_THREAD_SAFE 0
+#endif
+
+// Define how many empty pool parts shall be kept for later reuse.
+//
+// Whenever a pool part becomes empty, it is usually freed right away. When
+// objects are created and deleted around the boundary of a part, for example
+// when pushing and popping a few list elements, this results in allocating
+// and freeing the same aligned chunk of memory over and over again. Empty
+// parts are therefore put into a cache shared by all types until it holds
+// the number of parts defined here. Any type needing a new part will take
+// one from that cache first.
+//
+// Call naTrimRuntimeSpareParts to free all cached parts, for example when
+// your application is idle. If set to 0, parts are freed immediately.
+//
+// The default value is 4 and 0 when NA_MEMORY_POOL_AGGRESSIVE_CLEANUP is 1.
+
+#ifndef NA_MEMORY_POOL_SPARE_PART_COUNT
+  #if NA_MEMORY_POOL_AGGRESSIVE_CLEANUP == 1
+    #define NA_MEMORY_POOL_SPARE_PART_COUNT 0
+  #else
+    #define NA_MEMORY_POOL_SPARE_PART_COUNT 4
+  #endif
+#endif
+
+// Define if pool parts shall be carved out of large reserved address ranges.
+//
+// By default, every pool part is allocated separately with naMallocAligned.
+// With many gigabytes in use, this results in a huge number of small memory
+// mappings and puts a lot of pressure on the TLB of the processor. If this
+// macro is set to a non-zero byte size, the runtime reserves address ranges
+// of that size directly from the system (mmap or VirtualAlloc) and carves
+// the aligned pool parts out of them. The memory of a part which is no longer
+// needed is given back to the system (madvise with MADV_DONTNEED or
+// decommitting) while its address stays reserved for the next part. The
+// address ranges themselves are only released when the runtime stops.
+//
+// The byte size will be rounded up to a multiple of the part size.
+//
+// Default is 0
+
+#ifndef NA_MEMORY_POOL_RESERVE_BYTESIZE
+  #define NA_MEMORY_POOL_RESERVE_BYTESIZE 0
+#endif
+
+// Define if the reserved address ranges shall be backed by huge pages.
+//
+// Only has an effect when NA_MEMORY_POOL_RESERVE_BYTESIZE is non-zero and
+// the system knows transparent huge pages (madvise with MADV_HUGEPAGE). The
+// reserved ranges are then aligned to 2 MB such that the system can back
+// them with huge pages. Note that giving back a single part may split a huge
+// page again.
+//
+// Default is 0
+
+#ifndef NA_MEMORY_POOL_HUGE_PAGES
+  #define NA_MEMORY_POOL_HUGE_PAGES 0
+#endif
+
+// Define if reference counts shall be changed atomically.
+//
+// NARefCount and hence NASmartPtr, NAPointer and all reference-counting
+// runtime types increase and decrease their count with plain arithmetic.
+// Retaining and releasing the same object from multiple threads at the same
+// time therefore is a data race. With this macro, you can choose:
+//
+// 0: All reference counts are plain integers. This is the fastest option.
+// 1: Reference counts initialized with naInitRefCountAtomic or belonging to
+//    a type marked with NA_RUNTIME_TYPE_ATOMIC are changed atomically. All
+//    other reference counts stay plain but need one more bit test.
+// 2: All reference counts are changed atomically.
+//
+// NALib marks NABuffer and NABabyImage along with their internal types as
+// atomic, hence with 1, they can be shared among threads.
+//
+// Default is 0
+
+#ifndef NA_ATOMIC_REFCOUNT
+  #define NA_ATOMIC_REFCOUNT 0
+#endif
+
+// Define if naMalloc shall serve small byte sizes from size classes.
+//
+// If set to 1, naMalloc serves all byte sizes up to 4096 from pool parts of
+// 64 KB which are carved out of an address range reserved from the system,
+// see NA_MALLOC_POOL_RESERVE_BYTESIZE. Every part stores spaces of one size
+// class only and every thread has its own parts, hence no locking is needed
+// in the common case. Larger sizes are served by malloc, as well as all
+// sizes once the address range is exhausted. naFree distinguishes the two by
+// the address of the pointer.
+//
+// Note that with this option, any pointer allocated with naMalloc MUST be
+// freed with naFree, never with free. Threads using naMalloc should call
+// naDetachMallocThread before they end such that their parts can be reused.
+//
+// This option is independent of the runtime system. naMalloc does not need
+// a running runtime.
+//
+// Default is 0
+
+#ifndef NA_MALLOC_SIZE_CLASSES
+  #define NA_MALLOC_SIZE_CLASSES 0
+#endif
+
+// Defines the byte size of the address range reserved for the size classes
+// of naMalloc.
+//
+// Only has an effect when NA_MALLOC_SIZE_CLASSES is 1. The range is reserved
+// upon the first small allocation and never released. Only address space is
+// reserved, memory is used part by part when needed. The byte size will be
+// rounded up to a multiple of 64 KB.
+//
+// Default is 256 MB
+
+#ifndef NA_MALLOC_POOL_RESERVE_BYTESIZE
+  #define NA_MALLOC_POOL_RESERVE_BYTESIZE (1 << 28)
+#endif
+
+// Define if all allocations shall be traced with their call site.
+//
+// If set to 1, naMalloc, naMallocAligned, naMallocPageAligned, naMallocTmp,
+// naNew and naCreate become macros which record every allocation together
+// with __FILE__ and __LINE__ and the type name in case of runtime types.
+// Their counterparts like naFree and naDelete remove the records again. See
+// naPrintMemoryTrace for the output. Tracing is slow and guarded by a global
+// lock. Only use it to find out where memory is allocated and leaked.
+//
+// Default is 0
+
+#ifndef NA_MEMORY_TRACE
+  #define NA_MEMORY_TRACE 0
+#endif
+
 // Defines when the temp garbage collection starts collecting automatically.
 //
 // With this macro, you can define, if and when the garbage collection should
@@ -282,6 +430,43 @@
   #define NA_BUFFER_PART_BYTESIZE 0
 #endif
 
+// Define the read-ahead of buffers reading files:
+//
+// A buffer reading a file which can not be mapped into memory (see
+// naCreateBufferWithInputPath) reads at least NA_BUFFER_FILE_READ_AHEAD_BYTESIZE
+// bytes at once and keeps them for the following buffer parts. The last
+// NA_BUFFER_FILE_READ_AHEAD_COUNT of these read-ahead windows are kept such
+// that alternately reading at different positions of the file does not
+// require reading the same bytes again.
+//
+// The defaults are 65536 and 4
+
+#ifndef NA_BUFFER_FILE_READ_AHEAD_BYTESIZE
+  #define NA_BUFFER_FILE_READ_AHEAD_BYTESIZE 65536
+#endif
+#ifndef NA_BUFFER_FILE_READ_AHEAD_COUNT
+  #define NA_BUFFER_FILE_READ_AHEAD_COUNT 4
+#endif
+
+// Define the automatic compaction of buffers:
+//
+// Buffers built by many small writes consist of many small parts. If this
+// macro is not 0, a buffer with more than NA_BUFFER_COMPACT_PART_COUNT parts
+// gets its small parts coalesced into parts of NA_BUFFER_PART_BYTESIZE when
+// its last iterator is cleared, see naCompactBuffer. The next automatic
+// compaction happens when the number of parts has doubled again.
+//
+// Note that compaction copies the bytes, hence they are no longer shared with
+// buffers they were appended to or extracted from. Also, release builds then
+// count the iterators of a buffer, meaning that creating iterators on the
+// same buffer from multiple threads at once is not safe anymore.
+//
+// The default is 0, meaning buffers are only compacted with naCompactBuffer.
+
+#ifndef NA_BUFFER_COMPACT_PART_COUNT
+  #define NA_BUFFER_COMPACT_PART_COUNT 0
+#endif
+
 
 
 // String caching
@@ -326,6 +511,42 @@
 
 
 
+// ////////////////////////////////
+// Posix threads
+// ////////////////////////////////
+
+// Threads, mutexes and alarms are implemented with WINAPI on Windows and with
+// Grand Central Dispatch on Mac. On all other systems like Linux, posix
+// threads (pthreads) are used.
+//
+// Set this macro to 1 if you want to use posix threads on Mac as well. It has
+// no effect on Windows.
+//
+// Default is 0
+
+#ifndef NA_THREADING_USE_PTHREADS
+  #define NA_THREADING_USE_PTHREADS 0
+#endif
+
+
+
+// ////////////////////////////////
+// Cache line size
+// ////////////////////////////////
+
+// Data written by different threads at the same time is kept apart by at
+// least this many bytes to prevent false sharing of cache lines, for example
+// in the head and tail of NASPSCRing and NAMPMCRing.
+//
+// Default is 64 which is the cache line size of most x86 and ARM processors.
+// Apple Silicon processors use 128.
+
+#ifndef NA_CACHE_LINE_BYTESIZE
+  #define NA_CACHE_LINE_BYTESIZE 64
+#endif
+
+
+
 // ////////////////////////////////
 // Mathematical, chemical and physical constants
 // ////////////////////////////////
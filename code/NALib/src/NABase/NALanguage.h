@@ -147,6 +147,23 @@
 
 
 
+// ////////////////////////
+// The NA_THREAD_LOCAL macro marks a global or static variable to exist once
+// per thread. Before C11 and C++11, there was no standard keyword and hence
+// the compiler specific extensions are used.
+
+#if NA_OS == NA_OS_WINDOWS
+  #define NA_THREAD_LOCAL __declspec(thread)
+#elif defined __cplusplus && defined NA_CPP11
+  #define NA_THREAD_LOCAL thread_local
+#elif defined NA_C11
+  #define NA_THREAD_LOCAL _Thread_local
+#else
+  #define NA_THREAD_LOCAL __thread
+#endif
+
+
+
 // ////////////////////////
 // We always include stdarg as we need a definition of va_copy.
 // Just for information:
@@ -15,6 +15,7 @@
 #include "NAStruct/NAHeap.h"
 #include "NAStruct/NAList.h"
 #include "NAStruct/NAPool.h"
+#include "NAStruct/NARing.h"
 #include "NAStruct/NAStack.h"
 #include "NAStruct/NATree.h"
 
@@ -3,7 +3,7 @@
 
 
 NA_HAPI void na_DestructBuffer(NABuffer* buffer);
-NA_RUNTIME_TYPE(NABuffer, na_DestructBuffer, NA_TRUE);
+NA_RUNTIME_TYPE_ATOMIC(NABuffer, na_DestructBuffer);
 
 
 
@@ -70,7 +70,15 @@ NA_HDEF void na_InitBufferStruct(NABuffer* buffer){
   naSetTreeConfigurationLeafCallbacks(config, NA_NULL, naDestructBufferTreeLeaf);
   naSetTreeConfigurationNodeCallbacks(config, naConstructBufferTreeNode, naDestructBufferTreeNode, naUpdateBufferTreeNode);
   naInitTree(&(buffer->parts), config);
-  #if NA_DEBUG
+  buffer->partIndex = NA_NULL;
+  buffer->partIndexCount = 0;
+  buffer->partIndexCapacity = 0;
+  buffer->partIndexCountdown = 0;
+  buffer->partIndexEnd = 0;
+  buffer->partIndexValid = NA_FALSE;
+  buffer->partCount = 0;
+  buffer->compactPartCount = NA_BUFFER_COMPACT_PART_COUNT;
+  #if NA_INTERNAL_BUFFER_COUNT_ITERATORS
     buffer->iterCount = 0;
   #endif
   naReleaseTreeConfiguration(config);
@@ -150,6 +158,7 @@ NA_DEF NABuffer* naCreateBufferExtraction(NABuffer* srcBuffer, NAInt offset, NAI
   // Add the const data to the list.
   part = na_NewBufferPartSparse(buffer->source, absoluterange);
   naAddTreeFirstMutable(&(buffer->parts), part);
+  buffer->partCount++;
 
   buffer->flags = srcBuffer->flags | NA_BUFFER_FLAG_RANGE_FIXED;
 
@@ -206,41 +215,186 @@ NA_DEF NABuffer* naCreateBufferWithSameSource(NABuffer* srcBuffer){
 
 
 
+// The data of the file input source. The file is read positionally, hence
+// the parts can be filled in any order. Small reads are served from a few
+// read-ahead windows which are replaced least recently used first. As parts
+// may be filled by a background thread when prefetching, the windows are
+// protected by a mutex.
+typedef struct NA_BufferFileWindow NA_BufferFileWindow;
+struct NA_BufferFileWindow{
+  NAByte*    data;       // Allocated upon first use.
+  NAFileSize origin;     // File offset of the first byte.
+  size_t     byteSize;   // Number of valid bytes, 0 if unused.
+  uint32     lastUse;
+};
+
+typedef struct NA_BufferFileReader NA_BufferFileReader;
+struct NA_BufferFileReader{
+  NAFile*             file;
+  NAMutex             mutex;
+  uint32              useCount;
+  NA_BufferFileWindow windows[NA_BUFFER_FILE_READ_AHEAD_COUNT];
+};
+
+
+
+NA_HDEF NA_BufferFileReader* na_CreateBufferFileReader(NAFile* file){
+  size_t i;
+  NA_BufferFileReader* reader = naAlloc(NA_BufferFileReader);
+  reader->file = file;
+  reader->mutex = naMakeMutex();
+  reader->useCount = 0;
+  for(i = 0; i < NA_BUFFER_FILE_READ_AHEAD_COUNT; i++){
+    reader->windows[i].data = NA_NULL;
+    reader->windows[i].origin = 0;
+    reader->windows[i].byteSize = 0;
+    reader->windows[i].lastUse = 0;
+  }
+  return reader;
+}
+
+
+
+NA_HDEF void na_DestroyBufferFileReader(NA_BufferFileReader* reader){
+  size_t i;
+  for(i = 0; i < NA_BUFFER_FILE_READ_AHEAD_COUNT; i++){
+    if(reader->windows[i].data){naFree(reader->windows[i].data);}
+  }
+  naClearMutex(reader->mutex);
+  naReleaseFile(reader->file);
+  naFree(reader);
+}
+
+
+
+// Returns a window containing the byte at the given offset, reading the file
+// if necessary. Returns NA_NULL if the offset is beyond the end of the file.
+NA_HDEF NA_BufferFileWindow* na_GetBufferFileWindow(NA_BufferFileReader* reader, NAFileSize offset){
+  size_t i;
+  NA_BufferFileWindow* window = &(reader->windows[0]);
+  reader->useCount++;
+
+  for(i = 0; i < NA_BUFFER_FILE_READ_AHEAD_COUNT; i++){
+    NA_BufferFileWindow* curWindow = &(reader->windows[i]);
+    if(offset >= curWindow->origin && offset < curWindow->origin + (NAFileSize)curWindow->byteSize){
+      curWindow->lastUse = reader->useCount;
+      return curWindow;
+    }
+    if(curWindow->lastUse < window->lastUse){window = curWindow;}
+  }
+
+  // Not found. Replace the least recently used window.
+  if(!window->data){
+    window->data = naMalloc(NA_BUFFER_FILE_READ_AHEAD_BYTESIZE);
+  }
+  window->origin = offset;
+  window->byteSize = (size_t)naReadFileBytesAt(
+    reader->file,
+    window->data,
+    NA_BUFFER_FILE_READ_AHEAD_BYTESIZE,
+    offset);
+  window->lastUse = reader->useCount;
+  return window->byteSize ? window : NA_NULL;
+}
+
+
+
 // This is the filler method of the file input source descriptor
 NA_HDEF void na_FillBufferPartFile(void* dst, NARangei sourceRange, void* data){
-  // todo: position at range.origin.
-  naReadFileBytes(data, dst, sourceRange.length);
-}
+  NA_BufferFileReader* reader = (NA_BufferFileReader*)data;
+  NAByte* dstByte = (NAByte*)dst;
+  NAFileSize offset = (NAFileSize)sourceRange.origin;
+  size_t remainingByteSize = (size_t)sourceRange.length;
+
+  naLockMutex(reader->mutex);
+
+  // Big ranges are read directly. They would only evict the windows.
+  if(remainingByteSize >= NA_BUFFER_FILE_READ_AHEAD_BYTESIZE){
+    size_t readByteSize = (size_t)naReadFileBytesAt(reader->file, dstByte, (NAFileSize)remainingByteSize, offset);
+    dstByte += readByteSize;
+    offset += (NAFileSize)readByteSize;
+    remainingByteSize -= readByteSize;
+  }
 
+  while(remainingByteSize){
+    size_t copyByteSize;
+    NA_BufferFileWindow* window = na_GetBufferFileWindow(reader, offset);
+    if(!window){break;}
+    copyByteSize = window->byteSize - (size_t)(offset - window->origin);
+    if(copyByteSize > remainingByteSize){copyByteSize = remainingByteSize;}
+    naCopyn(dstByte, &(window->data[offset - window->origin]), copyByteSize);
+    dstByte += copyByteSize;
+    offset += (NAFileSize)copyByteSize;
+    remainingByteSize -= copyByteSize;
+  }
 
+  // The file is shorter than expected, for example if it has been truncated
+  // in the meantime.
+  if(remainingByteSize){
+    naZeron(dstByte, remainingByteSize);
+  }
 
-NA_DEF NABuffer* naCreateBufferWithInputPath(const char* filePath){
-  NARangei range;
-  NAFile* file;
-  NABuffer* fileBuffer;
-  NABufferSource* readsource;
-  NABufferSource* bufsource;
+  naUnlockMutex(reader->mutex);
+}
 
-  NABuffer* buffer = naCreate(NABuffer);
-  na_InitBufferStruct(buffer);
 
-//  NAString* pwd = naNewStringWithCurWorkingDirectory();
-  file = naCreateFileReadingPath(filePath);
-  range = naMakeRangei(0, (NAInt)naComputeFileByteSize(file));
 
-  fileBuffer = naCreateBuffer(NA_FALSE);
-  readsource = naCreateBufferSource(na_FillBufferPartFile, NA_NULL);
-    naSetBufferSourceData(readsource, file, (NAMutator)naReleaseFile);
-    naSetBufferSourceLimit(readsource, range);
+// Creates a source reading the first byteSize bytes of the file. The bytes
+// read are kept in a cache buffer. The source takes ownership of the file.
+NA_HDEF NABufferSource* na_CreateBufferSourceWithFileReading(NAFile* file, size_t byteSize){
+  NABufferSource* bufsource;
+  NABuffer* fileBuffer = naCreateBuffer(NA_FALSE);
+  NABufferSource* readsource = naCreateBufferSource(na_FillBufferPartFile, NA_NULL);
+    naSetBufferSourceData(readsource, na_CreateBufferFileReader(file), (NAMutator)na_DestroyBufferFileReader);
+    naSetBufferSourceLimit(readsource, naMakeRangei(0, (NAInt)byteSize));
     fileBuffer->source = naRetain(readsource);
     fileBuffer->sourceOffset = 0;
   naRelease(readsource);
 
   bufsource = naCreateBufferSource(NA_NULL, fileBuffer);
-    buffer->source = naRetain(bufsource);
-    buffer->sourceOffset = 0;
-  naRelease(bufsource);
   naRelease(fileBuffer);
+  return bufsource;
+}
+
+
+
+NA_DEF NABuffer* naCreateBufferWithInputPath(const char* filePath){
+  return naCreateBufferWithInputPathAndAccess(filePath, NA_FILE_ACCESS_DEFAULT);
+}
+
+
+
+NA_DEF NABuffer* naCreateBufferWithInputPathAndAccess(const char* filePath, NAFileAccess access){
+  NARangei range;
+  size_t mappedByteSize;
+  void* mappedData;
+
+  NABuffer* buffer = naCreate(NABuffer);
+  na_InitBufferStruct(buffer);
+
+  mappedData = naMapFile(filePath, &mappedByteSize, access);
+  if(mappedData){
+    // The parts of the buffer will directly reference the mapping. As the
+    // mapping already is linear memory, no cache is needed.
+    NABufferSource* mapsource = na_CreateBufferSourceWithFileMapping(mappedData, mappedByteSize);
+      buffer->source = naRetain(mapsource);
+      buffer->sourceOffset = 0;
+    naRelease(mapsource);
+    range = naMakeRangei(0, (NAInt)mappedByteSize);
+
+  }else{
+    NAFile* file;
+    NABufferSource* bufsource;
+
+  //  NAString* pwd = naNewStringWithCurWorkingDirectory();
+    file = naCreateFileReadingPath(filePath);
+    range = naMakeRangei(0, (NAInt)naComputeFileByteSize(file));
+
+    bufsource = na_CreateBufferSourceWithFileReading(file, (size_t)range.length);
+      buffer->source = naRetain(bufsource);
+      buffer->sourceOffset = 0;
+    naRelease(bufsource);
+  }
 
   na_EnsureBufferRange(buffer, 0, range.length);
   buffer->flags |= NA_BUFFER_FLAG_RANGE_FIXED;
@@ -265,6 +419,7 @@ NA_DEF NABuffer* naCreateBufferWithConstData(const void* data, size_t byteSize){
   // Add the const data to the list.
   part = na_NewBufferPartWithConstData(data, byteSize);
   naAddTreeFirstMutable(&(buffer->parts), part);
+  buffer->partCount++;
 
   buffer->source = NA_NULL;
   buffer->sourceOffset = 0;
@@ -292,6 +447,7 @@ NA_DEF NABuffer* naCreateBufferWithMutableData(void* data, size_t byteSize, NAMu
   // Add the mutable data to the list.
   part = na_NewBufferPartWithMutableData(data, byteSize, destructor);
   naAddTreeFirstMutable(&(buffer->parts), part);
+  buffer->partCount++;
 
   buffer->source = NA_NULL;
   buffer->sourceOffset = 0;
@@ -329,6 +485,7 @@ NA_HDEF void na_DestructBuffer(NABuffer* buffer){
   #endif
   if(buffer->source){naRelease(buffer->source);}
   naClearTree(&(buffer->parts));
+  if(buffer->partIndex){naFree(buffer->partIndex);}
 }
 
 
@@ -353,7 +510,9 @@ NA_HDEF void na_EnsureBufferRange(NABuffer* buffer, NAInt start, NAInt end){
     // whole range.
     NABufferPart* part = na_NewBufferPartSparse(buffer->source, naMakeRangei(start + buffer->sourceOffset, length));
     naAddTreeFirstMutable(&(buffer->parts), part);
+    buffer->partCount++;
     buffer->range = naMakeRangeiWithStartAndEnd(start, end);
+    na_InvalidateBufferPartIndex(buffer);
 
   }else{
 
@@ -372,8 +531,10 @@ NA_HDEF void na_EnsureBufferRange(NABuffer* buffer, NAInt start, NAInt end){
         // We create a sparse part at the beginning.
         NABufferPart* part = na_NewBufferPartSparse(buffer->source, naMakeRangei(start + buffer->sourceOffset, additionalbytes));
         naAddTreeFirstMutable(&(buffer->parts), part);
+        buffer->partCount++;
       }
       buffer->range = naMakeRangeiWithStartAndEnd(start, naGetRangeiEnd(buffer->range));
+      na_InvalidateBufferPartIndex(buffer);
     }
 
     // Then, we test if we need to add a sparse part at the end.
@@ -389,8 +550,10 @@ NA_HDEF void na_EnsureBufferRange(NABuffer* buffer, NAInt start, NAInt end){
         // We create a sparse part at the end.
         NABufferPart* part = na_NewBufferPartSparse(buffer->source, naMakeRangei(naGetRangeiEnd(buffer->range) + buffer->sourceOffset, additionalbytes));
         naAddTreeLastMutable(&(buffer->parts), part);
+        buffer->partCount++;
       }
       buffer->range = naMakeRangeiWithStartAndEnd(buffer->range.origin, end);
+      na_InvalidateBufferPartIndex(buffer);
     }
 
     naClearBufferIterator(&iter);
@@ -480,50 +643,43 @@ NA_HDEF void na_UnlinkBufferRange(NABuffer* buffer, NARangei range){
 
 NA_DEF NAInt naSearchBufferByteOffset(NABuffer* buffer, NAByte byte, NAInt startOffset, NABool forward){
   NABufferIterator iter;
-  NAInt indexShift;
-  NABool found;
+  NAInt foundOffset = NA_INVALID_MEMORY_INDEX;
 
   if(naIsBufferEmpty(buffer)){return NA_INVALID_MEMORY_INDEX;}
-  indexShift = 0;
-  found = NA_FALSE;
 
   iter = naMakeBufferAccessor(buffer);
   naLocateBufferAbsolute(&iter, startOffset);
 
   while(!naIsTreeAtInitial(&(iter.partIter))){
-    const NABufferPart* part;
-    const NAByte* curByte;
+    const NAByte* partBytes;
+    const NAByte* foundByte;
+    size_t partOffset = (size_t)iter.partOffset;
+    NAInt location = naGetBufferLocation(&iter);
+
+    if(na_IsBufferIteratorSparse(&iter)){
+      // Make sure, the bytes to search are present.
+      if(forward){
+        na_PrepareBuffer(&iter, na_GetBufferPartByteSize(na_GetBufferPart(&iter)) - partOffset);
+      }else{
+        iter.partOffset = 0;
+        na_PrepareBuffer(&iter, partOffset + 1);
+        naLocateBufferAbsolute(&iter, location);
+      }
+      partOffset = (size_t)iter.partOffset;
+    }
 
-    part = na_GetBufferPart(&iter);
-    #if NA_DEBUG
-      if(na_IsBufferPartSparse(part))
-        naError("sparse part detected.");
-    #endif
-    curByte = (const NAByte*)na_GetBufferPartDataPointerConst(&iter);
+    partBytes = (const NAByte*)na_GetBufferPartDataPointerConst(&iter) - partOffset;
     if(forward){
-      size_t remainingBytes = na_GetBufferPartByteSize(part) - (size_t)iter.partOffset;
-      while(remainingBytes){
-        if(*curByte == byte){
-          found = NA_TRUE;
-          break;
-        }
-        indexShift++;
-        curByte++;
-        remainingBytes--;
-      }
+      size_t partByteSize = na_GetBufferPartByteSize(na_GetBufferPart(&iter));
+      foundByte = naSearchBytesForByte(&(partBytes[partOffset]), partByteSize - partOffset, byte);
     }else{
-      size_t remainingBytes = (size_t)iter.partOffset;
-      while(remainingBytes){
-        if(*curByte == byte){
-          found = NA_TRUE;
-          break;
-        }
-        indexShift--;
-        curByte--;
-        remainingBytes--;
-      }
+      foundByte = naSearchBytesForByteReverse(partBytes, partOffset + 1, byte);
+    }
+    if(foundByte){
+      foundOffset = location + (NAInt)(foundByte - &(partBytes[partOffset]));
+      break;
     }
-    if(found){break;}
+
     if(forward){
       na_LocateBufferNextPart(&iter);
     }else{
@@ -532,7 +688,83 @@ NA_DEF NAInt naSearchBufferByteOffset(NABuffer* buffer, NAByte byte, NAInt start
   }
 
   naClearBufferIterator(&iter);
-  return found ? (startOffset + indexShift) : NA_INVALID_MEMORY_INDEX;
+  return foundOffset;
+}
+
+
+
+NA_DEF NAInt naSearchBufferPattern(NABuffer* buffer, const void* pattern, size_t patternByteSize, NAInt startOffset){
+  NABufferIterator iter;
+  NAInt foundOffset = NA_INVALID_MEMORY_INDEX;
+  NAInt bufferEnd = naGetRangeiEnd(buffer->range);
+  NAByte* spanBytes = NA_NULL;
+  const NAByte* pat = pattern;
+
+  #if NA_DEBUG
+    if(!pattern)
+      naCrash("pattern is Null-Pointer");
+    if(!patternByteSize)
+      naError("patternByteSize is zero.");
+  #endif
+  if(naIsBufferEmpty(buffer)){return NA_INVALID_MEMORY_INDEX;}
+
+  iter = naMakeBufferAccessor(buffer);
+  naLocateBufferAbsolute(&iter, startOffset);
+
+  while(!naIsTreeAtInitial(&(iter.partIter))){
+    const NAByte* partBytes;
+    const NAByte* foundBytes;
+    size_t remainingBytes;
+    NAInt location = naGetBufferLocation(&iter);
+    size_t spanStart;
+
+    if(location + (NAInt)patternByteSize > bufferEnd){break;}
+    if(na_IsBufferIteratorSparse(&iter)){
+      na_PrepareBuffer(&iter, na_GetBufferPartByteSize(na_GetBufferPart(&iter)) - (size_t)iter.partOffset);
+    }
+    remainingBytes = na_GetBufferPartByteSize(na_GetBufferPart(&iter)) - (size_t)iter.partOffset;
+    partBytes = (const NAByte*)na_GetBufferPartDataPointerConst(&iter);
+
+    // First, search for matches within this part.
+    foundBytes = naSearchBytesForPattern(partBytes, remainingBytes, pattern, patternByteSize);
+    if(foundBytes){
+      foundOffset = location + (NAInt)(foundBytes - partBytes);
+      break;
+    }
+
+    // Then, test the matches starting within the last bytes of this part and
+    // reaching into the following parts.
+    spanStart = (remainingBytes >= patternByteSize) ? remainingBytes - patternByteSize + 1 : 0;
+    while(spanStart < remainingBytes){
+      NABufferIterator spanIter;
+      foundBytes = naSearchBytesForByte(&(partBytes[spanStart]), remainingBytes - spanStart, pat[0]);
+      if(!foundBytes){break;}
+      spanStart = (size_t)(foundBytes - partBytes);
+      if(location + (NAInt)(spanStart + patternByteSize) > bufferEnd){break;}
+
+      if(!spanBytes){
+        spanBytes = naMalloc(patternByteSize);
+      }
+      spanIter = naMakeBufferAccessor(buffer);
+      naLocateBufferAbsolute(&spanIter, location + (NAInt)spanStart);
+      na_RetrieveBufferBytes(&spanIter, spanBytes, patternByteSize, NA_FALSE);
+      naClearBufferIterator(&spanIter);
+      if(!memcmp(spanBytes, pattern, patternByteSize)){
+        foundOffset = location + (NAInt)spanStart;
+        break;
+      }
+      spanStart++;
+    }
+    if(foundOffset != NA_INVALID_MEMORY_INDEX){break;}
+
+    na_LocateBufferNextPart(&iter);
+  }
+
+  if(spanBytes){
+    naFree(spanBytes);
+  }
+  naClearBufferIterator(&iter);
+  return foundOffset;
 }
 
 
@@ -658,6 +890,17 @@ NA_DEF void naCacheBufferRange(NABuffer* buffer, NARangei range){
 
 
 
+NA_DEF void naPrefetchBufferRange(NABuffer* buffer, NARangei range){
+  if(range.length){
+    NABufferIterator iter = naMakeBufferModifier(buffer);
+    naLocateBufferAbsolute(&iter, range.origin);
+    na_PrepareBufferParts(&iter, (size_t)range.length, NA_TRUE);
+    naClearBufferIterator(&iter);
+  }
+}
+
+
+
 NA_DEF void naDismissBufferRange(NABuffer* buffer, NARangei range){
   na_UnlinkBufferRange(buffer, range);
 }
@@ -177,10 +177,23 @@
 
 typedef struct NABufferPart NABufferPart;
 typedef struct NAMemoryBlock NAMemoryBlock;
+typedef struct NA_MemoryBlockFill NA_MemoryBlockFill;
 typedef struct NABufferSearchToken NABufferSearchToken;
+typedef struct NABufferPartIndexEntry NABufferPartIndexEntry;
 
 
 #include "../../NATree.h"
+#include "../../../NAUtility/NAAtomic.h"
+#include "../../../NAUtility/NAThreading.h"
+
+// Release builds only count the iterators of a buffer when it may be
+// compacted automatically. Otherwise, creating an accessor does not write to
+// the const buffer.
+#if NA_DEBUG || NA_BUFFER_COMPACT_PART_COUNT
+  #define NA_INTERNAL_BUFFER_COUNT_ITERATORS 1
+#else
+  #define NA_INTERNAL_BUFFER_COUNT_ITERATORS 0
+#endif
 
 
 struct NABuffer{
@@ -196,8 +209,18 @@ struct NABuffer{
 
   NATree parts;             // Tree with all parts in this buffer
 
-  #if NA_DEBUG
-    NAInt iterCount;
+  // Flat copy of the part positions, see na_UpdateBufferPartIndex.
+  NABufferPartIndexEntry* partIndex;
+  size_t partIndexCount;    // Number of parts stored in the index.
+  size_t partIndexCapacity; // Number of entries allocated.
+  size_t partIndexCountdown; // Changes of the parts left until rebuilding.
+  NAInt partIndexEnd;       // End offset of the last part in the index.
+  NABool partIndexValid;    // False if the parts changed since the rebuild.
+
+  size_t partCount;         // Number of parts in the tree.
+  size_t compactPartCount;  // Part count triggering the automatic compaction.
+  #if NA_INTERNAL_BUFFER_COUNT_ITERATORS
+    NAInt iterCount;        // Number of iterators, see naCompactBuffer.
   #endif
 };
 
@@ -212,19 +235,33 @@ struct NABufferTreeNodeData{
   size_t len2;
 };
 
+struct NABufferPartIndexEntry{
+  NAInt start;       // Absolute offset of the first byte of the part.
+  NATreeItem* item;  // The leaf of the parts tree storing the part.
+};
+
 
 
 // NAMemoryBlock
 NA_HAPI NAMemoryBlock* na_CreateMemoryBlock(size_t byteSize);
 NA_HAPI NAMemoryBlock* na_CreateMemoryBlockWithData(NAPtr data, size_t byteSize, NAMutator destructor);
+NA_HAPI NAMemoryBlock* na_CreateMemoryBlockWithFileMapping(void* data, size_t byteSize);
 NA_HIAPI const void* na_GetMemoryBlockDataPointerConst(NAMemoryBlock* block, size_t index);
 NA_HIAPI void* na_GetMemoryBlockDataPointerMutable(NAMemoryBlock* block, size_t index);
+NA_HIAPI NABool na_IsMemoryBlockFileMapping(const NAMemoryBlock* block);
+NA_HAPI void na_FillMemoryBlockAsync(NAMemoryBlock* block, NABufferSource* source, NARangei sourceRange);
+NA_HAPI void na_FinishMemoryBlockFill(NAMemoryBlock* block);
+NA_HIAPI void na_WaitMemoryBlockFill(NAMemoryBlock* block);
 
 
 
 // NABufferSource
+NA_HAPI NABufferSource* na_CreateBufferSourceWithFileMapping(void* data, size_t byteSize);
+NA_HAPI NABufferSource* na_CreateBufferSourceWithFileReading(NAFile* file, size_t byteSize);
 NA_HIAPI NABool na_HasBufferSourceCache(NABufferSource* source);
 NA_HIAPI NABuffer* na_GetBufferSourceCache(NABufferSource* source);
+NA_HIAPI NABool na_HasBufferSourceMapping(const NABufferSource* source);
+NA_HIAPI NAMemoryBlock* na_GetBufferSourceMapping(const NABufferSource* source);
 NA_HIAPI NABool na_HasBufferSourceLimit(const NABufferSource* source);
 NA_HIAPI NARangei na_GetBufferSourceLimit(const NABufferSource* source);
 NA_HIAPI void na_FillBufferSourceMemory(const NABufferSource* source, void* dst, NARangei range);
@@ -237,6 +274,8 @@ NA_HIAPI NAInt na_GetBufferPartNormedEnd(NAInt end);
 NA_HAPI NABufferPart* na_NewBufferPartSparse(NABufferSource* source, NARangei sourceRange);
 NA_HAPI NABufferPart* na_NewBufferPartWithConstData(const void* data, size_t byteSize);
 NA_HAPI NABufferPart* na_NewBufferPartWithMutableData(void* data, size_t byteSize, NAMutator destructor);
+NA_HAPI NABufferPart* na_NewBufferPartMoved(NABufferPart* part);
+NA_HAPI NABufferPart* na_NewBufferPartCoalesced(NABufferPart* const* parts, size_t count);
 NA_HIAPI NABufferSource* na_GetBufferPartSource(const NABufferPart* part);
 NA_HIAPI NAInt na_GetBufferPartSourceOffset(const NABufferPart* part);
 NA_HIAPI size_t na_GetBufferPartByteSize(const NABufferPart* part);
@@ -254,6 +293,9 @@ NA_HAPI void na_EnsureBufferRange(NABuffer* buffer, NAInt start, NAInt end);
 NA_HIAPI const NABuffer* na_GetBufferIteratorBufferConst(const NABufferIterator* iter);
 NA_HIAPI NABuffer* na_GetBufferIteratorBufferMutable(NABufferIterator* iter);
 
+NA_HAPI void na_UpdateBufferPartIndex(NABuffer* buffer);
+NA_HIAPI void na_InvalidateBufferPartIndex(NABuffer* buffer);
+NA_HAPI NAInt na_GetBufferByteLocation(const NABufferIterator* iter);
 NA_HAPI NABool na_LocateBufferStart(NABufferIterator* iter);
 NA_HAPI NABool na_LocateBufferLastPart(NABufferIterator* iter);
 NA_HAPI NABool na_LocateBufferNextPart(NABufferIterator* iter);
@@ -267,12 +309,13 @@ NA_HIAPI NAInt na_GetBufferIteratorPartOffset(NABufferIterator* iter);
 NA_HAPI NABool na_IsBufferIteratorSparse(NABufferIterator* iter);
 NA_HIAPI NABufferPart* na_GetBufferPart(NABufferIterator* iter);
 NA_HAPI void na_PrepareBuffer(NABufferIterator* iter, size_t byteCount);
+NA_HAPI void na_PrepareBufferParts(NABufferIterator* iter, size_t byteCount, NABool prefetch);
 
 // NABufferPart
-NA_HAPI NABufferPart* na_SplitBufferPart(NATreeIterator* partIter, size_t start, size_t end);
-NA_HAPI NABufferPart* na_PrepareBufferPartCache(NATreeIterator* partIter, NARangei partRange);
-NA_HAPI NABufferPart* na_PrepareBufferPartMemory(NATreeIterator* partIter, NARangei partRange);
-NA_HAPI size_t na_PrepareBufferPart(NABufferIterator* iter, size_t byteCount);
+NA_HAPI NABufferPart* na_SplitBufferPart(NABuffer* buffer, NATreeIterator* partIter, size_t start, size_t end);
+NA_HAPI NABufferPart* na_PrepareBufferPartCache(NABuffer* buffer, NATreeIterator* partIter, NARangei partRange, NABool prefetch);
+NA_HAPI NABufferPart* na_PrepareBufferPartMemory(NABuffer* buffer, NATreeIterator* partIter, NARangei partRange, NABool prefetch);
+NA_HAPI size_t na_PrepareBufferPart(NABufferIterator* iter, size_t byteCount, NABool prefetch);
 
 NA_HIAPI size_t na_GetBufferPartRemainingBytes(NABufferIterator* iter);
 NA_HIAPI const void* na_GetBufferPartDataPointerConst(NABufferIterator* iter);
@@ -281,6 +324,7 @@ NA_HIAPI void* na_GetBufferPartDataPointerMutable(NABufferIterator* iter);
 // NABufferRead and NABufferWrite
 NA_HAPI void na_RetrieveBufferBytes(NABufferIterator* iter, void* data, size_t byteSize, NABool advance);
 NA_HAPI void na_StoreBufferBytes(NABufferIterator* iter, const void* data, size_t byteSize, NABool prepare, NABool advance);
+NA_HAPI void na_StoreBufferBits(NABufferIterator* iter, NABool flushAll);
 
 
 
@@ -1,23 +1,31 @@
 
 #include "../../NABuffer.h"
 
+// Buffers with more parts than this count are always searched in the tree
+// because rebuilding the flat part index would take too long.
+#define NA_BUFFER_PART_INDEX_MAX_COUNT 16384
+
 
 
 NA_DEF NABufferIterator naMakeBufferAccessor(const NABuffer* buffer){
   NABufferIterator iter;
   #if NA_DEBUG
-    NABuffer* mutablebuffer;
     if(!buffer)
       naCrash("buffer is Null pointer");
-    mutablebuffer = (NABuffer*)buffer;
   #endif
   iter.bufferPtr = naMakePtrWithDataConst(buffer);
   iter.partIter = naMakeTreeAccessor(&(buffer->parts));
   iter.partOffset = 0;
+  iter.partIndex = 0;
+  iter.changedParts = NA_FALSE;
   iter.curBit = 0;
+  iter.bitCount = 0;
+  iter.bitBuffer = 0;
+  iter.writeBitCount = 0;
+  iter.writeBits = 0;
   iter.lineNum = 0;
-  #if NA_DEBUG
-    mutablebuffer->iterCount++;
+  #if NA_INTERNAL_BUFFER_COUNT_ITERATORS
+    ((NABuffer*)buffer)->iterCount++;
   #endif
   return iter;
 }
@@ -27,18 +35,22 @@ NA_DEF NABufferIterator naMakeBufferAccessor(const NABuffer* buffer){
 NA_DEF NABufferIterator naMakeBufferMutator(NABuffer* buffer){
   NABufferIterator iter;
   #if NA_DEBUG
-    NABuffer* mutablebuffer;
     if(!buffer)
       naCrash("buffer is Null pointer");
-    mutablebuffer = (NABuffer*)buffer;
   #endif
   iter.bufferPtr = naMakePtrWithDataMutable(buffer);
   iter.partIter = naMakeTreeMutator(&(buffer->parts));
   iter.partOffset = 0;
+  iter.partIndex = 0;
+  iter.changedParts = NA_FALSE;
   iter.curBit = 0;
+  iter.bitCount = 0;
+  iter.bitBuffer = 0;
+  iter.writeBitCount = 0;
+  iter.writeBits = 0;
   iter.lineNum = 0;
-  #if NA_DEBUG
-    mutablebuffer->iterCount++;
+  #if NA_INTERNAL_BUFFER_COUNT_ITERATORS
+    ((NABuffer*)buffer)->iterCount++;
   #endif
   return iter;
 }
@@ -48,18 +60,22 @@ NA_DEF NABufferIterator naMakeBufferMutator(NABuffer* buffer){
 NA_DEF NABufferIterator naMakeBufferModifier(NABuffer* buffer){
   NABufferIterator iter;
   #if NA_DEBUG
-    NABuffer* mutablebuffer;
     if(!buffer)
       naCrash("buffer is Null pointer");
-    mutablebuffer = (NABuffer*)buffer;
   #endif
   iter.bufferPtr = naMakePtrWithDataMutable(buffer);
   iter.partIter = naMakeTreeModifier(&(buffer->parts));
   iter.partOffset = 0;
+  iter.partIndex = 0;
+  iter.changedParts = NA_FALSE;
   iter.curBit = 0;
+  iter.bitCount = 0;
+  iter.bitBuffer = 0;
+  iter.writeBitCount = 0;
+  iter.writeBits = 0;
   iter.lineNum = 0;
-  #if NA_DEBUG
-    mutablebuffer->iterCount++;
+  #if NA_INTERNAL_BUFFER_COUNT_ITERATORS
+    ((NABuffer*)buffer)->iterCount++;
   #endif
   return iter;
 }
@@ -67,16 +83,32 @@ NA_DEF NABufferIterator naMakeBufferModifier(NABuffer* buffer){
 
 
 NA_DEF void naClearBufferIterator(NABufferIterator* iter){
+  NABuffer* buffer = (NABuffer*)na_GetBufferIteratorBufferConst(iter);
   #if NA_DEBUG
-    NABuffer* mutablebuffer;
-    mutablebuffer = (NABuffer*)na_GetBufferIteratorBufferConst(iter);
-    if(mutablebuffer->iterCount == 0)
+    if(buffer->iterCount == 0)
       naError("Too many clears: Buffer has no iterators to clear.");
+    if(iter->writeBitCount)
+      naError("Written bits have not been flushed. Use naFlushBufferBits.");
   #endif
   naClearTreeIterator(&(iter->partIter));
-  #if NA_DEBUG
-    mutablebuffer->iterCount--;
+  #if NA_INTERNAL_BUFFER_COUNT_ITERATORS
+    buffer->iterCount--;
+  #endif
+
+  // Compacting is only possible when no iterator points to a part anymore.
+  #if NA_BUFFER_COMPACT_PART_COUNT
+    if(!buffer->iterCount && buffer->partCount > buffer->compactPartCount){
+      naCompactBuffer(buffer, (size_t)NA_INTERNAL_BUFFER_PART_BYTESIZE);
+    }
   #endif
+
+  // An iterator which changed the parts brings the part index up to date
+  // such that the following iterators can use it right away.
+  if(iter->changedParts
+    && !buffer->partIndexValid
+    && buffer->partIndexCount < NA_BUFFER_PART_INDEX_MAX_COUNT){
+    na_UpdateBufferPartIndex(buffer);
+  }
 }
 
 
@@ -97,11 +129,44 @@ NA_DEF NAInt naGetBufferLocation(const NABufferIterator* iter){
     if(iter->curBit != 0)
       naError("Buffer bitCount is not Null.");
   #endif
+  return na_GetBufferByteLocation(iter);
+}
+
+
+
+// Returns the position of the current part of the iterator in the part index
+// or -1 if the index is not valid or does not know the part. Only the
+// position stored in the iterator and its neighbours are tested.
+NA_HDEF NAInt na_GetBufferPartIndexCursor(const NABufferIterator* iter){
+  const NABuffer* buffer = na_GetBufferIteratorBufferConst(iter);
+  if(buffer->partIndexValid){
+    size_t index = iter->partIndex;
+    if(index < buffer->partIndexCount && buffer->partIndex[index].item == iter->partIter.item){
+      return (NAInt)index;
+    }
+    if(index + 1 < buffer->partIndexCount && buffer->partIndex[index + 1].item == iter->partIter.item){
+      return (NAInt)index + 1;
+    }
+    if(index - 1 < buffer->partIndexCount && buffer->partIndex[index - 1].item == iter->partIter.item){
+      return (NAInt)index - 1;
+    }
+  }
+  return -1;
+}
+
+
+
+// Same as naGetBufferLocation but ignores the current bit.
+NA_HDEF NAInt na_GetBufferByteLocation(const NABufferIterator* iter){
   if(naIsTreeAtInitial(&(iter->partIter))){
     return (NAInt)iter->partOffset;
   }else{
     const NABuffer* buffer = na_GetBufferIteratorBufferConst(iter);
     NABufferSearchToken token;
+    NAInt index = na_GetBufferPartIndexCursor(iter);
+    if(index >= 0){
+      return buffer->partIndex[index].start + (NAInt)iter->partOffset;
+    }
     token.searchOffset = 0;
     token.curOffset = 0;
     naBubbleTreeToken(&(iter->partIter), &token, na_AccumulateBufferLocation);
@@ -156,8 +221,10 @@ NA_HDEF NABool na_LocateBufferStart(NABufferIterator* iter){
       naError("Buffer bitCount is not Null.");
   #endif
   iter->curBit = 0;
+  iter->bitCount = 0;
   iter->lineNum = 0;
   naLocateTreeFirst(&(iter->partIter));
+  iter->partIndex = 0;
   if(naIsTreeAtInitial(&(iter->partIter))){
     const NABuffer* buffer = na_GetBufferIteratorBufferConst(iter);
     iter->partOffset = (NAInt)buffer->range.origin;
@@ -176,8 +243,10 @@ NA_HDEF NABool na_LocateBufferLastPart(NABufferIterator* iter){
       naError("Buffer bitCount is not Null.");
   #endif
   iter->curBit = 0;
+  iter->bitCount = 0;
   iter->lineNum = 0;
   naLocateTreeLast(&(iter->partIter));
+  iter->partIndex = na_GetBufferIteratorBufferConst(iter)->partIndexCount - 1;
   if(naIsTreeAtInitial(&(iter->partIter))){
     const NABuffer* buffer = na_GetBufferIteratorBufferConst(iter);
     iter->partOffset = (NAInt)naGetRangeiEnd(buffer->range);
@@ -196,8 +265,10 @@ NA_HDEF NABool na_LocateBufferNextPart(NABufferIterator* iter){
       naError("Buffer bitCount is not Null.");
   #endif
   iter->curBit = 0;
+  iter->bitCount = 0;
   iter->lineNum = 0;
   naIterateTree(&(iter->partIter), NA_NULL, NA_NULL);
+  iter->partIndex++;
   if(naIsTreeAtInitial(&(iter->partIter))){
     const NABuffer* buffer = na_GetBufferIteratorBufferConst(iter);
     iter->partOffset = (NAInt)naGetRangeiEnd(buffer->range);
@@ -216,8 +287,10 @@ NA_HDEF NABool na_LocateBufferPrevPartMax(NABufferIterator* iter){
       naError("Buffer bitCount is not Null.");
   #endif
   iter->curBit = 0;
+  iter->bitCount = 0;
   iter->lineNum = 0;
   naIterateTreeBack(&(iter->partIter), NA_NULL, NA_NULL);
+  iter->partIndex--;
   if(naIsTreeAtInitial(&(iter->partIter))){
     const NABuffer* buffer = na_GetBufferIteratorBufferConst(iter);
     iter->partOffset = (NAInt)buffer->range.origin;
@@ -235,7 +308,9 @@ NA_HDEF NABool na_LocateBufferMax(NABufferIterator* iter){
     if(iter->curBit != 0)
       naError("Buffer bitCount is not Null.");
   #endif
+  iter->bitCount = 0;
   naLocateTreeLast(&(iter->partIter));
+  iter->partIndex = na_GetBufferIteratorBufferConst(iter)->partIndexCount - 1;
   if(naIsTreeAtInitial(&(iter->partIter))){
     const NABuffer* buffer = na_GetBufferIteratorBufferConst(iter);
     iter->partOffset = (NAInt)naGetRangeiEnd(buffer->range);
@@ -255,6 +330,7 @@ NA_HDEF NABool na_LocateBufferEnd(NABufferIterator* iter){
       naError("Buffer bitCount is not Null.");
   #endif
   buffer = na_GetBufferIteratorBufferConst(iter);
+  iter->bitCount = 0;
   if(buffer->range.length){
     iter->partOffset = (NAInt)naGetRangeiEnd(buffer->range);
   }else{
@@ -274,6 +350,7 @@ NA_HDEF NABool na_IterateBufferPart(NABufferIterator* iter){
       naError("partOffset is not Null.");
   #endif
   success = naIterateTree(&(iter->partIter), NA_NULL, NA_NULL);
+  iter->partIndex++;
   if(!success){
     const NABuffer* buffer = na_GetBufferIteratorBufferConst(iter);
     iter->partOffset = (NAInt)naGetRangeiEnd(buffer->range);
@@ -283,11 +360,118 @@ NA_HDEF NABool na_IterateBufferPart(NABufferIterator* iter){
 
 
 
+// The tree of the parts is general and every step through it calls the
+// callbacks of the tree configuration. Therefore, the start offsets of all
+// parts are additionally stored in a flat array sorted by offset which is
+// searched binary. Together with the position stored in the iterators, this
+// locates the current or neighbouring part of an iterator in constant time.
+//
+// Whenever the parts change, the index becomes invalid and searches fall back
+// to the tree. Because buffers which are being prepared or appended to change
+// all the time, na_InvalidateBufferPartIndex only rebuilds the index after
+// some changes. The index is never written when searching, hence any number
+// of accessors can search a buffer whose parts do not change.
+NA_HDEF void na_UpdateBufferPartIndex(NABuffer* buffer){
+  NATreeIterator partIter;
+  NAInt offset;
+  size_t count;
+
+  offset = buffer->range.origin;
+  count = 0;
+  partIter = naMakeTreeAccessor(&(buffer->parts));
+  while(naIterateTree(&partIter, NA_NULL, NA_NULL)){
+    const NABufferPart* part = naGetTreeCurLeafConst(&partIter);
+    if(count == NA_BUFFER_PART_INDEX_MAX_COUNT){
+      // The buffer is too fragmented. The tree will be used until some time
+      // after the parts have changed again.
+      buffer->partIndexCount = NA_BUFFER_PART_INDEX_MAX_COUNT;
+      buffer->partIndexCountdown = NA_BUFFER_PART_INDEX_MAX_COUNT / NA_BUFFER_PART_INDEX_REBUILD_DIVISOR;
+      buffer->partIndexValid = NA_FALSE;
+      naClearTreeIterator(&partIter);
+      return;
+    }
+    if(count == buffer->partIndexCapacity){
+      NABufferPartIndexEntry* newIndex;
+      buffer->partIndexCapacity = naMaxs(2 * buffer->partIndexCapacity, 16);
+      newIndex = naMalloc(buffer->partIndexCapacity * sizeof(NABufferPartIndexEntry));
+      if(buffer->partIndex){
+        naCopyn(newIndex, buffer->partIndex, count * sizeof(NABufferPartIndexEntry));
+        naFree(buffer->partIndex);
+      }
+      buffer->partIndex = newIndex;
+    }
+    buffer->partIndex[count].start = offset;
+    buffer->partIndex[count].item = partIter.item;
+    offset += (NAInt)na_GetBufferPartByteSize(part);
+    count++;
+  }
+  naClearTreeIterator(&partIter);
+
+  // An empty index is never valid as searching in the tree is trivial.
+  buffer->partIndexCount = count;
+  buffer->partIndexCountdown = count / NA_BUFFER_PART_INDEX_REBUILD_DIVISOR;
+  buffer->partIndexEnd = offset;
+  buffer->partIndexValid = (count != 0);
+}
+
+
+
+// Returns the position of the part containing offset in the part index or -1
+// if the offset is outside of all parts. The index must be valid. The part
+// given by hint and the following one are tested first.
+NA_HDEF NAInt na_SearchBufferPartIndex(const NABuffer* buffer, size_t hint, NAInt offset){
+  const NABufferPartIndexEntry* index = buffer->partIndex;
+  size_t lower;
+  size_t upper;
+
+  if(offset < index[0].start || offset >= buffer->partIndexEnd){return -1;}
+
+  if(hint < buffer->partIndexCount && offset >= index[hint].start){
+    if(hint + 1 == buffer->partIndexCount || offset < index[hint + 1].start){
+      return (NAInt)hint;
+    }
+    if(hint + 2 == buffer->partIndexCount || offset < index[hint + 2].start){
+      return (NAInt)hint + 1;
+    }
+  }
+
+  // Find the last part starting at or before offset.
+  lower = 0;
+  upper = buffer->partIndexCount;
+  while(upper - lower > 1){
+    size_t mid = lower + (upper - lower) / 2;
+    if(index[mid].start <= offset){
+      lower = mid;
+    }else{
+      upper = mid;
+    }
+  }
+  return (NAInt)lower;
+}
+
+
+
 NA_DEF NABool naLocateBufferAbsolute(NABufferIterator* iter, NAInt offset){
   const NABuffer* buffer = na_GetBufferIteratorBufferConst(iter);
   NABufferSearchToken token;
   NABool found;
   
+  iter->bitCount = 0;
+
+  if(buffer->partIndexValid){
+    NAInt index = na_SearchBufferPartIndex(buffer, iter->partIndex, offset);
+    if(index >= 0){
+      na_SetTreeIteratorCurItem(&(iter->partIter), buffer->partIndex[index].item);
+      iter->partIndex = (size_t)index;
+      iter->partOffset = offset - buffer->partIndex[index].start;
+      return NA_TRUE;
+    }else{
+      naResetTreeIterator(&(iter->partIter));
+      iter->partOffset = offset;
+      return NA_FALSE;
+    }
+  }
+
   token.searchOffset = offset;
   token.curOffset = buffer->range.origin;
   naResetTreeIterator(&(iter->partIter));
@@ -311,7 +495,7 @@ NA_HDEF NABuffer* na_GetBufferIteratorCache(NABufferIterator* iter){
     NABufferPart* part = na_GetBufferPart(iter);
     source = na_GetBufferPartSource(part);
   }
-  if(source){
+  if(source && na_HasBufferSourceCache(source)){
     return na_GetBufferSourceCache(source);
   }else{
     return NA_NULL;
@@ -327,16 +511,19 @@ NA_DEF NABool naIterateBuffer(NABufferIterator* iter, NAInt step){
     if(!step)
       naError("step is zero");
   #endif
+  iter->bitCount = 0;
   if(naIsBufferEmpty(buffer)){
     return NA_FALSE;
   }
   if(naIsTreeAtInitial(&(iter->partIter))){
     if(step > 0){
       naLocateTreeFirst(&(iter->partIter));
+      iter->partIndex = 0;
       part = naGetTreeCurLeafConst(&(iter->partIter));
       iter->partOffset = (NAInt)-1; // Oh yeah, that must be refactored definitely.
     }else{
       naLocateTreeLast(&(iter->partIter));
+      iter->partIndex = buffer->partIndexCount - 1;
       part = naGetTreeCurLeafConst(&(iter->partIter));
       iter->partOffset = (NAInt)na_GetBufferPartByteSize(part);
     }
@@ -347,6 +534,7 @@ NA_DEF NABool naIterateBuffer(NABufferIterator* iter, NAInt step){
   if(step > 0){
     while(!naIsTreeAtInitial(&(iter->partIter)) && iter->partOffset >= (NAInt)na_GetBufferPartByteSize(part)){
       naIterateTree(&(iter->partIter), NA_NULL, NA_NULL);
+      iter->partIndex++;
       if(!naIsTreeAtInitial(&(iter->partIter))){
         iter->partOffset -= na_GetBufferPartByteSize(part);
         part = naGetTreeCurLeafConst(&(iter->partIter));
@@ -358,6 +546,7 @@ NA_DEF NABool naIterateBuffer(NABufferIterator* iter, NAInt step){
   }else{
     while(!naIsTreeAtInitial(&(iter->partIter)) && iter->partOffset < 0){
       naIterateTreeBack(&(iter->partIter), NA_NULL, NA_NULL);
+      iter->partIndex--;
       if(!naIsTreeAtInitial(&(iter->partIter))){
         iter->partOffset += na_GetBufferPartByteSize(part);
         part = naGetTreeCurLeafConst(&(iter->partIter));
@@ -418,7 +607,16 @@ NA_HDEF void na_EnsureBufferRangeAndLocate(NABufferIterator* iter, NAInt abspos,
 // means that after this function, it is guaranteed that all bytes are present
 // in memory.
 NA_HDEF void na_PrepareBuffer(NABufferIterator* iter, size_t byteCount){
+  na_PrepareBufferParts(iter, byteCount, NA_FALSE);
+}
+
+
+
+// Prepares all parts of the given range. If prefetch is NA_TRUE, the parts may
+// still be filled in the background when this function returns.
+NA_HDEF void na_PrepareBufferParts(NABufferIterator* iter, size_t byteCount, NABool prefetch){
   NATreeIterator firstBufIterator;
+  size_t firstBufOffset = 0;
   #if NA_DEBUG
     if(naGetBufferCurBit(iter))
       naError("bitCount should be 0");
@@ -426,8 +624,10 @@ NA_HDEF void na_PrepareBuffer(NABufferIterator* iter, size_t byteCount){
       naError("byteCount should be >= 1");
   #endif
 
+  // Any bits read ahead may become invalid.
+  iter->bitCount = 0;
+
   firstBufIterator = naMakeTreeAccessor(&(na_GetBufferIteratorBufferConst(iter)->parts));
-  size_t firstBufOffset = 0;
 
   // We perform the preparation as long as there are still bytes left. As we
   // split buffers into parts, it may be the case that there are many parts
@@ -452,7 +652,7 @@ NA_HDEF void na_PrepareBuffer(NABufferIterator* iter, size_t byteCount){
 
     // //////////////////////////
     // We prepare the current part.
-    size_t preparedByteCount = na_PrepareBufferPart(iter, byteCount);
+    size_t preparedByteCount = na_PrepareBufferPart(iter, byteCount, prefetch);
     // //////////////////////////
 
     // Reaching here, iter points at a part filled with memory. Now, we can
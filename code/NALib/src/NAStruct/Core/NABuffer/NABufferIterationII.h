@@ -5,11 +5,28 @@
 
 
 
+// The bits of the bytes following the current bit are read ahead into an
+// integer as big as possible. See naRefillBufferBits. The same is true for
+// bits being written, see naWriteBufferBits.
+#if defined NA_TYPE_INT64
+  typedef uint64 NA_BufferBits;
+  #define NA_BUFFER_BITS_COUNT_MAX 32
+#else
+  typedef uint32 NA_BufferBits;
+  #define NA_BUFFER_BITS_COUNT_MAX 24
+#endif
+
 struct NABufferIterator{
   NAPtr bufferPtr;
   NATreeIterator partIter;
   NAInt partOffset; // The current byte offset in the referenced part.
+  size_t partIndex; // Where the current part probably is in the part index.
+  NABool changedParts; // True if this iterator prepared any part.
   uint8 curBit;     // The current bit number
+  uint8 bitCount;   // The number of valid bits in bitBuffer.
+  NA_BufferBits bitBuffer; // The bits starting at curBit, lowest bit first.
+  uint8 writeBitCount;     // The number of bits in writeBits.
+  NA_BufferBits writeBits; // The bits not yet written, lowest bit first.
   size_t lineNum;   // The line number, starting with 1 after first line read.
 };
 
@@ -27,6 +44,24 @@ NA_HIDEF NABuffer* na_GetBufferIteratorBufferMutable(NABufferIterator* iter){
 
 
 
+// After a rebuild, the part index is rebuilt again when the number of changes
+// of the parts reaches the number of parts divided by this.
+#define NA_BUFFER_PART_INDEX_REBUILD_DIVISOR 16
+
+// Must be called whenever the parts of the buffer change, be it their number,
+// their order or their byte size. Only the functions changing the parts
+// rebuild the index, hence iterators only read it.
+NA_HIDEF void na_InvalidateBufferPartIndex(NABuffer* buffer){
+  buffer->partIndexValid = NA_FALSE;
+  if(buffer->partIndexCountdown){
+    buffer->partIndexCountdown--;
+  }else{
+    na_UpdateBufferPartIndex(buffer);
+  }
+}
+
+
+
 NA_IDEF NABool naLocateBufferRelative(NABufferIterator* iter, NAInt offset){
   NAInt abspos = naGetBufferLocation(iter);
   return naLocateBufferAbsolute(iter, abspos + offset);
@@ -1,6 +1,9 @@
 
 #include "../../NABuffer.h"
 
+// The number of buffer parts naWriteBufferToFile writes at once.
+#define NA_BUFFER_WRITE_GATHER_COUNT 256
+
 // /////////////////////////////////////
 // Whole Buffer Functions
 // /////////////////////////////////////
@@ -191,9 +194,107 @@ NA_DEF void naAccumulateChecksumBuffer(NAChecksum* checksum, NABuffer* buffer){
 
 
 
+// Returns the number of parts starting at index which will be coalesced into
+// one part. Only small parts with memory are coalesced until their bytes
+// reach minPartSize. All other parts result in 1.
+NA_HDEF size_t na_GetBufferCompactionRunCount(NABufferPart* const* parts, size_t partCount, size_t index, size_t minPartSize){
+  size_t runCount = 0;
+  size_t runByteSize = 0;
+  while(index + runCount < partCount && runByteSize < minPartSize){
+    const NABufferPart* part = parts[index + runCount];
+    if(na_IsBufferPartSparse(part) || na_GetBufferPartByteSize(part) >= minPartSize){break;}
+    runByteSize += na_GetBufferPartByteSize(part);
+    runCount++;
+  }
+  return naMaxs(runCount, 1);
+}
+
+
+
+NA_DEF void naCompactBuffer(NABuffer* buffer, size_t minPartSize){
+  NABufferPart** parts;
+  NATreeIterator partIter;
+  size_t partCount;
+  size_t newPartCount;
+  NABool complete;
+  size_t i;
+
+  #if NA_DEBUG
+    if(buffer->iterCount)
+      naError("There are still iterators running. They would point to deleted parts.");
+    if(minPartSize == 0)
+      naError("minPartSize is zero.");
+  #endif
+
+  buffer->compactPartCount = naMaxs(NA_BUFFER_COMPACT_PART_COUNT, 2 * buffer->partCount);
+  if(buffer->partCount < 2){return;}
+
+  // Collect the parts in their order.
+  parts = naMalloc(buffer->partCount * sizeof(NABufferPart*));
+  partCount = 0;
+  complete = NA_TRUE;
+  partIter = naMakeTreeMutator(&(buffer->parts));
+  while(naIterateTree(&partIter, NA_NULL, NA_NULL)){
+    if(partCount == buffer->partCount){
+      // Never write beyond the array. Rebuilding the tree would lose parts.
+      #if NA_DEBUG
+        naError("Internal error: Buffer has more parts than counted.");
+      #endif
+      complete = NA_FALSE;
+      break;
+    }
+    parts[partCount] = naGetTreeCurLeafMutable(&partIter);
+    partCount++;
+  }
+  naClearTreeIterator(&partIter);
+  if(!complete){
+    naFree(parts);
+    return;
+  }
+
+  // Count the parts after compaction. Stop if nothing can be coalesced.
+  newPartCount = 0;
+  for(i = 0; i < partCount; i += na_GetBufferCompactionRunCount(parts, partCount, i, minPartSize)){
+    newPartCount++;
+  }
+
+  if(newPartCount < partCount){
+    // Create the new parts in place of the array. The old parts are not needed
+    // anymore once they have been moved or coalesced.
+    size_t newIndex = 0;
+    i = 0;
+    while(i < partCount){
+      size_t runCount = na_GetBufferCompactionRunCount(parts, partCount, i, minPartSize);
+      if(runCount > 1){
+        parts[newIndex] = na_NewBufferPartCoalesced(&(parts[i]), runCount);
+      }else{
+        parts[newIndex] = na_NewBufferPartMoved(parts[i]);
+      }
+      i += runCount;
+      newIndex++;
+    }
+
+    // Replace all parts of the tree. The old parts get deleted.
+    naEmptyTree(&(buffer->parts));
+    for(i = 0; i < newPartCount; i++){
+      naAddTreeLastMutable(&(buffer->parts), parts[i]);
+    }
+    buffer->partCount = newPartCount;
+    buffer->compactPartCount = naMaxs(NA_BUFFER_COMPACT_PART_COUNT, 2 * newPartCount);
+    na_UpdateBufferPartIndex(buffer);
+  }
+
+  naFree(parts);
+}
+
+
+
 NA_DEF void naWriteBufferToFile(NABuffer* buffer, NAFile* file){
   NAInt byteSize;
   NABufferIterator iter;
+  const void* ptrs[NA_BUFFER_WRITE_GATHER_COUNT];
+  size_t byteSizes[NA_BUFFER_WRITE_GATHER_COUNT];
+  size_t count = 0;
 
   #if NA_DEBUG
     if(!naHasBufferFixedRange(buffer))
@@ -205,20 +306,31 @@ NA_DEF void naWriteBufferToFile(NABuffer* buffer, NAFile* file){
     iter = naMakeBufferAccessor(buffer);
     na_LocateBufferStart(&iter);
 
+    // The parts are collected and written in batches to reduce the number
+    // of system calls for buffers consisting of many small parts.
     while(byteSize){
       NABufferPart* part = na_GetBufferPart(&iter);
       size_t remainingBytes = na_GetBufferPartByteSize(part);
-      const NAByte* src = na_GetBufferPartDataPointerConst(&iter);
 
       #if NA_DEBUG
         if(na_IsBufferPartSparse(part))
           naError("Buffer contains sparse parts.");
       #endif
 
-      naWriteFileBytes(file, src, (NAFileSize)remainingBytes);
+      ptrs[count] = na_GetBufferPartDataPointerConst(&iter);
+      byteSizes[count] = remainingBytes;
+      count++;
+      if(count == NA_BUFFER_WRITE_GATHER_COUNT){
+        naWriteFileBytesGathered(file, ptrs, byteSizes, count);
+        count = 0;
+      }
+
       na_LocateBufferNextPart(&iter);
       byteSize -= remainingBytes;
     }
+    if(count){
+      naWriteFileBytesGathered(file, ptrs, byteSizes, count);
+    }
 
     naClearBufferIterator(&iter);
   }
@@ -82,6 +82,64 @@ NA_HDEF NABufferPart* na_NewBufferPartWithMutableData(void* data, size_t byteSiz
 
 
 
+// Creates a buffer part taking over the source and the memory block of the
+// given part. The given part is left without references and can be deleted.
+NA_HDEF NABufferPart* na_NewBufferPartMoved(NABufferPart* part){
+  NABufferPart* newPart = naNew(NABufferPart);
+  newPart->source = part->source;
+  newPart->sourceOffset = part->sourceOffset;
+  newPart->byteSize = part->byteSize;
+  newPart->blockOffset = part->blockOffset;
+  newPart->memBlock = part->memBlock;
+  part->source = NA_NULL;
+  part->memBlock = NA_NULL;
+  return newPart;
+}
+
+
+
+// Creates a buffer part with a new memory block containing the bytes of all
+// given parts which must not be sparse. The source is only kept if all parts
+// reference consecutive bytes of the same source.
+NA_HDEF NABufferPart* na_NewBufferPartCoalesced(NABufferPart* const* parts, size_t count){
+  NABufferSource* source = parts[0]->source;
+  NAInt sourceOffset = parts[0]->sourceOffset;
+  size_t byteSize = 0;
+  size_t i;
+  NABufferPart* part;
+  NAByte* dst;
+
+  for(i = 0; i < count; i++){
+    #if NA_DEBUG
+      if(na_IsBufferPartSparse(parts[i]))
+        naError("part is sparse");
+    #endif
+    if(parts[i]->source != source || parts[i]->sourceOffset != sourceOffset + (NAInt)byteSize){
+      source = NA_NULL;
+    }
+    byteSize += parts[i]->byteSize;
+  }
+
+  part = naNew(NABufferPart);
+  part->source = source ? naRetain(source) : NA_NULL;
+  part->sourceOffset = source ? sourceOffset : 0;
+  part->byteSize = byteSize;
+  part->blockOffset = 0;
+  part->memBlock = na_CreateMemoryBlock(byteSize);
+
+  dst = na_GetMemoryBlockDataPointerMutable(part->memBlock, 0);
+  for(i = 0; i < count; i++){
+    naCopyn(
+      dst,
+      na_GetMemoryBlockDataPointerConst(parts[i]->memBlock, parts[i]->blockOffset),
+      parts[i]->byteSize);
+    dst += parts[i]->byteSize;
+  }
+  return part;
+}
+
+
+
 // The destructor method which will automatically be called by naRelease.
 NA_HDEF void na_DestructBufferPart(NABufferPart* part){
   if(part->source){naRelease(part->source);}
@@ -119,7 +177,7 @@ NA_HDEF void na_DecoupleBufferPart(NABufferPart* part){
 // other, newly created sparse parts. At the end, this function moves the
 // iterator to the desired part and returns that part.
 // The start and end parameters must be positive definite.
-NA_HDEF NABufferPart* na_SplitBufferPart(NATreeIterator* partIter, size_t start, size_t end){
+NA_HDEF NABufferPart* na_SplitBufferPart(NABuffer* buffer, NATreeIterator* partIter, size_t start, size_t end){
   NABufferPart* part = naGetTreeCurLeafMutable(partIter);
 
   #if NA_DEBUG
@@ -154,6 +212,7 @@ NA_HDEF NABufferPart* na_SplitBufferPart(NATreeIterator* partIter, size_t start,
     NAInt sourceOffset = na_GetBufferPartSourceOffset(part);
     NABufferPart* newPart = na_NewBufferPartSparse(part->source, naMakeRangeiWithStartAndEnd(sourceOffset + (NAInt)end, sourceOffset + (NAInt)prevByteSize));
     naAddTreeNextMutable(partIter, newPart, NA_FALSE);
+    buffer->partCount++;
   }
 
   if(start > 0){
@@ -165,6 +224,7 @@ NA_HDEF NABufferPart* na_SplitBufferPart(NATreeIterator* partIter, size_t start,
     NAInt sourceOffset = na_GetBufferPartSourceOffset(part);
     NABufferPart* newPart = na_NewBufferPartSparse(part->source, naMakeRangeiWithStartAndEnd(sourceOffset + (NAInt)start, sourceOffset + (NAInt)end));
     naAddTreeNextMutable(partIter, newPart, NA_TRUE);
+    buffer->partCount++;
     // Note that using the NA_TRUE, we automatically move to the new part.
     // This means that iter now points to the desired part.
   }
@@ -176,7 +236,7 @@ NA_HDEF NABufferPart* na_SplitBufferPart(NATreeIterator* partIter, size_t start,
 
 // This function prepares the current part by calling the prepare function
 // of the cache and referencing the memory block.
-NA_HDEF NABufferPart* na_PrepareBufferPartCache(NATreeIterator* partIter, NARangei partRange){  
+NA_HDEF NABufferPart* na_PrepareBufferPartCache(NABuffer* buffer, NATreeIterator* partIter, NARangei partRange, NABool prefetch){
   NABufferPart* returnPart = naGetTreeCurLeafMutable(partIter);
 
   #if NA_DEBUG
@@ -186,7 +246,19 @@ NA_HDEF NABufferPart* na_PrepareBufferPartCache(NATreeIterator* partIter, NARang
       naError("range origin is negative");
   #endif
 
-  NAInt sourceOffset = na_GetBufferPartSourceOffset(returnPart) + partRange.origin;
+  // The part must start exactly at the desired byte as it will reference the
+  // memory of the source part containing that byte.
+  if(partRange.origin > 0){
+    returnPart = na_SplitBufferPart(buffer, partIter, (size_t)partRange.origin, returnPart->byteSize);
+    partRange.origin = 0;
+  }
+  // The following parts might not be sparse anymore. They will be prepared
+  // separately.
+  if(partRange.length > (NAInt)returnPart->byteSize){
+    partRange.length = (NAInt)returnPart->byteSize;
+  }
+
+  NAInt sourceOffset = na_GetBufferPartSourceOffset(returnPart);
   NABuffer* sourceCache = na_GetBufferSourceCache(returnPart->source);
 
   #if NA_DEBUG
@@ -230,7 +302,7 @@ NA_HDEF NABufferPart* na_PrepareBufferPartCache(NATreeIterator* partIter, NARang
   // Now we can be sure that the buffer iterator is pointing at sourceOffset.
   
   // Recursive call to the source buffer to prepare the desired range.
-  na_PrepareBuffer(&sourceIter, (size_t)partRange.length);
+  na_PrepareBufferParts(&sourceIter, (size_t)partRange.length, prefetch);
 
   // Reaching here, we know that the full range is prepared in the source
   // and sourceIter points at the desired byte in the source buffer.
@@ -296,7 +368,7 @@ NA_HDEF NABufferPart* na_PrepareBufferPartCache(NATreeIterator* partIter, NARang
     size_t remainingBytesInSourcePart = sourcePart->byteSize - (size_t)sourceIter.partOffset;
 
     if((size_t)remainingBytesInSourcePart < curPart->byteSize){
-      na_SplitBufferPart(&curPartIter, 0, remainingBytesInSourcePart);
+      na_SplitBufferPart(buffer, &curPartIter, 0, remainingBytesInSourcePart);
     }
     
     curPart->memBlock = naRetain(na_GetBufferPartMemoryBlock(sourcePart));
@@ -337,7 +409,7 @@ NA_HDEF NABufferPart* na_PrepareBufferPartCache(NATreeIterator* partIter, NARang
 
 // This function expects a sparse buffer part, splits it such that a suitable
 // range can be made non-sparse and that range is filled with memory.
-NA_HDEF NABufferPart* na_PrepareBufferPartMemory(NATreeIterator* partIter, NARangei partRange){
+NA_HDEF NABufferPart* na_PrepareBufferPartMemory(NABuffer* buffer, NATreeIterator* partIter, NARangei partRange, NABool prefetch){
   NABufferPart* part = naGetTreeCurLeafMutable(partIter);
 
   #if NA_DEBUG
@@ -347,6 +419,18 @@ NA_HDEF NABufferPart* na_PrepareBufferPartMemory(NATreeIterator* partIter, NARan
       naError("range origin is negative");
   #endif
 
+  // If the source is a mapped file, the whole part can reference the mapping
+  // directly. Neither splitting nor copying is necessary.
+  if(part->source && na_HasBufferSourceMapping(part->source)){
+    #if NA_DEBUG
+      if(na_GetBufferPartSourceOffset(part) < 0)
+        naError("source offset is negative");
+    #endif
+    part->memBlock = naRetain(na_GetBufferSourceMapping(part->source));
+    part->blockOffset = (size_t)na_GetBufferPartSourceOffset(part);
+    return part;
+  }
+
   // We try to split the current sparse part such that in the end, there is
   // a part containing at least the byte pointed to by partRange.origin but
   // possibly a few bytes more. We do this by aligning start and end at
@@ -360,21 +444,24 @@ NA_HDEF NABufferPart* na_PrepareBufferPartMemory(NATreeIterator* partIter, NARan
   if(normedEnd > (NAInt)part->byteSize){normedEnd = (NAInt)part->byteSize;}
 
   // We split the sparse part as necessary.
-  part = na_SplitBufferPart(partIter, (size_t)normedStart, (size_t)normedEnd);
+  part = na_SplitBufferPart(buffer, partIter, (size_t)normedStart, (size_t)normedEnd);
 
   // Now, the part has been split in whatever was necessary.
   // Let's create the memory block.
   part->memBlock = na_CreateMemoryBlock(part->byteSize);
   part->blockOffset = 0;
   
-  // Fill the memory block according to the source.
+  // Fill the memory block according to the source. When prefetching, this
+  // happens in the background.
   if(part->source){
     NAInt sourceOffset = na_GetBufferPartSourceOffset(part);
-    void* dst = na_GetMemoryBlockDataPointerMutable(part->memBlock, 0);
-    na_FillBufferSourceMemory(
-      part->source,
-      dst,
-      naMakeRangeiWithStartAndEnd(sourceOffset, sourceOffset + (NAInt)part->byteSize));
+    NARangei sourceRange = naMakeRangeiWithStartAndEnd(sourceOffset, sourceOffset + (NAInt)part->byteSize);
+    if(prefetch && part->source->bufFiller){
+      na_FillMemoryBlockAsync(part->memBlock, part->source, sourceRange);
+    }else{
+      void* dst = na_GetMemoryBlockDataPointerMutable(part->memBlock, 0);
+      na_FillBufferSourceMemory(part->source, dst, sourceRange);
+    }
   }
 
   return part;
@@ -388,7 +475,9 @@ NA_HDEF NABufferPart* na_PrepareBufferPartMemory(NATreeIterator* partIter, NARan
 // part but always results in iterator pointing to a part being completely
 // prepared and the number of available bytes after the current byte is
 // returned.
-NA_HDEF size_t na_PrepareBufferPart(NABufferIterator* iter, size_t byteCount){
+// If prefetch is NA_TRUE, the part may still be filled in the background when
+// this function returns. Otherwise, this function waits for such fills.
+NA_HDEF size_t na_PrepareBufferPart(NABufferIterator* iter, size_t byteCount, NABool prefetch){
   #if NA_DEBUG
     if(iter->partOffset < 0)
       naError("part offset is negative.");
@@ -397,19 +486,34 @@ NA_HDEF size_t na_PrepareBufferPart(NABufferIterator* iter, size_t byteCount){
   NABufferPart* part = na_GetBufferPart(iter);
 
   if(na_IsBufferPartSparse(part)){
+    NABuffer* buffer = na_GetBufferIteratorBufferMutable(iter);
+    NABufferPart* sparsePart = part;
     // We decide how to prepare the part.
     NABuffer* cache = na_GetBufferIteratorCache(iter);
     if(cache){
       // There is a cache, so we try to fill the part with it.
       part = na_PrepareBufferPartCache(
+        buffer,
         &(iter->partIter),
-        naMakeRangei(iter->partOffset, (NAInt)byteCount));
+        naMakeRangei(iter->partOffset, (NAInt)byteCount),
+        prefetch);
     }else{
       // We have no cache, meaning, we prepare memory ourselfes.
       part = na_PrepareBufferPartMemory(
+        buffer,
         &(iter->partIter),
-        naMakeRangei(iter->partOffset, (NAInt)byteCount));
+        naMakeRangei(iter->partOffset, (NAInt)byteCount),
+        prefetch);
     }
+
+    // If the sparse part has been split, the iterator now points at a new
+    // part which directly follows the shrunk sparse part.
+    if(part != sparsePart){
+      iter->partOffset -= (NAInt)sparsePart->byteSize;
+      iter->partIndex++;
+    }
+    na_InvalidateBufferPartIndex(buffer);
+    iter->changedParts = NA_TRUE;
   }
   
   // Reaching here, the current part is a prepared part. We compute the number
@@ -419,6 +523,14 @@ NA_HDEF size_t na_PrepareBufferPart(NABufferIterator* iter, size_t byteCount){
     if(preparedByteCount <= 0)
       naError("Internal error: Returned value should be greater zero");
   #endif
+
+  // Note that a running fill is waited for when the data is accessed.
+  if(prefetch && na_IsMemoryBlockFileMapping(part->memBlock)){
+    // Mapped files are read by the system. Let it start in the background.
+    naPrefetchFileMapping(
+      na_GetMemoryBlockDataPointerMutable(part->memBlock, part->blockOffset + (size_t)iter->partOffset),
+      (size_t)naMini(preparedByteCount, (NAInt)byteCount));
+  }
   return (size_t)preparedByteCount;
 }
 
@@ -107,41 +107,140 @@ NA_DEF NAByte naGetBufferByteAtIndex(NABuffer* buffer, size_t index){
 // BIT MANIPULATION
 // /////////////////////////////////
 
-NA_DEF NABool naReadBufferBit(NABufferIterator* iter){
-  const NAByte* src;
-  NABool bit;
-  NA_UNUSED(iter);
+// Reads up to byteCount bytes starting at the given absolute location into
+// dst and returns the number of bytes read. Used at part boundaries where
+// the bytes may be spread over multiple parts which might not even be
+// prepared yet. Other than the byte reading functions, this function only
+// reads bytes within the range of the buffer except if there are no bytes
+// left at all and the range of the buffer is not fixed in which case one
+// byte is read just like naReadBufferu8 would do.
+NA_HDEF size_t na_RetrieveBufferBitBytes(NABufferIterator* iter, NAInt location, NAByte* dst, size_t byteCount){
+  const NABuffer* buffer = na_GetBufferIteratorBufferConst(iter);
+  NABufferIterator tmpIter;
+  NAInt end = naGetRangeiEnd(buffer->range);
+
+  if(naIsRangeiEmpty(buffer->range) || location >= end || location < buffer->range.origin){
+    if(naHasBufferFixedRange(buffer)){return 0;}
+    byteCount = 1;
+  }else if(location + (NAInt)byteCount > end){
+    byteCount = (size_t)(end - location);
+  }
+
+  tmpIter = naMakeBufferAccessor(buffer);
+  naLocateBufferAbsolute(&tmpIter, location);
+  na_RetrieveBufferBytes(&tmpIter, dst, byteCount, NA_FALSE);
+  naClearBufferIterator(&tmpIter);
+  return byteCount;
+}
+
 
-  if(iter->curBit == 0){
-    na_PrepareBuffer(iter, 1);
+
+NA_DEF void naRefillBufferBits(NABufferIterator* iter){
+  NA_BufferBits newBits = 0;
+  size_t byteIndex;
+  size_t byteCount;
+  size_t loadedCount = 0;
+  uint8 skipBits = 0;
+
+  if(iter->bitCount){
+    // The bits in the accumulator always end at a byte boundary.
+    byteIndex = (size_t)(iter->curBit + iter->bitCount) >> 3;
+  }else{
+    // Start with the byte containing the current bit.
+    byteIndex = 0;
+    skipBits = iter->curBit;
+    iter->bitBuffer = 0;
+  }
+  byteCount = (sizeof(NA_BufferBits) * 8 - iter->bitCount) >> 3;
+  if(!byteCount){return;}
+
+  if(!naIsTreeAtInitial(&(iter->partIter))){
+    NABufferPart* part = na_GetBufferPart(iter);
+    size_t partByteSize = na_GetBufferPartByteSize(part);
+
+    if(iter->partOffset >= 0
+      && (size_t)iter->partOffset + byteIndex + sizeof(NA_BufferBits) <= partByteSize
+      && !na_IsBufferPartSparse(part))
+    {
+      // Fast path: A whole word is available in the current part.
+      const NAByte* src = na_GetMemoryBlockDataPointerConst(
+        part->memBlock,
+        part->blockOffset + (size_t)iter->partOffset + byteIndex);
+      #if NA_ENDIANNESS_HOST == NA_ENDIANNESS_LITTLE
+        memcpy(&newBits, src, sizeof(NA_BufferBits));
+        if(byteCount < sizeof(NA_BufferBits)){
+          newBits &= ((NA_BufferBits)1 << (byteCount * 8)) - 1;
+        }
+      #else
+        size_t i;
+        for(i = 0; i < byteCount; i++){
+          newBits |= (NA_BufferBits)src[i] << (i * 8);
+        }
+      #endif
+      loadedCount = byteCount;
+    }
   }
 
-  src = na_GetBufferPartDataPointerConst(iter);
-  bit = (*src >> iter->curBit) & 0x01;
-  iter->curBit++;
+  if(!loadedCount){
+    // Slow path: The bytes are spread across parts or not prepared yet.
+    NAByte bytes[sizeof(NA_BufferBits)];
+    size_t i;
+    NAInt location = na_GetBufferByteLocation(iter);
+    NA_BufferBits bitBuffer = iter->bitBuffer;
+    uint8 bitCount = iter->bitCount;
+
+    loadedCount = na_RetrieveBufferBitBytes(
+      iter,
+      location + (NAInt)byteIndex,
+      bytes,
+      byteCount);
+    for(i = 0; i < loadedCount; i++){
+      newBits |= (NA_BufferBits)bytes[i] << (i * 8);
+    }
 
-  if(iter->curBit == 8){
-    iter->curBit = 0;
-    iter->partOffset++;
+    // The iterator may have moved beyond its part or its part may have been
+    // prepared in the meantime. Locate it again such that the next refill
+    // can use the fast path.
+    naLocateBufferAbsolute(iter, location);
+    iter->bitBuffer = bitBuffer;
+    iter->bitCount = bitCount;
   }
 
+  if(loadedCount){
+    newBits >>= skipBits;
+    iter->bitBuffer |= newBits << iter->bitCount;
+    iter->bitCount += (uint8)(loadedCount * 8 - skipBits);
+  }
+}
+
+
+
+NA_DEF NABool naReadBufferBit(NABufferIterator* iter){
+  NABool bit;
+  if(!iter->bitCount){
+    naRefillBufferBits(iter);
+  }
+  bit = (NABool)(iter->bitBuffer & 1);
+  naConsumeBufferBits(iter, 1);
   return bit;
 }
 
 
 
 NA_DEF uint32 naReadBufferBits32(NABufferIterator* iter, uint8 count){
-  uint32 retValue = 0;
-  uint32 curmask = 1;
+  uint32 retValue;
   #if NA_DEBUG
     if(count > 32)
       naError("Can read 32 Bits maximum.");
   #endif
-  while(count){
-    NABool curBit = naReadBufferBit(iter);
-    retValue |= curmask * (uint32)curBit;
-    curmask <<= 1;
-    count--;
+  if(count > NA_BUFFER_BITS_COUNT_MAX){
+    retValue = naPeekBufferBits(iter, 16);
+    naConsumeBufferBits(iter, 16);
+    retValue |= naPeekBufferBits(iter, count - 16) << 16;
+    naConsumeBufferBits(iter, count - 16);
+  }else{
+    retValue = naPeekBufferBits(iter, count);
+    naConsumeBufferBits(iter, count);
   }
   return retValue;
 }
@@ -150,8 +249,14 @@ NA_DEF uint32 naReadBufferBits32(NABufferIterator* iter, uint8 count){
 
 NA_DEF void naPadBufferBits(NABufferIterator* iter){
   if(iter->curBit != 0){
-    iter->curBit = 0;
-    iter->partOffset++;
+    uint8 padCount = 8 - iter->curBit;
+    if(iter->bitCount >= padCount){
+      naConsumeBufferBits(iter, padCount);
+    }else{
+      iter->bitCount = 0;
+      iter->curBit = 0;
+      iter->partOffset++;
+    }
   }
 }
 
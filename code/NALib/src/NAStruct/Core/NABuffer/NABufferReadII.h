@@ -254,6 +254,37 @@ NA_IDEF NABuffer* naReadBufferBuffer(NABufferIterator* iter, NAInt byteSize){
 
 
 
+// ////////////////////////////////////
+// BITS
+// ////////////////////////////////////
+
+NA_IDEF uint32 naPeekBufferBits(NABufferIterator* iter, uint8 count){
+  #if NA_DEBUG
+    if(count > NA_BUFFER_BITS_COUNT_MAX)
+      naError("count is too big.");
+  #endif
+  if(iter->bitCount < count){
+    naRefillBufferBits(iter);
+  }
+  return (uint32)(iter->bitBuffer & (((NA_BufferBits)1 << count) - 1));
+}
+
+
+
+NA_IDEF void naConsumeBufferBits(NABufferIterator* iter, uint8 count){
+  uint32 bitOffset = (uint32)iter->curBit + count;
+  #if NA_DEBUG
+    if(count > iter->bitCount)
+      naError("Consuming more bits than available. Use naPeekBufferBits or naRefillBufferBits first.");
+  #endif
+  iter->bitBuffer >>= count;
+  iter->bitCount -= count;
+  iter->partOffset += (NAInt)(bitOffset >> 3);
+  iter->curBit = (uint8)(bitOffset & 7);
+}
+
+
+
 // This is free and unencumbered software released into the public domain.
 
 // Anyone is free to copy, modify, publish, use, compile, sell, or
@@ -4,7 +4,7 @@
 
 
 NA_HAPI void na_DestructBufferSource(NABufferSource* source);
-NA_RUNTIME_TYPE(NABufferSource, na_DestructBufferSource, NA_TRUE);
+NA_RUNTIME_TYPE_ATOMIC(NABufferSource, na_DestructBufferSource);
 
 
 
@@ -17,15 +17,28 @@ NA_DEF NABufferSource* naCreateBufferSource(NABufferFiller filler, NABuffer* cac
   source->dataDestructor = NA_NULL;
   source->flags = 0;
   source->limit = naMakeRangeiWithStartAndEnd(0, 0);
+  source->mapping = NA_NULL;
 
   return source;
 }
 
 
 
+// Creates a source without filler whose parts directly reference the given
+// file mapping. The source takes ownership of the mapping.
+NA_HDEF NABufferSource* na_CreateBufferSourceWithFileMapping(void* data, size_t byteSize){
+  NABufferSource* source = naCreateBufferSource(NA_NULL, NA_NULL);
+  source->mapping = na_CreateMemoryBlockWithFileMapping(data, byteSize);
+  naSetBufferSourceLimit(source, naMakeRangei(0, (NAInt)byteSize));
+  return source;
+}
+
+
+
 NA_HDEF void na_DestructBufferSource(NABufferSource* source){
   if(source->dataDestructor){source->dataDestructor(source->data);}
   if(source->cache){naRelease(source->cache);}
+  if(source->mapping){naRelease(source->mapping);}
 }
 
 
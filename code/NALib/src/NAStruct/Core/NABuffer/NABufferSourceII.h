@@ -18,6 +18,7 @@ struct NABufferSource{
   NAMutator         dataDestructor; // Data destructor.
   uint32            flags;          // Flags for the source
   NARangei          limit;          // Range limit (used if flag set)
+  NAMemoryBlock*    mapping;        // The mapped file, if any.
 };
 
 
@@ -76,6 +77,28 @@ NA_HIDEF NABuffer* na_GetBufferSourceCache(NABufferSource* source){
 
 
 
+NA_HIDEF NABool na_HasBufferSourceMapping(const NABufferSource* source){
+  #if NA_DEBUG
+    if(!source)
+      naCrash("Source is Null");
+  #endif
+  return source->mapping != NA_NULL;
+}
+
+
+
+NA_HIDEF NAMemoryBlock* na_GetBufferSourceMapping(const NABufferSource* source){
+  #if NA_DEBUG
+    if(!source)
+      naCrash("Source is Null");
+    if(!na_HasBufferSourceMapping(source))
+      naError("source has no mapping");
+  #endif
+  return source->mapping;
+}
+
+
+
 // Returns NA_TRUE if the range is a valid limiting range.
 NA_HIDEF NABool na_HasBufferSourceLimit(const NABufferSource* source){
   #if NA_DEBUG
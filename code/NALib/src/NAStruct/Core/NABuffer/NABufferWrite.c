@@ -318,6 +318,56 @@ NA_DEF void naRepeatBufferBytes(NABufferIterator* iter, NAInt distance, size_t b
 
 
 
+// ////////////////////////////////////
+// BIT WRITING
+// ////////////////////////////////////
+
+// Writes all complete bytes of the bits written with naWriteBufferBits to
+// the buffer. If flushAll is NA_TRUE, an incomplete last byte is written as
+// well, filled up with zero bits.
+NA_HDEF void na_StoreBufferBits(NABufferIterator* iter, NABool flushAll){
+  NAByte bytes[sizeof(NA_BufferBits)];
+  size_t byteCount = iter->writeBitCount >> 3;
+  size_t i;
+
+  if(flushAll && (iter->writeBitCount & 7)){
+    byteCount++;
+  }
+  if(!byteCount){return;}
+
+  for(i = 0; i < byteCount; i++){
+    bytes[i] = (NAByte)(iter->writeBits >> (i * 8));
+  }
+
+  if(!naIsTreeAtInitial(&(iter->partIter))
+    && iter->partOffset >= 0
+    && (size_t)iter->partOffset + byteCount <= na_GetBufferPartByteSize(na_GetBufferPart(iter))
+    && !na_IsBufferPartSparse(na_GetBufferPart(iter)))
+  {
+    // Fast path: The bytes fit into the current part.
+    naCopyn(na_GetBufferPartDataPointerMutable(iter), bytes, byteCount);
+    iter->partOffset += (NAInt)byteCount;
+  }else{
+    na_StoreBufferBytes(iter, bytes, byteCount, NA_TRUE, NA_TRUE);
+  }
+
+  if(byteCount == sizeof(NA_BufferBits) || flushAll){
+    iter->writeBits = 0;
+    iter->writeBitCount = 0;
+  }else{
+    iter->writeBits >>= byteCount * 8;
+    iter->writeBitCount -= (uint8)(byteCount * 8);
+  }
+}
+
+
+
+NA_DEF void naFlushBufferBits(NABufferIterator* iter){
+  na_StoreBufferBits(iter, NA_TRUE);
+}
+
+
+
 // ////////////////////////////////////
 // STRING BUFFER WRITING
 // ////////////////////////////////////
@@ -164,6 +164,26 @@ NA_IDEF void naWriteBufferBytes(NABufferIterator* iter, const void* data, size_t
 
 
 
+// ////////////////////////////////////
+// BITS
+// ////////////////////////////////////
+
+NA_IDEF void naWriteBufferBits(NABufferIterator* iter, uint32 value, uint8 count){
+  #if NA_DEBUG
+    if(count > NA_BUFFER_BITS_COUNT_MAX)
+      naError("count is too big.");
+    if(count < 32 && (value >> count))
+      naError("value has more bits than count.");
+  #endif
+  if(iter->writeBitCount + count >= sizeof(NA_BufferBits) * 8){
+    na_StoreBufferBits(iter, NA_FALSE);
+  }
+  iter->writeBits |= (NA_BufferBits)value << iter->writeBitCount;
+  iter->writeBitCount += count;
+}
+
+
+
 // This is free and unencumbered software released into the public domain.
 
 // Anyone is free to copy, modify, publish, use, compile, sell, or
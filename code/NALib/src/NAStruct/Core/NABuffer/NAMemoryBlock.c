@@ -4,7 +4,7 @@
 
 
 NA_HAPI void na_DestructMemoryBlock(NAMemoryBlock* block);
-NA_RUNTIME_TYPE(NAMemoryBlock, na_DestructMemoryBlock, NA_TRUE);
+NA_RUNTIME_TYPE_ATOMIC(NAMemoryBlock, na_DestructMemoryBlock);
 
 
 
@@ -17,6 +17,8 @@ NA_HDEF NAMemoryBlock* na_CreateMemoryBlock(size_t byteSize){
   NAMemoryBlock* block = naCreate(NAMemoryBlock);
   block->data = naMakePtrWithDataMutable(naMalloc(byteSize));
   block->destructor = (NAMutator)naFree;
+  block->mappedByteSize = 0;
+  block->fill = NA_NULL;
   #if NA_DEBUG
     block->byteSize = byteSize;
   #endif
@@ -40,6 +42,8 @@ NA_HDEF NAMemoryBlock* na_CreateMemoryBlockWithData(NAPtr data, size_t byteSize,
   block = naCreate(NAMemoryBlock);
   block->data = data;
   block->destructor = destructor;
+  block->mappedByteSize = 0;
+  block->fill = NA_NULL;
   #if NA_DEBUG
     block->byteSize = byteSize;
   #endif
@@ -48,8 +52,90 @@ NA_HDEF NAMemoryBlock* na_CreateMemoryBlockWithData(NAPtr data, size_t byteSize,
 
 
 
+// Creates a block owning a file mapped with naMapFile. The file will be
+// unmapped when the block is destructed.
+NA_HDEF NAMemoryBlock* na_CreateMemoryBlockWithFileMapping(void* data, size_t byteSize){
+  NAMemoryBlock* block;
+  #if NA_DEBUG
+    if(!data)
+      naError("data is Null");
+    if(byteSize == 0)
+      naError("byteSize is zero");
+  #endif
+  block = naCreate(NAMemoryBlock);
+  block->data = naMakePtrWithDataMutable(data);
+  block->destructor = NA_NULL;
+  block->mappedByteSize = byteSize;
+  block->fill = NA_NULL;
+  #if NA_DEBUG
+    block->byteSize = byteSize;
+  #endif
+  return block;
+}
+
+
+
+NA_HDEF void na_FillMemoryBlockTask(void* arg){
+  NAMemoryBlock* block = (NAMemoryBlock*)arg;
+  na_FillBufferSourceMemory(
+    block->fill->source,
+    naGetPtrMutable(block->data),
+    block->fill->sourceRange);
+  na_SignalSemaphore(&(block->fill->semaphore), 1);
+  // Note that the fill may be deleted from here on.
+}
+
+
+
+// Fills the block with the contents of the source on a thread of the default
+// thread pool. The data getters of the block wait for the fill to finish.
+// The source must have a filler which can be called from any thread.
+NA_HDEF void na_FillMemoryBlockAsync(NAMemoryBlock* block, NABufferSource* source, NARangei sourceRange){
+  #if NA_DEBUG
+    if(!block)
+      naCrash("block is Null");
+    if(block->fill)
+      naError("block is already filled asynchronously");
+    if(naIsPtrConst(block->data))
+      naError("block is const");
+  #endif
+  block->fill = naAlloc(NA_MemoryBlockFill);
+  block->fill->source = naRetain(source);
+  block->fill->sourceRange = sourceRange;
+  na_InitSemaphore(&(block->fill->semaphore));
+  block->fill->mutex = naMakeMutex();
+  naInitAtomic32(&(block->fill->done), 0);
+  naDispatchTask(naGetDefaultThreadPool(), na_FillMemoryBlockTask, block);
+}
+
+
+
+// Waits for the signal of the fill task. Any number of threads may call this
+// at the same time, only the first one actually consumes the signal.
+NA_HDEF void na_FinishMemoryBlockFill(NAMemoryBlock* block){
+  NA_MemoryBlockFill* fill = block->fill;
+  naLockMutex(fill->mutex);
+  if(!naLoadAtomic32(&(fill->done), NA_MEMORY_ORDER_RELAXED)){
+    na_WaitSemaphore(&(fill->semaphore));
+    naStoreAtomic32(&(fill->done), 1, NA_MEMORY_ORDER_RELEASE);
+  }
+  naUnlockMutex(fill->mutex);
+}
+
+
+
 NA_HDEF void na_DestructMemoryBlock(NAMemoryBlock* block){
-  if(block->destructor){
+  // A running fill writes into the memory, hence it must be finished.
+  if(block->fill){
+    na_WaitMemoryBlockFill(block);
+    na_ClearSemaphore(&(block->fill->semaphore));
+    naClearMutex(block->fill->mutex);
+    naRelease(block->fill->source);
+    naFree(block->fill);
+  }
+  if(block->mappedByteSize){
+    naUnmapFile(naGetPtrMutable(block->data), block->mappedByteSize);
+  }else if(block->destructor){
     block->destructor(naGetPtrMutable(block->data));
   }
 }
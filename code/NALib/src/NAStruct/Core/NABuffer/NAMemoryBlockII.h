@@ -5,10 +5,25 @@
 
 
 
+// A fill of a memory block running on a thread of the default thread pool.
+// The semaphore is signaled exactly once when the fill is done. As the block
+// may be shared and read by any number of threads, only the first thread
+// waiting consumes the signal and marks the fill as done. The mutex makes the
+// other threads wait for that. The fill is deleted by the block destructor.
+struct NA_MemoryBlockFill{
+  NABufferSource* source;
+  NARangei        sourceRange;
+  NA_Semaphore    semaphore;
+  NAMutex         mutex;
+  NAAtomic32      done;
+};
+
 struct NAMemoryBlock{
   // automatic reference counting implemented as runtime type.
   NAPtr     data;
   NAMutator destructor;
+  size_t    mappedByteSize; // Non-zero if data is a mapped file.
+  NA_MemoryBlockFill* fill; // Non-Null if filled asynchronously.
   #if NA_DEBUG
     size_t  byteSize;
   #endif
@@ -16,6 +31,23 @@ struct NAMemoryBlock{
 
 
 
+// Returns when the asynchronous fill of the block, if any, is done. All
+// accesses to the data go through the two getters below which wait, hence a
+// prefetched block can never be read while a pool thread still fills it.
+// Once the fill is done, this only costs one acquiring load.
+NA_HIDEF void na_WaitMemoryBlockFill(NAMemoryBlock* block){
+  #if NA_DEBUG
+    if(!block)
+      naCrash("block is Null");
+  #endif
+  if(block->fill && !naLoadAtomic32(&(block->fill->done), NA_MEMORY_ORDER_ACQUIRE)){
+    na_FinishMemoryBlockFill(block);
+  }
+}
+
+
+
+// Waits for an asynchronous fill, see na_WaitMemoryBlockFill.
 NA_HIDEF const void* na_GetMemoryBlockDataPointerConst(NAMemoryBlock* block, size_t index){
   #if NA_DEBUG
     if(!block)
@@ -23,11 +55,13 @@ NA_HIDEF const void* na_GetMemoryBlockDataPointerConst(NAMemoryBlock* block, siz
     if(index >= block->byteSize)
       naError("index out of range");
   #endif
+  na_WaitMemoryBlockFill(block);
   return (const void*)&(((const NAByte*)naGetPtrConst(block->data))[index]);
 }
 
 
 
+// Waits for an asynchronous fill, see na_WaitMemoryBlockFill.
 NA_HIDEF void* na_GetMemoryBlockDataPointerMutable(NAMemoryBlock* block, size_t index){
   #if NA_DEBUG
     if(!block)
@@ -35,11 +69,22 @@ NA_HIDEF void* na_GetMemoryBlockDataPointerMutable(NAMemoryBlock* block, size_t
     if(index >= block->byteSize)
       naError("index out of range");
   #endif
+  na_WaitMemoryBlockFill(block);
   return (void*)&(((const NAByte*)naGetPtrMutable(block->data))[index]);
 }
 
 
 
+NA_HIDEF NABool na_IsMemoryBlockFileMapping(const NAMemoryBlock* block){
+  #if NA_DEBUG
+    if(!block)
+      naCrash("block is Null");
+  #endif
+  return block->mappedByteSize != 0;
+}
+
+
+
 // This is free and unencumbered software released into the public domain.
 
 // Anyone is free to copy, modify, publish, use, compile, sell, or
@@ -64,7 +64,7 @@ NA_IDEF void naClearHeap(NAHeap* heap){
     if(!heap)
       naCrash("heap is Null-Pointer.");
   #endif
-  free(heap->data);
+  naFree(heap->data);
 }
 
 
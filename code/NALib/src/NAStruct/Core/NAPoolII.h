@@ -68,14 +68,14 @@ NA_IDEF void naClearPool(NAPool* pool){
       if(pool->cur != pool->count)
         naError("Pool was created filled but is not filled now.");
     #endif
-    free(pool->storagearray);
+    naFree(pool->storagearray);
   }else{
     #if NA_DEBUG
       if(pool->cur != 0)
         naError("Pool was created empty but is not empty now.");
     #endif
   }
-  free(pool->drops);
+  naFree(pool->drops);
 }
 
 
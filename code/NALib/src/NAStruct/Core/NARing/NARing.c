@@ -0,0 +1,260 @@
+
+#include "../../NARing.h"
+
+
+
+// A thread which wants to wait first registers itself in the waiting count
+// and then tries once more before going to sleep. If that last try succeeds,
+// the registration is left as it is. This may lead to one unnecessary wakeup
+// later on which is harmless as every waiting thread tries again after being
+// woken up.
+NA_HIDEF void na_RegisterRingWaiter(NAAtomic32* waitingCount){
+  naFetchAddAtomic32(waitingCount, 1, NA_MEMORY_ORDER_RELAXED);
+  naFenceAtomic(NA_MEMORY_ORDER_SEQ_CST);
+}
+
+
+
+NA_HIDEF uint32 na_GetRingMask(size_t count){
+  uint32 capacity = 1;
+  #if NA_DEBUG
+    if(count > ((size_t)1 << 30))
+      naError("count is too big.");
+  #endif
+  while(capacity < count){
+    capacity <<= 1;
+  }
+  return capacity - 1;
+}
+
+
+
+NA_DEF NASPSCRing* naInitSPSCRing(NASPSCRing* ring, size_t count){
+  #if NA_DEBUG
+    if(!ring)
+      naCrash("ring is Null-Pointer");
+  #endif
+  ring->mask = na_GetRingMask(count);
+  ring->elements = naMalloc(((size_t)ring->mask + 1) * sizeof(void*));
+  naInitAtomic32(&(ring->pushWaitingCount), 0);
+  naInitAtomic32(&(ring->pullWaitingCount), 0);
+  na_InitSemaphore(&(ring->pushSemaphore));
+  na_InitSemaphore(&(ring->pullSemaphore));
+  naInitAtomic32(&(ring->head), 0);
+  ring->cachedTail = 0;
+  naInitAtomic32(&(ring->tail), 0);
+  ring->cachedHead = 0;
+  return ring;
+}
+
+
+
+NA_DEF void naClearSPSCRing(NASPSCRing* ring){
+  na_ClearSemaphore(&(ring->pushSemaphore));
+  na_ClearSemaphore(&(ring->pullSemaphore));
+  naFree(ring->elements);
+}
+
+
+
+NA_DEF size_t naPushSPSCRingBatch(
+  NASPSCRing* ring,
+  void* const* elements,
+  size_t count)
+{
+  size_t i;
+  uint32 tail = (uint32)naLoadAtomic32(&(ring->tail), NA_MEMORY_ORDER_RELAXED);
+  size_t freeCount = (size_t)ring->mask + 1 - (tail - ring->cachedHead);
+  if(freeCount < count){
+    ring->cachedHead = (uint32)naLoadAtomic32(&(ring->head), NA_MEMORY_ORDER_ACQUIRE);
+    freeCount = (size_t)ring->mask + 1 - (tail - ring->cachedHead);
+    if(freeCount < count){
+      count = freeCount;
+    }
+  }
+  if(!count){return 0;}
+
+  for(i = 0; i < count; i++){
+    ring->elements[(tail + (uint32)i) & ring->mask] = elements[i];
+  }
+  naStoreAtomic32(&(ring->tail), (int32)(tail + (uint32)count), NA_MEMORY_ORDER_RELEASE);
+  na_WakeRingWaiters(&(ring->pullWaitingCount), &(ring->pullSemaphore));
+  return count;
+}
+
+
+
+NA_DEF size_t naPullSPSCRingBatch(
+  NASPSCRing* ring,
+  void** elements,
+  size_t maxCount)
+{
+  size_t i;
+  uint32 head = (uint32)naLoadAtomic32(&(ring->head), NA_MEMORY_ORDER_RELAXED);
+  size_t count = ring->cachedTail - head;
+  if(count < maxCount){
+    ring->cachedTail = (uint32)naLoadAtomic32(&(ring->tail), NA_MEMORY_ORDER_ACQUIRE);
+    count = ring->cachedTail - head;
+  }
+  if(count > maxCount){
+    count = maxCount;
+  }
+  if(!count){return 0;}
+
+  for(i = 0; i < count; i++){
+    elements[i] = ring->elements[(head + (uint32)i) & ring->mask];
+  }
+  naStoreAtomic32(&(ring->head), (int32)(head + (uint32)count), NA_MEMORY_ORDER_RELEASE);
+  na_WakeRingWaiters(&(ring->pushWaitingCount), &(ring->pushSemaphore));
+  return count;
+}
+
+
+
+NA_DEF void naPushSPSCRing(NASPSCRing* ring, void* element){
+  while(!na_PushSPSCRingElement(ring, element)){
+    na_RegisterRingWaiter(&(ring->pushWaitingCount));
+    if(na_PushSPSCRingElement(ring, element)){
+      break;
+    }
+    na_WaitSemaphore(&(ring->pushSemaphore));
+  }
+  na_WakeRingWaiters(&(ring->pullWaitingCount), &(ring->pullSemaphore));
+}
+
+
+
+NA_DEF void* naPullSPSCRing(NASPSCRing* ring){
+  void* element;
+  while(!na_PullSPSCRingElement(ring, &element)){
+    na_RegisterRingWaiter(&(ring->pullWaitingCount));
+    if(na_PullSPSCRingElement(ring, &element)){
+      break;
+    }
+    na_WaitSemaphore(&(ring->pullSemaphore));
+  }
+  na_WakeRingWaiters(&(ring->pushWaitingCount), &(ring->pushSemaphore));
+  return element;
+}
+
+
+
+NA_DEF NAMPMCRing* naInitMPMCRing(NAMPMCRing* ring, size_t count){
+  uint32 i;
+  #if NA_DEBUG
+    if(!ring)
+      naCrash("ring is Null-Pointer");
+  #endif
+  ring->mask = na_GetRingMask(count);
+  ring->cells = naMalloc(((size_t)ring->mask + 1) * sizeof(NA_MPMCRingCell));
+  for(i = 0; i <= ring->mask; i++){
+    naInitAtomic32(&(ring->cells[i].sequence), (int32)i);
+  }
+  naInitAtomic32(&(ring->pushWaitingCount), 0);
+  naInitAtomic32(&(ring->pullWaitingCount), 0);
+  na_InitSemaphore(&(ring->pushSemaphore));
+  na_InitSemaphore(&(ring->pullSemaphore));
+  naInitAtomic32(&(ring->head), 0);
+  naInitAtomic32(&(ring->tail), 0);
+  return ring;
+}
+
+
+
+NA_DEF void naClearMPMCRing(NAMPMCRing* ring){
+  na_ClearSemaphore(&(ring->pushSemaphore));
+  na_ClearSemaphore(&(ring->pullSemaphore));
+  naFree(ring->cells);
+}
+
+
+
+// Other than with the SPSC ring, every element is claimed on its own as
+// claiming multiple cells at once would require waiting for the threads which
+// still use these cells in the previous pass. Only the waking is done once.
+NA_DEF size_t naPushMPMCRingBatch(
+  NAMPMCRing* ring,
+  void* const* elements,
+  size_t count)
+{
+  size_t i = 0;
+  while(i < count && na_PushMPMCRingElement(ring, elements[i])){
+    i++;
+  }
+  if(i){
+    na_WakeRingWaiters(&(ring->pullWaitingCount), &(ring->pullSemaphore));
+  }
+  return i;
+}
+
+
+
+NA_DEF size_t naPullMPMCRingBatch(
+  NAMPMCRing* ring,
+  void** elements,
+  size_t maxCount)
+{
+  size_t i = 0;
+  while(i < maxCount && na_PullMPMCRingElement(ring, &(elements[i]))){
+    i++;
+  }
+  if(i){
+    na_WakeRingWaiters(&(ring->pushWaitingCount), &(ring->pushSemaphore));
+  }
+  return i;
+}
+
+
+
+NA_DEF void naPushMPMCRing(NAMPMCRing* ring, void* element){
+  while(!na_PushMPMCRingElement(ring, element)){
+    na_RegisterRingWaiter(&(ring->pushWaitingCount));
+    if(na_PushMPMCRingElement(ring, element)){
+      break;
+    }
+    na_WaitSemaphore(&(ring->pushSemaphore));
+  }
+  na_WakeRingWaiters(&(ring->pullWaitingCount), &(ring->pullSemaphore));
+}
+
+
+
+NA_DEF void* naPullMPMCRing(NAMPMCRing* ring){
+  void* element;
+  while(!na_PullMPMCRingElement(ring, &element)){
+    na_RegisterRingWaiter(&(ring->pullWaitingCount));
+    if(na_PullMPMCRingElement(ring, &element)){
+      break;
+    }
+    na_WaitSemaphore(&(ring->pullSemaphore));
+  }
+  na_WakeRingWaiters(&(ring->pushWaitingCount), &(ring->pushSemaphore));
+  return element;
+}
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
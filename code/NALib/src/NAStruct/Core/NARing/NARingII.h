@@ -0,0 +1,238 @@
+// This file contains inline implementations of the file NARing.h
+// Do not include this file directly! It will automatically be included when
+// including "NARing.h"
+
+
+#include "../../../NAUtility/NAAtomic.h"
+#include "../../../NAUtility/NAThreading.h"
+
+
+
+// The head is the index of the next element to pull, the tail the index of
+// the next element to push. Both only grow and wrap around at 2^32, hence
+// tail - head is the number of stored elements. Every member written by the
+// producer is on a different cache line than every member written by the
+// consumer.
+//
+// The waiting counts store how many threads sleep on the according
+// semaphore. They are only written when a thread starts to wait.
+struct NASPSCRing{
+  void**       elements;
+  uint32       mask;               // capacity - 1
+  NAAtomic32   pushWaitingCount;
+  NAAtomic32   pullWaitingCount;
+  NA_Semaphore pushSemaphore;
+  NA_Semaphore pullSemaphore;
+  char         pad0[NA_CACHE_LINE_BYTESIZE];
+  NAAtomic32   head;
+  uint32       cachedTail;         // The tail last seen by the consumer.
+  char         pad1[NA_CACHE_LINE_BYTESIZE];
+  NAAtomic32   tail;
+  uint32       cachedHead;         // The head last seen by the producer.
+  char         pad2[NA_CACHE_LINE_BYTESIZE];
+};
+
+// Every cell stores a sequence number telling which pass of the ring it is
+// in: If it equals the position, the cell is free to be pushed, if it equals
+// position + 1, it is filled and can be pulled.
+typedef struct NA_MPMCRingCell NA_MPMCRingCell;
+struct NA_MPMCRingCell{
+  NAAtomic32 sequence;
+  void*      element;
+};
+
+struct NAMPMCRing{
+  NA_MPMCRingCell* cells;
+  uint32           mask;           // capacity - 1
+  NAAtomic32       pushWaitingCount;
+  NAAtomic32       pullWaitingCount;
+  NA_Semaphore     pushSemaphore;
+  NA_Semaphore     pullSemaphore;
+  char             pad0[NA_CACHE_LINE_BYTESIZE];
+  NAAtomic32       head;
+  char             pad1[NA_CACHE_LINE_BYTESIZE];
+  NAAtomic32       tail;
+  char             pad2[NA_CACHE_LINE_BYTESIZE];
+};
+
+
+
+// Wakes up all threads waiting on the semaphore after the ring has changed.
+// The fence pairs with the one in na_RegisterRingWaiter: Either the waiting
+// thread sees the change or this thread sees the waiting thread. Without it,
+// the change of the ring may become visible after the waiting count has been
+// read and a thread which just started to wait would sleep forever.
+NA_HIDEF void na_WakeRingWaiters(NAAtomic32* waitingCount, NA_Semaphore* semaphore){
+  naFenceAtomic(NA_MEMORY_ORDER_SEQ_CST);
+  if(naLoadAtomic32(waitingCount, NA_MEMORY_ORDER_RELAXED) > 0){
+    int32 count = naExchangeAtomic32(waitingCount, 0, NA_MEMORY_ORDER_ACQ_REL);
+    if(count > 0){
+      na_SignalSemaphore(semaphore, (size_t)count);
+    }
+  }
+}
+
+
+
+NA_IDEF size_t naGetSPSCRingCapacity(const NASPSCRing* ring){
+  return (size_t)ring->mask + 1;
+}
+
+
+
+NA_IDEF size_t naGetMPMCRingCapacity(const NAMPMCRing* ring){
+  return (size_t)ring->mask + 1;
+}
+
+
+
+// Pushes or pulls one element of an SPSC ring without waking up anyone.
+NA_HIDEF NABool na_PushSPSCRingElement(NASPSCRing* ring, void* element){
+  uint32 tail = (uint32)naLoadAtomic32(&(ring->tail), NA_MEMORY_ORDER_RELAXED);
+  if(tail - ring->cachedHead > ring->mask){
+    ring->cachedHead = (uint32)naLoadAtomic32(&(ring->head), NA_MEMORY_ORDER_ACQUIRE);
+    if(tail - ring->cachedHead > ring->mask){
+      return NA_FALSE;
+    }
+  }
+  ring->elements[tail & ring->mask] = element;
+  naStoreAtomic32(&(ring->tail), (int32)(tail + 1), NA_MEMORY_ORDER_RELEASE);
+  return NA_TRUE;
+}
+
+
+
+NA_HIDEF NABool na_PullSPSCRingElement(NASPSCRing* ring, void** element){
+  uint32 head = (uint32)naLoadAtomic32(&(ring->head), NA_MEMORY_ORDER_RELAXED);
+  if(head == ring->cachedTail){
+    ring->cachedTail = (uint32)naLoadAtomic32(&(ring->tail), NA_MEMORY_ORDER_ACQUIRE);
+    if(head == ring->cachedTail){
+      return NA_FALSE;
+    }
+  }
+  *element = ring->elements[head & ring->mask];
+  naStoreAtomic32(&(ring->head), (int32)(head + 1), NA_MEMORY_ORDER_RELEASE);
+  return NA_TRUE;
+}
+
+
+
+// Pushes or pulls one element of an MPMC ring without waking up anyone.
+NA_HIDEF NABool na_PushMPMCRingElement(NAMPMCRing* ring, void* element){
+  NA_MPMCRingCell* cell;
+  uint32 pos = (uint32)naLoadAtomic32(&(ring->tail), NA_MEMORY_ORDER_RELAXED);
+  while(1){
+    int32 diff;
+    cell = &(ring->cells[pos & ring->mask]);
+    diff = (int32)((uint32)naLoadAtomic32(&(cell->sequence), NA_MEMORY_ORDER_ACQUIRE) - pos);
+    if(diff == 0){
+      int32 expected = (int32)pos;
+      if(naCompareExchangeAtomic32(&(ring->tail), &expected, (int32)(pos + 1), NA_MEMORY_ORDER_RELAXED)){
+        break;
+      }
+      pos = (uint32)expected;
+    }else if(diff < 0){
+      // The cell still holds the element of the previous pass: Full.
+      return NA_FALSE;
+    }else{
+      pos = (uint32)naLoadAtomic32(&(ring->tail), NA_MEMORY_ORDER_RELAXED);
+    }
+  }
+  cell->element = element;
+  naStoreAtomic32(&(cell->sequence), (int32)(pos + 1), NA_MEMORY_ORDER_RELEASE);
+  return NA_TRUE;
+}
+
+
+
+NA_HIDEF NABool na_PullMPMCRingElement(NAMPMCRing* ring, void** element){
+  NA_MPMCRingCell* cell;
+  uint32 pos = (uint32)naLoadAtomic32(&(ring->head), NA_MEMORY_ORDER_RELAXED);
+  while(1){
+    int32 diff;
+    cell = &(ring->cells[pos & ring->mask]);
+    diff = (int32)((uint32)naLoadAtomic32(&(cell->sequence), NA_MEMORY_ORDER_ACQUIRE) - (pos + 1));
+    if(diff == 0){
+      int32 expected = (int32)pos;
+      if(naCompareExchangeAtomic32(&(ring->head), &expected, (int32)(pos + 1), NA_MEMORY_ORDER_RELAXED)){
+        break;
+      }
+      pos = (uint32)expected;
+    }else if(diff < 0){
+      // The cell has not been filled in this pass: Empty.
+      return NA_FALSE;
+    }else{
+      pos = (uint32)naLoadAtomic32(&(ring->head), NA_MEMORY_ORDER_RELAXED);
+    }
+  }
+  *element = cell->element;
+  naStoreAtomic32(&(cell->sequence), (int32)(pos + ring->mask + 1), NA_MEMORY_ORDER_RELEASE);
+  return NA_TRUE;
+}
+
+
+
+NA_IDEF NABool naTryPushSPSCRing(NASPSCRing* ring, void* element){
+  if(!na_PushSPSCRingElement(ring, element)){
+    return NA_FALSE;
+  }
+  na_WakeRingWaiters(&(ring->pullWaitingCount), &(ring->pullSemaphore));
+  return NA_TRUE;
+}
+
+
+
+NA_IDEF NABool naTryPullSPSCRing(NASPSCRing* ring, void** element){
+  if(!na_PullSPSCRingElement(ring, element)){
+    return NA_FALSE;
+  }
+  na_WakeRingWaiters(&(ring->pushWaitingCount), &(ring->pushSemaphore));
+  return NA_TRUE;
+}
+
+
+
+NA_IDEF NABool naTryPushMPMCRing(NAMPMCRing* ring, void* element){
+  if(!na_PushMPMCRingElement(ring, element)){
+    return NA_FALSE;
+  }
+  na_WakeRingWaiters(&(ring->pullWaitingCount), &(ring->pullSemaphore));
+  return NA_TRUE;
+}
+
+
+
+NA_IDEF NABool naTryPullMPMCRing(NAMPMCRing* ring, void** element){
+  if(!na_PullMPMCRingElement(ring, element)){
+    return NA_FALSE;
+  }
+  na_WakeRingWaiters(&(ring->pushWaitingCount), &(ring->pushSemaphore));
+  return NA_TRUE;
+}
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
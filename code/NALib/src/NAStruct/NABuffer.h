@@ -113,7 +113,19 @@ NA_API NABuffer* naCreateBufferWithSameSource(  NABuffer* srcBuffer);
 
 // Creates a buffer inputting contents from a file. Its origin is always at
 // zero and its range is fixed to the fileSize.
+//
+// Whenever possible, the file is mapped into memory and the parts of the
+// buffer directly reference the mapped memory without copying anything. See
+// naMapFile. If the file can not be mapped, it is read in chunks of
+// NA_BUFFER_PART_BYTESIZE instead.
+//
+// The access argument tells the system how the buffer will be accessed such
+// that it can adjust its read-ahead. The first function uses
+// NA_FILE_ACCESS_DEFAULT.
 NA_API NABuffer* naCreateBufferWithInputPath(const char* filePath);
+NA_API NABuffer* naCreateBufferWithInputPathAndAccess(
+  const char* filePath,
+  NAFileAccess access);
 
 // Creates a buffer accessing already existing const or mutable data. If the
 // data is mutable, you can give a destructor if you want to delete the
@@ -156,6 +168,8 @@ NA_API NABuffer* naCreateBufferWithCustomSource( NABufferSource* source,
 // custom source. The range denotes both the source origin of the first byte
 // of dst as well as the length in bytes the dst buffer holds. The sourceData
 // parameter will be the data pointer given to naSetBufferSourceData.
+// When naPrefetchBufferRange is used, the function is called on another
+// thread and hence must be thread-safe.
 typedef void (*NABufferFiller)(
   void* dst,
   NARangei sourceRange,
@@ -235,19 +249,37 @@ NA_IAPI void   naSetBufferEndianness(NABuffer* buffer, NAInt endianness);
 NA_API NAByte naGetBufferByteAtIndex(NABuffer* buffer, size_t index);
 
 // Searches for the given byte starting at (and including) startOffset, either
-// forward or backwards.
+// forward or backwards. Returns the offset of the byte found or
+// NA_INVALID_MEMORY_INDEX.
 NA_API NAInt naSearchBufferByteOffset(        NABuffer* buffer,
                                                  NAByte byte,
                                                   NAInt startOffset,
                                                  NABool forward);
 
-// Cache:   Allocates all memory of the desired range and fills it according
-//          to the current source.
-// Dismiss: Dismisses the bytes of the given range. Use this if you want to
-//          declare the denoted bytes to be no longer in use by this buffer.
-//          This gives NALib the possibility to deallocate memory.
+// Searches forward for the given pattern of bytes starting at (and including)
+// startOffset. Matches spanning multiple buffer parts are found as well.
+// Returns the offset of the first byte of the match or
+// NA_INVALID_MEMORY_INDEX.
+NA_API NAInt naSearchBufferPattern(           NABuffer* buffer,
+                                             const void* pattern,
+                                                  size_t patternByteSize,
+                                                   NAInt startOffset);
+
+// Cache:    Allocates all memory of the desired range and fills it according
+//           to the current source.
+// Prefetch: Same as Cache but the filling happens on a thread of the default
+//           thread pool and this function returns immediately. Iterators
+//           only wait when they reach bytes which are still being filled.
+//           Use this to read the next bytes of a file while parsing the
+//           current ones. For mapped files, the system is asked to read the
+//           range in the background instead.
+// Dismiss:  Dismisses the bytes of the given range. Use this if you want to
+//           declare the denoted bytes to be no longer in use by this buffer.
+//           This gives NALib the possibility to deallocate memory.
 NA_API void naCacheBufferRange(   NABuffer* buffer,
                                    NARangei range);
+NA_API void naPrefetchBufferRange(NABuffer* buffer,
+                                   NARangei range);
 NA_API void naDismissBufferRange( NABuffer* buffer,
                                    NARangei range);
 
@@ -290,6 +322,14 @@ NA_API void naWriteBufferToData(NABuffer* buffer, void* data);
 NA_API void naAccumulateChecksumBuffer( NAChecksum* checksum,
                                           NABuffer* buffer);
 
+// Coalesces adjacent parts with memory which are smaller than minPartSize into
+// new parts with one contiguous memory block of at least minPartSize bytes.
+// The bytes get copied, hence they are no longer shared with other buffers.
+// Sparse parts are kept. There must be no iterators on the buffer.
+// If NA_BUFFER_COMPACT_PART_COUNT is not 0, this happens automatically when
+// the last iterator gets cleared and the buffer has more parts than that.
+NA_API void naCompactBuffer(NABuffer* buffer, size_t minPartSize);
+
 
 
 // ////////////////////////////////
@@ -512,10 +552,47 @@ NA_API void naWriteBufferLineWithArguments(   NABufferIterator* iter,
 NA_API NABool naReadBufferBit(NABufferIterator* iter);
 NA_API uint32 naReadBufferBits32(NABufferIterator* iter, uint8 count);
 
+// For decoding bit streams like DEFLATE, the iterator reads ahead the bits
+// following the current bit into an accumulator of 64 bits. Bits are
+// counted starting with the lowest bit of a byte.
+//
+// Peek:    Returns the next count bits without moving the iterator. If the
+//          accumulator holds less bits, it is refilled first. Bits beyond
+//          the end of the buffer are returned as 0.
+// Consume: Moves the iterator by count bits. The bits must have been peeked
+//          or refilled before.
+// Refill:  Fills the accumulator with the following bytes. Afterwards, it
+//          holds at least 57 bits except at the end of the buffer. Usually,
+//          8 bytes are loaded at once from the current buffer part.
+//
+// Count must not exceed 32, or 24 on systems without a native 64 bit integer
+// where the accumulator has only 32 bits.
+//
+// The accumulator is discarded whenever the iterator is located or used to
+// read or write bytes. It does not notice when other iterators change the
+// bytes it holds.
+NA_IAPI uint32 naPeekBufferBits   (NABufferIterator* iter, uint8 count);
+NA_IAPI void   naConsumeBufferBits(NABufferIterator* iter, uint8 count);
+NA_API  void   naRefillBufferBits (NABufferIterator* iter);
+
 // Aligns the bit counter to the next byte boundary. If the bit counter is
 // already at a boundary, nothing happends.
 NA_API void naPadBufferBits (NABufferIterator* iter);
 
+// Writes the lowest count bits of value, lowest bit first, which is the bit
+// order of DEFLATE. The bits are collected in an accumulator of 64 bits and
+// written as whole bytes when it is full. Count must not exceed 32, or 24
+// on systems without a native 64 bit integer. All bits of value above count
+// must be zero.
+//
+// The iterator must be at a byte boundary when starting to write bits. The
+// bits only reach the buffer when calling naFlushBufferBits which fills up
+// the last byte with zero bits. Afterwards, the iterator is at the byte
+// following the bits. Flush before using the iterator otherwise and before
+// clearing it.
+NA_IAPI void naWriteBufferBits(NABufferIterator* iter, uint32 value, uint8 count);
+NA_API  void naFlushBufferBits(NABufferIterator* iter);
+
 
 
 // ////////////////////////////////
@@ -0,0 +1,137 @@
+
+#ifndef NA_RING_INCLUDED
+#define NA_RING_INCLUDED
+#ifdef __cplusplus
+  extern "C"{
+#endif
+
+
+// Rings are circular buffers of void pointers which are made for handing
+// over elements from one thread to another without a mutex: First in First
+// out (FIFO). Unlike NACircularBuffer, they can be used by multiple threads
+// at the same time.
+//
+// NASPSCRing: Single producer, single consumer. Exactly one thread pushes and
+//             exactly one (other) thread pulls. This is the fastest variant.
+// NAMPMCRing: Multiple producers, multiple consumers. Any number of threads
+//             may push and pull at the same time.
+//
+// Both rings have a fixed capacity which is chosen upon initialization and
+// rounded up to the next power of two. Pushing to a full ring or pulling from
+// an empty ring fails with the Try functions and returns the number of
+// elements moved with the Batch functions. The functions without Try wait
+// until they succeed, sleeping if necessary.
+//
+// The head and tail of a ring are kept on separate cache lines such that the
+// producing and consuming threads do not slow down each other. See
+// NA_CACHE_LINE_BYTESIZE in NAConfiguration.h.
+//
+// Implementation note: The MPMC ring stores a sequence number with every
+// element (Dmitry Vyukov's bounded queue). No thread ever waits for another
+// one except in the functions which wait by definition. A consequence is
+// that a pull may fail while a push of another thread is still in progress.
+
+
+
+#include "../NABase.h"
+
+
+
+// The full type definitions are in the file "NARingII.h"
+typedef struct NASPSCRing NASPSCRing;
+typedef struct NAMPMCRing NAMPMCRing;
+
+
+
+// Initializes a ring with space for at least count elements. The capacity
+// is at most 2^30 elements.
+NA_API NASPSCRing* naInitSPSCRing(NASPSCRing* ring, size_t count);
+NA_API NAMPMCRing* naInitMPMCRing(NAMPMCRing* ring, size_t count);
+
+// Clears the ring. Does not delete the elements still stored! No thread must
+// wait for the ring when clearing it.
+NA_API void naClearSPSCRing(NASPSCRing* ring);
+NA_API void naClearMPMCRing(NAMPMCRing* ring);
+
+// Returns the number of elements the ring can hold.
+NA_IAPI size_t naGetSPSCRingCapacity(const NASPSCRing* ring);
+NA_IAPI size_t naGetMPMCRingCapacity(const NAMPMCRing* ring);
+
+// Pushes one element at the tail of the ring. Returns NA_FALSE and does
+// nothing if the ring is full.
+NA_IAPI NABool naTryPushSPSCRing(NASPSCRing* ring, void* element);
+NA_IAPI NABool naTryPushMPMCRing(NAMPMCRing* ring, void* element);
+
+// Pulls one element from the head of the ring and stores it in element.
+// Returns NA_FALSE and does nothing if the ring is empty.
+NA_IAPI NABool naTryPullSPSCRing(NASPSCRing* ring, void** element);
+NA_IAPI NABool naTryPullMPMCRing(NAMPMCRing* ring, void** element);
+
+// Pushes up to count elements from the given array and returns how many of
+// them were pushed, which is less than count if the ring gets full.
+NA_API size_t naPushSPSCRingBatch(
+  NASPSCRing* ring,
+  void* const* elements,
+  size_t count);
+NA_API size_t naPushMPMCRingBatch(
+  NAMPMCRing* ring,
+  void* const* elements,
+  size_t count);
+
+// Pulls up to maxCount elements into the given array and returns how many of
+// them were pulled, which is less than maxCount if the ring gets empty.
+NA_API size_t naPullSPSCRingBatch(
+  NASPSCRing* ring,
+  void** elements,
+  size_t maxCount);
+NA_API size_t naPullMPMCRingBatch(
+  NAMPMCRing* ring,
+  void** elements,
+  size_t maxCount);
+
+// Pushes one element, waiting while the ring is full.
+NA_API void naPushSPSCRing(NASPSCRing* ring, void* element);
+NA_API void naPushMPMCRing(NAMPMCRing* ring, void* element);
+
+// Pulls one element, waiting while the ring is empty.
+NA_API void* naPullSPSCRing(NASPSCRing* ring);
+NA_API void* naPullMPMCRing(NAMPMCRing* ring);
+
+
+
+// Inline implementations are in a separate file:
+#include "Core/NARing/NARingII.h"
+
+
+
+#ifdef __cplusplus
+  } // extern "C"
+#endif
+#endif // NA_RING_INCLUDED
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
@@ -7,7 +7,9 @@
 // Include this file to automatically include all APIs from the NAUtility
 // folder. You are free to include the files individually though.
 
+#include "NAUtility/NAAtomic.h"
 #include "NAUtility/NABinaryData.h"
+#include "NAUtility/NAClock.h"
 #include "NAUtility/NADateTime.h"
 #include "NAUtility/NAFile.h"
 #include "NAUtility/NAJSON.h"
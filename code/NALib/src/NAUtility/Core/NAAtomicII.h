@@ -0,0 +1,444 @@
+// This file contains inline implementations of the file NAAtomic.h
+// Do not include this file directly! It will automatically be included when
+// including "NAAtomic.h"
+
+
+
+// Exactly one of the following implementations is chosen. GCC and Clang
+// builtins are preferred over C11 as they work in C++ and with C99 as well.
+#if defined _MSC_VER && !defined __clang__
+  #define NA_ATOMIC_WINDOWS 1
+  #define NA_ATOMIC_GCC 0
+  #define NA_ATOMIC_C11 0
+  #include <windows.h>
+#elif defined __GNUC__ || defined __clang__
+  #define NA_ATOMIC_WINDOWS 0
+  #define NA_ATOMIC_GCC 1
+  #define NA_ATOMIC_C11 0
+#elif defined NA_C11 && !defined __STDC_NO_ATOMICS__
+  #define NA_ATOMIC_WINDOWS 0
+  #define NA_ATOMIC_GCC 0
+  #define NA_ATOMIC_C11 1
+  #include <stdatomic.h>
+#else
+  #error "NAAtomic is not available for this compiler."
+#endif
+
+
+
+#if NA_ATOMIC_WINDOWS
+
+  struct NAAtomic32{  volatile LONG value;};
+  #if defined NA_TYPE_INT64
+    struct NAAtomic64{volatile LONG64 value;};
+  #endif
+  struct NAAtomicPtr{ void* volatile value;};
+
+#elif NA_ATOMIC_GCC
+
+  struct NAAtomic32{  int32 value;};
+  #if defined NA_TYPE_INT64
+    struct NAAtomic64{int64 value;};
+  #endif
+  struct NAAtomicPtr{ void* value;};
+
+#else
+
+  struct NAAtomic32{  _Atomic(int32) value;};
+  #if defined NA_TYPE_INT64
+    struct NAAtomic64{_Atomic(int64) value;};
+  #endif
+  struct NAAtomicPtr{ _Atomic(void*) value;};
+
+#endif
+
+
+
+#if NA_DEBUG
+  NA_HIDEF void na_CheckAtomicLoadOrder(NAMemoryOrder order){
+    if(order == NA_MEMORY_ORDER_RELEASE || order == NA_MEMORY_ORDER_ACQ_REL)
+      naError("A load can not have release semantics.");
+  }
+  NA_HIDEF void na_CheckAtomicStoreOrder(NAMemoryOrder order){
+    if(order == NA_MEMORY_ORDER_ACQUIRE || order == NA_MEMORY_ORDER_ACQ_REL)
+      naError("A store can not have acquire semantics.");
+  }
+#endif
+
+
+
+// The memory orders of the implementation. When the order is a constant,
+// the switch is resolved by the compiler.
+#if NA_ATOMIC_GCC
+
+  NA_HIDEF int na_GetAtomicOrder(NAMemoryOrder order){
+    switch(order){
+    case NA_MEMORY_ORDER_RELAXED: return __ATOMIC_RELAXED;
+    case NA_MEMORY_ORDER_ACQUIRE: return __ATOMIC_ACQUIRE;
+    case NA_MEMORY_ORDER_RELEASE: return __ATOMIC_RELEASE;
+    case NA_MEMORY_ORDER_ACQ_REL: return __ATOMIC_ACQ_REL;
+    default:                      return __ATOMIC_SEQ_CST;
+    }
+  }
+
+  // A failing compare-exchange only loads and hence can not release.
+  NA_HIDEF int na_GetAtomicFailureOrder(NAMemoryOrder order){
+    switch(order){
+    case NA_MEMORY_ORDER_RELAXED: return __ATOMIC_RELAXED;
+    case NA_MEMORY_ORDER_ACQUIRE: return __ATOMIC_ACQUIRE;
+    case NA_MEMORY_ORDER_RELEASE: return __ATOMIC_RELAXED;
+    case NA_MEMORY_ORDER_ACQ_REL: return __ATOMIC_ACQUIRE;
+    default:                      return __ATOMIC_SEQ_CST;
+    }
+  }
+
+#elif NA_ATOMIC_C11
+
+  NA_HIDEF memory_order na_GetAtomicOrder(NAMemoryOrder order){
+    switch(order){
+    case NA_MEMORY_ORDER_RELAXED: return memory_order_relaxed;
+    case NA_MEMORY_ORDER_ACQUIRE: return memory_order_acquire;
+    case NA_MEMORY_ORDER_RELEASE: return memory_order_release;
+    case NA_MEMORY_ORDER_ACQ_REL: return memory_order_acq_rel;
+    default:                      return memory_order_seq_cst;
+    }
+  }
+
+  NA_HIDEF memory_order na_GetAtomicFailureOrder(NAMemoryOrder order){
+    switch(order){
+    case NA_MEMORY_ORDER_RELAXED: return memory_order_relaxed;
+    case NA_MEMORY_ORDER_ACQUIRE: return memory_order_acquire;
+    case NA_MEMORY_ORDER_RELEASE: return memory_order_relaxed;
+    case NA_MEMORY_ORDER_ACQ_REL: return memory_order_acquire;
+    default:                      return memory_order_seq_cst;
+    }
+  }
+
+#endif
+
+
+
+// ////////////////////////////
+// 32 bits
+// ////////////////////////////
+
+NA_IDEF void naInitAtomic32(NAAtomic32* atomic, int32 value){
+  #if NA_ATOMIC_C11
+    atomic_init(&(atomic->value), value);
+  #else
+    atomic->value = value;
+  #endif
+}
+
+
+
+NA_IDEF int32 naLoadAtomic32(const NAAtomic32* atomic, NAMemoryOrder order){
+  #if NA_DEBUG
+    na_CheckAtomicLoadOrder(order);
+  #endif
+  #if NA_ATOMIC_WINDOWS
+    // A compare-exchange is the only load with a barrier on all processors.
+    if(order == NA_MEMORY_ORDER_RELAXED){return (int32)atomic->value;}
+    return (int32)InterlockedCompareExchange((volatile LONG*)&(atomic->value), 0, 0);
+  #elif NA_ATOMIC_GCC
+    return __atomic_load_n(&(atomic->value), na_GetAtomicOrder(order));
+  #else
+    return atomic_load_explicit(&(((NAAtomic32*)atomic)->value), na_GetAtomicOrder(order));
+  #endif
+}
+
+
+
+NA_IDEF void naStoreAtomic32(NAAtomic32* atomic, int32 value, NAMemoryOrder order){
+  #if NA_DEBUG
+    na_CheckAtomicStoreOrder(order);
+  #endif
+  #if NA_ATOMIC_WINDOWS
+    if(order == NA_MEMORY_ORDER_RELAXED){
+      atomic->value = value;
+    }else{
+      InterlockedExchange(&(atomic->value), value);
+    }
+  #elif NA_ATOMIC_GCC
+    __atomic_store_n(&(atomic->value), value, na_GetAtomicOrder(order));
+  #else
+    atomic_store_explicit(&(atomic->value), value, na_GetAtomicOrder(order));
+  #endif
+}
+
+
+
+NA_IDEF int32 naExchangeAtomic32(NAAtomic32* atomic, int32 value, NAMemoryOrder order){
+  #if NA_ATOMIC_WINDOWS
+    NA_UNUSED(order);
+    return (int32)InterlockedExchange(&(atomic->value), value);
+  #elif NA_ATOMIC_GCC
+    return __atomic_exchange_n(&(atomic->value), value, na_GetAtomicOrder(order));
+  #else
+    return atomic_exchange_explicit(&(atomic->value), value, na_GetAtomicOrder(order));
+  #endif
+}
+
+
+
+NA_IDEF NABool naCompareExchangeAtomic32(NAAtomic32* atomic, int32* expected, int32 desired, NAMemoryOrder order){
+  #if NA_ATOMIC_WINDOWS
+    LONG prevValue = InterlockedCompareExchange(&(atomic->value), desired, *expected);
+    NA_UNUSED(order);
+    if(prevValue == *expected){return NA_TRUE;}
+    *expected = (int32)prevValue;
+    return NA_FALSE;
+  #elif NA_ATOMIC_GCC
+    return __atomic_compare_exchange_n(&(atomic->value), expected, desired, NA_FALSE, na_GetAtomicOrder(order), na_GetAtomicFailureOrder(order));
+  #else
+    return atomic_compare_exchange_strong_explicit(&(atomic->value), expected, desired, na_GetAtomicOrder(order), na_GetAtomicFailureOrder(order));
+  #endif
+}
+
+
+
+NA_IDEF int32 naFetchAddAtomic32(NAAtomic32* atomic, int32 value, NAMemoryOrder order){
+  #if NA_ATOMIC_WINDOWS
+    NA_UNUSED(order);
+    return (int32)InterlockedExchangeAdd(&(atomic->value), value);
+  #elif NA_ATOMIC_GCC
+    return __atomic_fetch_add(&(atomic->value), value, na_GetAtomicOrder(order));
+  #else
+    return atomic_fetch_add_explicit(&(atomic->value), value, na_GetAtomicOrder(order));
+  #endif
+}
+
+
+
+// ////////////////////////////
+// 64 bits
+// ////////////////////////////
+
+#if defined NA_TYPE_INT64
+
+NA_IDEF void naInitAtomic64(NAAtomic64* atomic, int64 value){
+  #if NA_ATOMIC_C11
+    atomic_init(&(atomic->value), value);
+  #else
+    atomic->value = value;
+  #endif
+}
+
+
+
+NA_IDEF int64 naLoadAtomic64(const NAAtomic64* atomic, NAMemoryOrder order){
+  #if NA_DEBUG
+    na_CheckAtomicLoadOrder(order);
+  #endif
+  #if NA_ATOMIC_WINDOWS
+    // On 32 bit systems, even a relaxed load needs a compare-exchange.
+    #if NA_ADDRESS_BITS == 64
+      if(order == NA_MEMORY_ORDER_RELAXED){return (int64)atomic->value;}
+    #endif
+    return (int64)InterlockedCompareExchange64((volatile LONG64*)&(atomic->value), 0, 0);
+  #elif NA_ATOMIC_GCC
+    return __atomic_load_n(&(atomic->value), na_GetAtomicOrder(order));
+  #else
+    return atomic_load_explicit(&(((NAAtomic64*)atomic)->value), na_GetAtomicOrder(order));
+  #endif
+}
+
+
+
+NA_IDEF void naStoreAtomic64(NAAtomic64* atomic, int64 value, NAMemoryOrder order){
+  #if NA_DEBUG
+    na_CheckAtomicStoreOrder(order);
+  #endif
+  #if NA_ATOMIC_WINDOWS
+    #if NA_ADDRESS_BITS == 64
+      if(order == NA_MEMORY_ORDER_RELAXED){
+        atomic->value = value;
+        return;
+      }
+    #endif
+    InterlockedExchange64(&(atomic->value), value);
+  #elif NA_ATOMIC_GCC
+    __atomic_store_n(&(atomic->value), value, na_GetAtomicOrder(order));
+  #else
+    atomic_store_explicit(&(atomic->value), value, na_GetAtomicOrder(order));
+  #endif
+}
+
+
+
+NA_IDEF int64 naExchangeAtomic64(NAAtomic64* atomic, int64 value, NAMemoryOrder order){
+  #if NA_ATOMIC_WINDOWS
+    NA_UNUSED(order);
+    return (int64)InterlockedExchange64(&(atomic->value), value);
+  #elif NA_ATOMIC_GCC
+    return __atomic_exchange_n(&(atomic->value), value, na_GetAtomicOrder(order));
+  #else
+    return atomic_exchange_explicit(&(atomic->value), value, na_GetAtomicOrder(order));
+  #endif
+}
+
+
+
+NA_IDEF NABool naCompareExchangeAtomic64(NAAtomic64* atomic, int64* expected, int64 desired, NAMemoryOrder order){
+  #if NA_ATOMIC_WINDOWS
+    LONG64 prevValue = InterlockedCompareExchange64(&(atomic->value), desired, *expected);
+    NA_UNUSED(order);
+    if(prevValue == *expected){return NA_TRUE;}
+    *expected = (int64)prevValue;
+    return NA_FALSE;
+  #elif NA_ATOMIC_GCC
+    return __atomic_compare_exchange_n(&(atomic->value), expected, desired, NA_FALSE, na_GetAtomicOrder(order), na_GetAtomicFailureOrder(order));
+  #else
+    return atomic_compare_exchange_strong_explicit(&(atomic->value), expected, desired, na_GetAtomicOrder(order), na_GetAtomicFailureOrder(order));
+  #endif
+}
+
+
+
+NA_IDEF int64 naFetchAddAtomic64(NAAtomic64* atomic, int64 value, NAMemoryOrder order){
+  #if NA_ATOMIC_WINDOWS
+    NA_UNUSED(order);
+    return (int64)InterlockedExchangeAdd64(&(atomic->value), value);
+  #elif NA_ATOMIC_GCC
+    return __atomic_fetch_add(&(atomic->value), value, na_GetAtomicOrder(order));
+  #else
+    return atomic_fetch_add_explicit(&(atomic->value), value, na_GetAtomicOrder(order));
+  #endif
+}
+
+#endif // NA_TYPE_INT64
+
+
+
+// ////////////////////////////
+// Pointers
+// ////////////////////////////
+
+NA_IDEF void naInitAtomicPtr(NAAtomicPtr* atomic, void* value){
+  #if NA_ATOMIC_C11
+    atomic_init(&(atomic->value), value);
+  #else
+    atomic->value = value;
+  #endif
+}
+
+
+
+NA_IDEF void* naLoadAtomicPtr(const NAAtomicPtr* atomic, NAMemoryOrder order){
+  #if NA_DEBUG
+    na_CheckAtomicLoadOrder(order);
+  #endif
+  #if NA_ATOMIC_WINDOWS
+    if(order == NA_MEMORY_ORDER_RELAXED){return atomic->value;}
+    return InterlockedCompareExchangePointer((void* volatile*)&(atomic->value), NA_NULL, NA_NULL);
+  #elif NA_ATOMIC_GCC
+    return __atomic_load_n(&(atomic->value), na_GetAtomicOrder(order));
+  #else
+    return atomic_load_explicit(&(((NAAtomicPtr*)atomic)->value), na_GetAtomicOrder(order));
+  #endif
+}
+
+
+
+NA_IDEF void naStoreAtomicPtr(NAAtomicPtr* atomic, void* value, NAMemoryOrder order){
+  #if NA_DEBUG
+    na_CheckAtomicStoreOrder(order);
+  #endif
+  #if NA_ATOMIC_WINDOWS
+    if(order == NA_MEMORY_ORDER_RELAXED){
+      atomic->value = value;
+    }else{
+      InterlockedExchangePointer(&(atomic->value), value);
+    }
+  #elif NA_ATOMIC_GCC
+    __atomic_store_n(&(atomic->value), value, na_GetAtomicOrder(order));
+  #else
+    atomic_store_explicit(&(atomic->value), value, na_GetAtomicOrder(order));
+  #endif
+}
+
+
+
+NA_IDEF void* naExchangeAtomicPtr(NAAtomicPtr* atomic, void* value, NAMemoryOrder order){
+  #if NA_ATOMIC_WINDOWS
+    NA_UNUSED(order);
+    return InterlockedExchangePointer(&(atomic->value), value);
+  #elif NA_ATOMIC_GCC
+    return __atomic_exchange_n(&(atomic->value), value, na_GetAtomicOrder(order));
+  #else
+    return atomic_exchange_explicit(&(atomic->value), value, na_GetAtomicOrder(order));
+  #endif
+}
+
+
+
+NA_IDEF NABool naCompareExchangeAtomicPtr(NAAtomicPtr* atomic, void** expected, void* desired, NAMemoryOrder order){
+  #if NA_ATOMIC_WINDOWS
+    void* prevValue = InterlockedCompareExchangePointer(&(atomic->value), desired, *expected);
+    NA_UNUSED(order);
+    if(prevValue == *expected){return NA_TRUE;}
+    *expected = prevValue;
+    return NA_FALSE;
+  #elif NA_ATOMIC_GCC
+    return __atomic_compare_exchange_n(&(atomic->value), expected, desired, NA_FALSE, na_GetAtomicOrder(order), na_GetAtomicFailureOrder(order));
+  #else
+    return atomic_compare_exchange_strong_explicit(&(atomic->value), expected, desired, na_GetAtomicOrder(order), na_GetAtomicFailureOrder(order));
+  #endif
+}
+
+
+
+// ////////////////////////////
+// Fences
+// ////////////////////////////
+
+NA_IDEF void naFenceAtomic(NAMemoryOrder order){
+  #if NA_ATOMIC_WINDOWS
+    if(order != NA_MEMORY_ORDER_RELAXED){MemoryBarrier();}
+  #elif NA_ATOMIC_GCC
+    __atomic_thread_fence(na_GetAtomicOrder(order));
+  #else
+    atomic_thread_fence(na_GetAtomicOrder(order));
+  #endif
+}
+
+
+
+NA_IDEF void naPauseAtomic(void){
+  #if NA_ATOMIC_WINDOWS
+    YieldProcessor();
+  #elif NA_ATOMIC_GCC && (defined __i386__ || defined __x86_64__)
+    __builtin_ia32_pause();
+  #elif NA_ATOMIC_GCC && (defined __aarch64__ || defined __arm__)
+    __asm__ __volatile__("yield");
+  #else
+    // No hint available. Spinning without one is fine.
+  #endif
+}
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
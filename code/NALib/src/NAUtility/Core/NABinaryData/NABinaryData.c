@@ -1,6 +1,204 @@
 
 #include "../../NABinaryData.h"
 #include "../../NAMemory.h"
+#include <string.h>
+
+#if defined __AVX2__
+  #include <immintrin.h>
+  #define NA_SEARCH_BLOCK_BYTESIZE 32
+#elif defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define NA_SEARCH_BLOCK_BYTESIZE 16
+#elif defined __aarch64__ || defined _M_ARM64
+  #include <arm_neon.h>
+  #define NA_SEARCH_BLOCK_BYTESIZE 16
+#else
+  #define NA_SEARCH_BLOCK_BYTESIZE 0
+#endif
+
+#if defined _MSC_VER && !defined __clang__
+  #include <intrin.h>
+#endif
+
+
+
+// ////////////////////////////
+// Searching bytes
+//
+// The search vector contains the byte searched for in all its lanes. The
+// search mask has one bit set for every byte of the block which is equal to
+// the searched byte, the lowest bit denoting the byte at the lowest address.
+
+#if NA_SEARCH_BLOCK_BYTESIZE
+
+#if defined __AVX2__
+  typedef __m256i NA_SearchVector;
+#elif defined __aarch64__ || defined _M_ARM64
+  typedef uint8x16_t NA_SearchVector;
+#else
+  typedef __m128i NA_SearchVector;
+#endif
+
+
+
+NA_HIDEF NA_SearchVector na_MakeSearchVector(NAByte byte){
+  #if defined __AVX2__
+    return _mm256_set1_epi8((char)byte);
+  #elif defined __aarch64__ || defined _M_ARM64
+    return vdupq_n_u8(byte);
+  #else
+    return _mm_set1_epi8((char)byte);
+  #endif
+}
+
+
+
+NA_HIDEF uint32 na_GetSearchMask(const NAByte* ptr, NA_SearchVector vector){
+  #if defined __AVX2__
+    __m256i block = _mm256_loadu_si256((const __m256i*)ptr);
+    return (uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, vector));
+  #elif defined __aarch64__ || defined _M_ARM64
+    // NEON has no movemask. Each matching lane keeps its bit weight and the
+    // weights of both halves are summed up.
+    static const uint8 weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t bits = vandq_u8(vceqq_u8(vld1q_u8(ptr), vector), vld1q_u8(weights));
+    return (uint32)vaddv_u8(vget_low_u8(bits)) | ((uint32)vaddv_u8(vget_high_u8(bits)) << 8);
+  #else
+    __m128i block = _mm_loadu_si128((const __m128i*)ptr);
+    return (uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(block, vector));
+  #endif
+}
+
+
+
+NA_HIDEF uint32 na_GetLowestSearchMaskIndex(uint32 mask){
+  #if defined _MSC_VER && !defined __clang__
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (uint32)index;
+  #else
+    return (uint32)__builtin_ctz(mask);
+  #endif
+}
+
+
+
+NA_HIDEF uint32 na_GetHighestSearchMaskIndex(uint32 mask){
+  #if defined _MSC_VER && !defined __clang__
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return (uint32)index;
+  #else
+    return 31 - (uint32)__builtin_clz(mask);
+  #endif
+}
+
+#endif // NA_SEARCH_BLOCK_BYTESIZE
+
+
+
+NA_DEF const NAByte* naSearchBytesForByte(const void* ptr, size_t byteSize, NAByte byte){
+  #if NA_SEARCH_BLOCK_BYTESIZE
+    if(byteSize >= NA_SEARCH_BLOCK_BYTESIZE){
+      const NAByte* cur = ptr;
+      const NAByte* end = cur + byteSize;
+      NA_SearchVector vector = na_MakeSearchVector(byte);
+      uint32 mask;
+      while((size_t)(end - cur) >= NA_SEARCH_BLOCK_BYTESIZE){
+        mask = na_GetSearchMask(cur, vector);
+        if(mask){return cur + na_GetLowestSearchMaskIndex(mask);}
+        cur += NA_SEARCH_BLOCK_BYTESIZE;
+      }
+      if(cur < end){
+        // The last block overlaps with the bytes already searched.
+        const NAByte* last = end - NA_SEARCH_BLOCK_BYTESIZE;
+        mask = na_GetSearchMask(last, vector) >> (cur - last);
+        if(mask){return cur + na_GetLowestSearchMaskIndex(mask);}
+      }
+      return NA_NULL;
+    }
+  #endif
+  return memchr(ptr, byte, byteSize);
+}
+
+
+
+NA_DEF const NAByte* naSearchBytesForByteReverse(const void* ptr, size_t byteSize, NAByte byte){
+  const NAByte* start = ptr;
+  const NAByte* cur = start + byteSize;
+  #if NA_SEARCH_BLOCK_BYTESIZE
+    if(byteSize >= NA_SEARCH_BLOCK_BYTESIZE){
+      NA_SearchVector vector = na_MakeSearchVector(byte);
+      uint32 mask;
+      while((size_t)(cur - start) >= NA_SEARCH_BLOCK_BYTESIZE){
+        cur -= NA_SEARCH_BLOCK_BYTESIZE;
+        mask = na_GetSearchMask(cur, vector);
+        if(mask){return cur + na_GetHighestSearchMaskIndex(mask);}
+      }
+      if(cur > start){
+        // The first block overlaps with the bytes already searched.
+        mask = na_GetSearchMask(start, vector) & (((uint32)1 << (cur - start)) - 1);
+        if(mask){return start + na_GetHighestSearchMaskIndex(mask);}
+      }
+      return NA_NULL;
+    }
+  #endif
+  while(cur > start){
+    cur--;
+    if(*cur == byte){return cur;}
+  }
+  return NA_NULL;
+}
+
+
+
+NA_DEF const NAByte* naSearchBytesForPattern(const void* ptr, size_t byteSize, const void* pattern, size_t patternByteSize){
+  const NAByte* bytes = ptr;
+  const NAByte* pat = pattern;
+  size_t candidateCount;
+  size_t i = 0;
+
+  #if NA_DEBUG
+    if(!patternByteSize)
+      naError("patternByteSize is zero.");
+  #endif
+  if(patternByteSize > byteSize){return NA_NULL;}
+  if(patternByteSize <= 1){return naSearchBytesForByte(ptr, byteSize, pat[0]);}
+
+  // The number of positions where the pattern can start.
+  candidateCount = byteSize - patternByteSize + 1;
+
+  #if NA_SEARCH_BLOCK_BYTESIZE
+    if(candidateCount >= NA_SEARCH_BLOCK_BYTESIZE){
+      NA_SearchVector firstVector = na_MakeSearchVector(pat[0]);
+      NA_SearchVector lastVector = na_MakeSearchVector(pat[patternByteSize - 1]);
+      while(i + NA_SEARCH_BLOCK_BYTESIZE <= candidateCount){
+        uint32 mask =
+          na_GetSearchMask(&(bytes[i]), firstVector) &
+          na_GetSearchMask(&(bytes[i + patternByteSize - 1]), lastVector);
+        while(mask){
+          uint32 index = na_GetLowestSearchMaskIndex(mask);
+          if(!memcmp(&(bytes[i + index + 1]), &(pat[1]), patternByteSize - 2)){
+            return &(bytes[i + index]);
+          }
+          mask &= mask - 1;
+        }
+        i += NA_SEARCH_BLOCK_BYTESIZE;
+      }
+    }
+  #endif
+
+  while(i < candidateCount){
+    const NAByte* candidate = memchr(&(bytes[i]), pat[0], candidateCount - i);
+    if(!candidate){break;}
+    if(candidate[patternByteSize - 1] == pat[patternByteSize - 1]
+      && !memcmp(&(candidate[1]), &(pat[1]), patternByteSize - 2)){
+      return candidate;
+    }
+    i = (size_t)(candidate - bytes) + 1;
+  }
+  return NA_NULL;
+}
 
 
 
@@ -0,0 +1,80 @@
+#include "../NAClock.h"
+#include "../NAAtomic.h"
+
+#if defined NA_TYPE_INT64
+
+// The duration in seconds for measuring the frequency of the cycle counter.
+#define NA_CYCLE_COUNT_CALIBRATION_DURATION .01
+
+// 0: Not measured, 1: Being measured by some thread, 2: Measured.
+static NAAtomic32 na_CycleCountFrequencyState = {0};
+static double na_CycleCountFrequency = 1.;
+
+
+
+NA_HDEF double na_MeasureCycleCountFrequency(void){
+  NAClock startClock;
+  NAClock endClock;
+  uint64 startCount;
+  uint64 endCount;
+  double duration;
+
+  // Busy waiting gives a more precise result than sleeping as the thread
+  // can not be descheduled in between.
+  startClock = naMakeClockNow();
+  startCount = naGetCycleCount();
+  do{
+    endClock = naMakeClockNow();
+    endCount = naGetCycleCount();
+    duration = naGetClockDifference(&endClock, &startClock);
+  }while(duration < NA_CYCLE_COUNT_CALIBRATION_DURATION);
+
+  return (double)(endCount - startCount) / duration;
+}
+
+
+
+NA_DEF double naGetCycleCountFrequency(void){
+  if(naLoadAtomic32(&na_CycleCountFrequencyState, NA_MEMORY_ORDER_ACQUIRE) != 2){
+    int32 expected = 0;
+    if(naCompareExchangeAtomic32(&na_CycleCountFrequencyState, &expected, 1, NA_MEMORY_ORDER_ACQUIRE)){
+      na_CycleCountFrequency = na_MeasureCycleCountFrequency();
+      naStoreAtomic32(&na_CycleCountFrequencyState, 2, NA_MEMORY_ORDER_RELEASE);
+    }else{
+      // Another thread is measuring right now.
+      while(naLoadAtomic32(&na_CycleCountFrequencyState, NA_MEMORY_ORDER_ACQUIRE) != 2){
+        naPauseAtomic();
+      }
+    }
+  }
+  return na_CycleCountFrequency;
+}
+
+#endif // NA_TYPE_INT64
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
@@ -0,0 +1,147 @@
+// This file contains inline implementations of the file NAClock.h
+// Do not include this file directly! It will automatically be included when
+// including "NAClock.h"
+
+
+
+#if NA_OS == NA_OS_WINDOWS
+  #include <windows.h>
+  #if defined _MSC_VER && (defined _M_IX86 || defined _M_X64)
+    #include <intrin.h>
+  #endif
+#elif NA_OS == NA_OS_MAC_OS_X
+  #include <mach/mach_time.h>
+#else
+  #include <time.h>
+#endif
+
+// Set to 1 if naGetCycleCount reads a counter of the processor.
+#if defined _MSC_VER && !defined __clang__ && (defined _M_IX86 || defined _M_X64)
+  #define NA_CLOCK_CYCLE_COUNTER 1
+#elif (defined __GNUC__ || defined __clang__) && (defined __i386__ || defined __x86_64__ || defined __aarch64__)
+  #define NA_CLOCK_CYCLE_COUNTER 1
+#else
+  #define NA_CLOCK_CYCLE_COUNTER 0
+#endif
+
+
+
+// The ticks are the raw value of the system counter: Counts of the
+// performance counter on Windows, mach absolute time units on Mac and
+// nanoseconds on all other systems.
+struct NAClock{
+  int64 ticks;
+};
+
+
+
+NA_HIDEF int64 na_ConvertClockTicksToNanoseconds(int64 ticks){
+  #if NA_OS == NA_OS_WINDOWS
+    // Split the conversion to prevent overflows for large tick values.
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return (ticks / frequency.QuadPart) * 1000000000
+      + ((ticks % frequency.QuadPart) * 1000000000) / frequency.QuadPart;
+  #elif NA_OS == NA_OS_MAC_OS_X
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    return ticks * (int64)timebase.numer / (int64)timebase.denom;
+  #else
+    return ticks;
+  #endif
+}
+
+
+
+NA_IDEF NAClock naMakeClockNow(void){
+  NAClock clock;
+  #if NA_OS == NA_OS_WINDOWS
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    clock.ticks = counter.QuadPart;
+  #elif NA_OS == NA_OS_MAC_OS_X
+    clock.ticks = (int64)mach_absolute_time();
+  #else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    clock.ticks = (int64)now.tv_sec * 1000000000 + (int64)now.tv_nsec;
+  #endif
+  return clock;
+}
+
+
+
+NA_IDEF double naGetClockDifference(const NAClock* end, const NAClock* start){
+  return (double)naGetClockDifferenceNanoseconds(end, start) * 1e-9;
+}
+
+
+
+NA_IDEF int64 naGetClockDifferenceNanoseconds(const NAClock* end, const NAClock* start){
+  return na_ConvertClockTicksToNanoseconds(end->ticks - start->ticks);
+}
+
+
+
+NA_IDEF double naGetClockElapsed(const NAClock* start){
+  NAClock now = naMakeClockNow();
+  return naGetClockDifference(&now, start);
+}
+
+
+
+NA_IDEF int64 naGetClockNanoseconds(const NAClock* clock){
+  return na_ConvertClockTicksToNanoseconds(clock->ticks);
+}
+
+
+
+NA_IDEF uint64 naGetCycleCount(void){
+  #if NA_CLOCK_CYCLE_COUNTER
+    #if defined _MSC_VER && !defined __clang__
+      return (uint64)__rdtsc();
+    #elif defined __aarch64__
+      uint64 count;
+      __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(count));
+      return count;
+    #else
+      return (uint64)__builtin_ia32_rdtsc();
+    #endif
+  #else
+    NAClock now = naMakeClockNow();
+    return (uint64)naGetClockNanoseconds(&now);
+  #endif
+}
+
+
+
+NA_IDEF double naGetCycleCountSeconds(uint64 cycleCount){
+  return (double)cycleCount / naGetCycleCountFrequency();
+}
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
@@ -2,6 +2,19 @@
 #include "../NAFile.h"
 #include "../NAString.h"
 
+#if NA_OS == NA_OS_MAC_OS_X
+  #include <sys/mman.h>
+  #include <sys/uio.h>
+  #include <errno.h>
+#endif
+
+// The number of chunks naWriteFileBytesGathered hands to writev at once. This
+// is well below IOV_MAX of all systems.
+#define NA_FILE_GATHER_COUNT 64
+
+// The size of the temporary buffer naWriteFileBytesGathered collects small
+// chunks in on systems without writev.
+#define NA_FILE_GATHER_BYTESIZE 65536
 
 
 
@@ -23,7 +36,7 @@ NA_DEF NABool naIsDir(const char* path){
     NABool retValue;
     sysstring = naAllocSystemStringWithUTF8String(path);
     retValue = (GetFileAttributes(sysstring)  & FILE_ATTRIBUTE_DIRECTORY) ? NA_TRUE : NA_FALSE;
-    free(sysstring);
+    naFree(sysstring);
     return retValue;
   #elif NA_OS == NA_OS_MAC_OS_X
     struct stat stat_struct;
@@ -39,7 +52,7 @@ NA_DEF NABool naIsHidden(const char* path){
     NABool retValue;
     sysstring = naAllocSystemStringWithUTF8String(path);
     retValue = (GetFileAttributes(sysstring) & FILE_ATTRIBUTE_HIDDEN) ? NA_TRUE : NA_FALSE;
-    free(sysstring);
+    naFree(sysstring);
     return retValue;
   #elif NA_OS == NA_OS_MAC_OS_X
     return (path[0] == '.');
@@ -58,6 +71,235 @@ NA_HDEF void na_DeallocFile(NAFile* file){
 
 
 
+#if NA_OS == NA_OS_WINDOWS
+  // Writes all byteSize bytes, calling naWrite again after short writes.
+  // Stops when naWrite reports an error and returns the bytes written.
+  NA_HDEF NAFileSize na_WriteFileBytesCompletely(NAFile* file, const void* ptr, NAFileSize byteSize){
+    NAFileSize totalCount = 0;
+    while(totalCount < byteSize){
+      NAFileSize writeCount = naWrite(file->desc, (const NAByte*)ptr + totalCount, byteSize - totalCount);
+      if(writeCount <= 0){break;}
+      totalCount += writeCount;
+    }
+    return totalCount;
+  }
+#endif
+
+
+
+NA_DEF NAFileSize naWriteFileBytesGathered(NAFile* file, const void* const* ptrs, const size_t* byteSizes, size_t count){
+  NAFileSize totalCount = 0;
+  #if NA_OS == NA_OS_WINDOWS
+    NAByte* gatherBuf;
+    size_t gatherByteSize = 0;
+    NABool failed = NA_FALSE;
+    NAFileSize writeCount;
+    size_t i;
+  #elif NA_OS == NA_OS_MAC_OS_X
+    struct iovec vecs[NA_FILE_GATHER_COUNT];
+    size_t chunkIndex = 0;
+    size_t chunkOffset = 0;  // Bytes of the current chunk already written.
+  #endif
+
+  #if NA_DEBUG
+    if(!naIsFileOpen(file))
+      naError("File is not open.");
+    if(count && (!ptrs || !byteSizes))
+      naCrash("ptrs or byteSizes is Null-Pointer");
+  #endif
+
+  #if NA_OS == NA_OS_WINDOWS
+    gatherBuf = naMalloc(NA_FILE_GATHER_BYTESIZE);
+    // Stop at the first failed or short write such that the file never gets
+    // a gap in the middle.
+    for(i = 0; i < count && !failed; i++){
+      if(gatherByteSize + byteSizes[i] > NA_FILE_GATHER_BYTESIZE && gatherByteSize){
+        writeCount = na_WriteFileBytesCompletely(file, gatherBuf, (NAFileSize)gatherByteSize);
+        totalCount += writeCount;
+        failed = (writeCount < (NAFileSize)gatherByteSize);
+        gatherByteSize = 0;
+        if(failed){break;}
+      }
+      if(byteSizes[i] >= NA_FILE_GATHER_BYTESIZE){
+        writeCount = na_WriteFileBytesCompletely(file, ptrs[i], (NAFileSize)byteSizes[i]);
+        totalCount += writeCount;
+        failed = (writeCount < (NAFileSize)byteSizes[i]);
+      }else if(byteSizes[i]){
+        naCopyn(&(gatherBuf[gatherByteSize]), ptrs[i], byteSizes[i]);
+        gatherByteSize += byteSizes[i];
+      }
+    }
+    if(gatherByteSize && !failed){
+      totalCount += na_WriteFileBytesCompletely(file, gatherBuf, (NAFileSize)gatherByteSize);
+    }
+    naFree(gatherBuf);
+
+  #elif NA_OS == NA_OS_MAC_OS_X
+    while(chunkIndex < count){
+      int vecCount = 0;
+      size_t i = chunkIndex;
+      ssize_t writeCount;
+      while(i < count && vecCount < NA_FILE_GATHER_COUNT){
+        size_t offset = (i == chunkIndex) ? chunkOffset : 0;
+        if(byteSizes[i] > offset){
+          vecs[vecCount].iov_base = (NAByte*)ptrs[i] + offset;
+          vecs[vecCount].iov_len = byteSizes[i] - offset;
+          vecCount++;
+        }
+        i++;
+      }
+      if(!vecCount){break;}
+
+      writeCount = writev(file->desc, vecs, vecCount);
+      if(writeCount < 0 && errno == EINTR){continue;}
+      if(writeCount <= 0){break;}
+      totalCount += (NAFileSize)writeCount;
+
+      // The system may have written less than requested. Skip all chunks
+      // written completely and remember how far the next one got.
+      while(writeCount > 0){
+        size_t remaining = byteSizes[chunkIndex] - chunkOffset;
+        if((size_t)writeCount >= remaining){
+          writeCount -= (ssize_t)remaining;
+          chunkIndex++;
+          chunkOffset = 0;
+        }else{
+          chunkOffset += (size_t)writeCount;
+          writeCount = 0;
+        }
+      }
+      // Skip empty chunks which were not part of the vectors.
+      while(chunkIndex < count && byteSizes[chunkIndex] == chunkOffset){
+        chunkIndex++;
+        chunkOffset = 0;
+      }
+    }
+  #else
+    NA_UNUSED(file);
+    NA_UNUSED(ptrs);
+    NA_UNUSED(byteSizes);
+    NA_UNUSED(count);
+  #endif
+
+  return totalCount;
+}
+
+
+
+NA_DEF void* naMapFile(const char* filePath, size_t* byteSize, NAFileAccess access){
+  void* data = NA_NULL;
+  #if NA_OS == NA_OS_WINDOWS
+    TCHAR* sysstring;
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+    LARGE_INTEGER fileSize;
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+  #elif NA_OS == NA_OS_MAC_OS_X
+    struct stat stat_struct;
+    int desc;
+  #endif
+
+  #if NA_DEBUG
+    if(!byteSize)
+      naCrash("byteSize is Null");
+  #endif
+  *byteSize = 0;
+
+  #if NA_OS == NA_OS_WINDOWS
+    if(access == NA_FILE_ACCESS_SEQUENTIAL){flags |= FILE_FLAG_SEQUENTIAL_SCAN;}
+    if(access == NA_FILE_ACCESS_RANDOM){flags |= FILE_FLAG_RANDOM_ACCESS;}
+
+    sysstring = naAllocSystemStringWithUTF8String(filePath);
+    fileHandle = CreateFile(sysstring, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NA_NULL, OPEN_EXISTING, flags, NA_NULL);
+    naFree(sysstring);
+    if(fileHandle == INVALID_HANDLE_VALUE){return NA_NULL;}
+
+    if(!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0 || (uint64)fileSize.QuadPart > (uint64)NA_MAX_s){
+      CloseHandle(fileHandle);
+      return NA_NULL;
+    }
+
+    // PAGE_WRITECOPY together with FILE_MAP_COPY makes the view copy-on-write.
+    // The view keeps the mapping and the file open on its own.
+    mappingHandle = CreateFileMapping(fileHandle, NA_NULL, PAGE_WRITECOPY, 0, 0, NA_NULL);
+    CloseHandle(fileHandle);
+    if(!mappingHandle){return NA_NULL;}
+    data = MapViewOfFile(mappingHandle, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(mappingHandle);
+    if(!data){return NA_NULL;}
+    *byteSize = (size_t)fileSize.QuadPart;
+
+  #elif NA_OS == NA_OS_MAC_OS_X
+    desc = naOpen(filePath, NA_FILE_OPEN_FLAGS_READ, NA_FILEMODE_DEFAULT);
+    if(desc < 0){return NA_NULL;}
+
+    if(fstat(desc, &stat_struct) || !S_ISREG(stat_struct.st_mode) || stat_struct.st_size == 0 || (uint64)stat_struct.st_size > (uint64)NA_MAX_s){
+      naClose(desc);
+      return NA_NULL;
+    }
+
+    // MAP_PRIVATE together with PROT_WRITE makes the mapping copy-on-write.
+    // The mapping keeps the file open on its own.
+    data = mmap(NA_NULL, (size_t)stat_struct.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, desc, 0);
+    naClose(desc);
+    if(data == MAP_FAILED){return NA_NULL;}
+    *byteSize = (size_t)stat_struct.st_size;
+
+    // The advice is just a hint, hence failures are ignored.
+    if(access == NA_FILE_ACCESS_SEQUENTIAL){
+      madvise(data, *byteSize, MADV_SEQUENTIAL);
+    }else if(access == NA_FILE_ACCESS_RANDOM){
+      madvise(data, *byteSize, MADV_RANDOM);
+    }
+  #else
+    NA_UNUSED(filePath);
+    NA_UNUSED(access);
+  #endif
+
+  return data;
+}
+
+
+
+NA_DEF void naPrefetchFileMapping(void* data, size_t byteSize){
+  // The system expects page aligned addresses.
+  NAByte* start = (NAByte*)((size_t)data & naGetSystemMemoryPagesizeMask());
+  #if NA_OS == NA_OS_WINDOWS && _WIN32_WINNT >= 0x0602 // Windows 8
+    WIN32_MEMORY_RANGE_ENTRY entry;
+  #endif
+  byteSize += (size_t)((NAByte*)data - start);
+  #if NA_OS == NA_OS_WINDOWS
+    #if _WIN32_WINNT >= 0x0602 // Windows 8
+      entry.VirtualAddress = start;
+      entry.NumberOfBytes = byteSize;
+      PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+    #else
+      NA_UNUSED(start);
+    #endif
+  #elif NA_OS == NA_OS_MAC_OS_X
+    madvise(start, byteSize, MADV_WILLNEED);
+  #else
+    NA_UNUSED(start);
+    NA_UNUSED(byteSize);
+  #endif
+}
+
+
+
+NA_DEF void naUnmapFile(void* data, size_t byteSize){
+  #if NA_OS == NA_OS_WINDOWS
+    NA_UNUSED(byteSize);
+    UnmapViewOfFile(data);
+  #elif NA_OS == NA_OS_MAC_OS_X
+    munmap(data, byteSize);
+  #else
+    NA_UNUSED(data);
+    NA_UNUSED(byteSize);
+  #endif
+}
+
+
+
 // This is free and unencumbered software released into the public domain.
 
 // Anyone is free to copy, modify, publish, use, compile, sell, or
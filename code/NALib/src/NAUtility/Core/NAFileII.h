@@ -75,6 +75,31 @@ NA_IDEF NAFileSize naRead(int fd, void* buf, NAFileSize byteSize){
 }
 
 
+NA_IDEF NAFileSize naPread(int fd, void* buf, NAFileSize byteSize, NAFileSize byteOffset){
+  #if NA_OS == NA_OS_WINDOWS
+    // Reading with an offset in the OVERLAPPED struct also works for files
+    // opened synchronously.
+    OVERLAPPED overlapped;
+    DWORD readCount = 0;
+    naZeron(&overlapped, sizeof(OVERLAPPED));
+    overlapped.Offset = (DWORD)((uint64)byteOffset & 0xffffffff);
+    overlapped.OffsetHigh = (DWORD)((uint64)byteOffset >> 32);
+    if(!ReadFile((HANDLE)_get_osfhandle(fd), buf, (DWORD)byteSize, &readCount, &overlapped)){
+      return (GetLastError() == ERROR_HANDLE_EOF) ? 0 : -1;
+    }
+    return (NAFileSize)readCount;
+  #elif NA_OS == NA_OS_MAC_OS_X
+    return (NAFileSize)pread(fd, buf, (size_t)byteSize, byteOffset);
+  #else
+    NA_UNUSED(fd);
+    NA_UNUSED(buf);
+    NA_UNUSED(byteSize);
+    NA_UNUSED(byteOffset);
+    return 0;
+  #endif
+}
+
+
 NA_IDEF NAFileSize naWrite(int fd, const void* buf, NAFileSize byteSize){
   #if NA_OS == NA_OS_WINDOWS
     return (NAFileSize)_write(fd, buf, (unsigned int)byteSize);
@@ -321,6 +346,29 @@ NA_IDEF NAFileSize naReadFileBytes(NAFile* file, void* buf, NAFileSize byteSize)
 }
 
 
+NA_IDEF NAFileSize naReadFileBytesAt(NAFile* file, void* buf, NAFileSize byteSize, NAFileSize byteOffset){
+  NAFileSize totalCount = 0;
+  #if NA_DEBUG
+    if(!naIsFileOpen(file))
+      naError("File is not open.");
+    if(byteSize < 0)
+      naError("Negative count.");
+    if(byteOffset < 0)
+      naError("Negative offset.");
+  #endif
+  while(totalCount < byteSize){
+    NAFileSize readCount = naPread(
+      file->desc,
+      &(((NAByte*)buf)[totalCount]),
+      byteSize - totalCount,
+      byteOffset + totalCount);
+    if(readCount <= 0){break;}
+    totalCount += readCount;
+  }
+  return totalCount;
+}
+
+
 NA_IDEF NAFileSize naWriteFileBytes(NAFile* file, const void* ptr, NAFileSize byteSize){
   #if NA_DEBUG
     if(!naIsFileOpen(file))
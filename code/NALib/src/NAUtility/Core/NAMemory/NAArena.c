@@ -0,0 +1,135 @@
+#include "../../NAMemory.h"
+
+
+
+NA_DEF NAArena* naInitArena(NAArena* arena, size_t blockByteSize){
+  #if NA_DEBUG
+    if(!arena)
+      naCrash("arena is Null");
+    if(blockByteSize <= sizeof(NA_ArenaBlock))
+      naError("blockByteSize is too small.");
+  #endif
+  arena->block = NA_NULL;
+  arena->cur = NA_NULL;
+  arena->end = NA_NULL;
+  arena->spareBlock = NA_NULL;
+  arena->blockByteSize = blockByteSize;
+  arena->byteCount = 0;
+  arena->maxByteCount = 0;
+  return arena;
+}
+
+
+
+NA_DEF void naClearArena(NAArena* arena){
+  #if NA_DEBUG
+    if(!arena)
+      naCrash("arena is Null");
+  #endif
+  naResetArena(arena);
+  naFree(arena->spareBlock);
+  arena->spareBlock = NA_NULL;
+}
+
+
+
+// Makes a new block with at least byteSize free bytes the current block.
+// The remaining bytes of the previous block are left unused.
+NA_HDEF void na_AddArenaBlock(NAArena* arena, size_t byteSize){
+  NA_ArenaBlock* block;
+  size_t headerByteSize = (sizeof(NA_ArenaBlock) + (NA_ARENA_ALIGN - NA_ONE_s)) & ~(size_t)(NA_ARENA_ALIGN - NA_ONE_s);
+
+  if(arena->spareBlock && (size_t)(arena->spareBlock->end - ((NAByte*)arena->spareBlock + headerByteSize)) >= byteSize){
+    block = arena->spareBlock;
+    arena->spareBlock = NA_NULL;
+  }else{
+    size_t blockByteSize = headerByteSize + byteSize;
+    if(blockByteSize < arena->blockByteSize){blockByteSize = arena->blockByteSize;}
+    block = naMalloc(blockByteSize);
+    block->end = (NAByte*)block + blockByteSize;
+  }
+
+  block->prev = arena->block;
+  arena->block = block;
+  arena->cur = (NAByte*)block + headerByteSize;
+  arena->end = block->end;
+}
+
+
+
+// Either keeps the block as the spare block or frees it. Only blocks of the
+// default size are kept, large blocks are freed immediately.
+NA_HIDEF void na_RemoveArenaBlock(NAArena* arena, NA_ArenaBlock* block){
+  if(!arena->spareBlock && (size_t)(block->end - (NAByte*)block) == arena->blockByteSize){
+    arena->spareBlock = block;
+  }else{
+    naFree(block);
+  }
+}
+
+
+
+NA_DEF void naPopArenaMark(NAArena* arena, NAArenaMark mark){
+  #if NA_DEBUG
+    if(!arena)
+      naCrash("arena is Null");
+    if(mark.byteCount > arena->byteCount)
+      naError("Mark seems to have been popped already.");
+  #endif
+
+  if(arena->byteCount > arena->maxByteCount){
+    arena->maxByteCount = arena->byteCount;
+  }
+
+  while(arena->block != mark.block){
+    NA_ArenaBlock* block = arena->block;
+    #if NA_DEBUG
+      if(!block)
+        naCrash("Mark does not belong to this arena.");
+    #endif
+    arena->block = block->prev;
+    na_RemoveArenaBlock(arena, block);
+  }
+
+  arena->cur = mark.cur;
+  arena->end = mark.block ? mark.block->end : NA_NULL;
+  arena->byteCount = mark.byteCount;
+}
+
+
+
+NA_DEF void naResetArena(NAArena* arena){
+  NAArenaMark emptyMark = {NA_NULL, NA_NULL, 0};
+  #if NA_DEBUG
+    if(!arena)
+      naCrash("arena is Null");
+  #endif
+  naPopArenaMark(arena, emptyMark);
+}
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
@@ -0,0 +1,120 @@
+// This file contains inline implementations of the file NAMemory.h
+// Do not include this file directly! It will automatically be included when
+// including "NAMemory.h"
+
+
+
+
+// The memory of an arena is organized in blocks which form a list going
+// backwards. Each block starts with this header, the memory handed out
+// follows right after it.
+typedef struct NA_ArenaBlock NA_ArenaBlock;
+struct NA_ArenaBlock{
+  NA_ArenaBlock* prev;
+  NAByte* end;
+};
+
+struct NAArena{
+  NA_ArenaBlock* block;       // The current block, Null if there is none.
+  NAByte* cur;                // The first free byte in the current block.
+  NAByte* end;                // The end of the current block.
+  NA_ArenaBlock* spareBlock;  // An empty block kept for reuse.
+  size_t blockByteSize;
+  size_t byteCount;
+  size_t maxByteCount;
+};
+
+struct NAArenaMark{
+  NA_ArenaBlock* block;
+  NAByte* cur;
+  size_t byteCount;
+};
+
+// The alignment of all pointers returned by an arena. Same as malloc.
+#define NA_ARENA_ALIGN (2 * NA_ADDRESS_BYTES)
+
+NA_HAPI void na_AddArenaBlock(NAArena* arena, size_t byteSize);
+
+
+
+NA_IDEF void* naMallocArena(NAArena* arena, size_t byteSize){
+  size_t alignedByteSize;
+  void* ptr;
+  #if NA_DEBUG
+    if(!arena)
+      naCrash("arena is Null");
+    if(byteSize == NA_ZERO)
+      naCrash("size is zero.");
+  #endif
+
+  alignedByteSize = (byteSize + (NA_ARENA_ALIGN - NA_ONE_s)) & ~(size_t)(NA_ARENA_ALIGN - NA_ONE_s);
+  if((size_t)(arena->end - arena->cur) < alignedByteSize){
+    na_AddArenaBlock(arena, alignedByteSize);
+  }
+
+  ptr = arena->cur;
+  arena->cur += alignedByteSize;
+  arena->byteCount += alignedByteSize;
+  return ptr;
+}
+
+
+
+NA_IDEF NAArenaMark naPushArenaMark(const NAArena* arena){
+  NAArenaMark mark;
+  #if NA_DEBUG
+    if(!arena)
+      naCrash("arena is Null");
+  #endif
+  mark.block = arena->block;
+  mark.cur = arena->cur;
+  mark.byteCount = arena->byteCount;
+  return mark;
+}
+
+
+
+NA_IDEF size_t naGetArenaByteSize(const NAArena* arena){
+  #if NA_DEBUG
+    if(!arena)
+      naCrash("arena is Null");
+  #endif
+  return arena->byteCount;
+}
+
+
+
+NA_IDEF size_t naGetArenaMaxByteSize(const NAArena* arena){
+  #if NA_DEBUG
+    if(!arena)
+      naCrash("arena is Null");
+  #endif
+  return (arena->byteCount > arena->maxByteCount) ? arena->byteCount : arena->maxByteCount;
+}
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
@@ -0,0 +1,465 @@
+#include "../../NAMemory.h"
+#include "../../NAAtomic.h"
+
+#if NA_MALLOC_SIZE_CLASSES && NA_OS != NA_OS_WINDOWS
+  #include <sys/mman.h>
+#endif
+
+// //////////////////////////////////////
+// Implementation notes about the size classes of naMalloc.
+//
+// When NA_MALLOC_SIZE_CLASSES is set to 1, naMalloc serves small byte sizes
+// with the same mechanism as the memory pools of the runtime system (see
+// NARuntime.c): Spaces are handed out from aligned parts of 64 KB. Every part
+// starts with an NA_MallocPart header and stores spaces of one size class
+// only. The parts of a size class form a circular list with a current part,
+// unused spaces form a list starting at firstUnused and everUsedCount allows
+// to hand out spaces without initializing the part.
+//
+// Other than the runtime pools, the size classes do not depend on the
+// lifetime of the runtime as naMalloc is used before the runtime starts and
+// after it stopped. Instead, one address range is reserved upon the first
+// small allocation and never released. The parts are carved out of that
+// range. This allows naFree to distinguish pointers of the size classes from
+// pointers of malloc by a simple range check and to find the owning part by
+// masking the address, just like naDelete does.
+//
+// Every thread owns an NA_MallocCache storing its current part of every size
+// class. As naMalloc is used everywhere in NALib, this is always thread-safe,
+// independent of NA_MEMORY_POOL_THREAD_SAFE. Spaces freed by a foreign thread
+// are pushed onto the remoteUnused list of the part with an atomic compare-
+// and-swap and collected by the owner when it runs out of space. Only
+// creating caches and carving or releasing parts requires a lock. As naMalloc
+// can not be used within these functions, the lock is a simple spin lock and
+// the internal structures are allocated with malloc directly.
+//
+// The memory of an empty part is given back to the system, except for the
+// last part of a size class. Its address is stored in an array of released
+// parts and reused for the next part needed.
+
+
+
+#if NA_MALLOC_SIZE_CLASSES
+
+#define NA_MALLOC_PART_BYTESIZE ((size_t)1 << 16)
+#define NA_MALLOC_PART_MASK (~(NA_MALLOC_PART_BYTESIZE - NA_ONE_s))
+#define NA_MALLOC_CLASS_COUNT 16
+
+typedef struct NA_MallocPart NA_MallocPart;
+typedef struct NA_MallocCache NA_MallocCache;
+
+// This structure is stored in the first bytes of every part. Its size is 16
+// addresses. The field written by foreign threads is placed in the second
+// half such that it does not share a cache line with the fields of the owner.
+// As the size is a multiple of 16 bytes and so are all size classes, all
+// spaces are aligned to 16 bytes like the pointers returned by malloc.
+struct NA_MallocPart{
+  NA_MallocCache* cache;        // The cache of the owning thread.
+  size_t classIndex;
+  size_t maxCount;
+  size_t usedCount;
+  size_t everUsedCount;
+  void* firstUnused;
+  NA_MallocPart* prevPart;
+  NA_MallocPart* nextPart;
+  NAAtomicPtr remoteUnused;     // Spaces freed by foreign threads.
+  void* padding[7];
+};
+
+// Every thread using naMalloc owns one NA_MallocCache. A thread calling
+// naDetachMallocThread marks its cache as abandoned and the cache will be
+// adopted by the next thread needing a cache.
+struct NA_MallocCache{
+  NA_MallocPart* curParts[NA_MALLOC_CLASS_COUNT];
+  NABool abandoned;
+  NA_MallocCache* next;
+};
+
+// The byte sizes of the size classes. Every power of two is followed by the
+// middle to the next power of two.
+static const size_t na_MallocClassSizes[NA_MALLOC_CLASS_COUNT] = {
+  16, 32, 48, 64, 96, 128, 192, 256,
+  384, 512, 768, 1024, 1536, 2048, 3072, 4096};
+
+// The class index for every byteSize, indexed by (byteSize - 1) / 16. Filled
+// when the address range is reserved.
+static NAByte na_MallocClassIndices[NA_MALLOC_SIZE_CLASS_MAX_BYTESIZE / 16];
+
+// The reserved address range. The base and byteSize are visible to naFree.
+NAByte* na_MallocPoolBase = NA_NULL;
+size_t na_MallocPoolByteSize = 0;
+static NAByte* na_MallocPoolFirstUncarved = NA_NULL;
+static NABool na_MallocPoolUnavailable = NA_FALSE;
+
+// The addresses of parts whose memory had been given back to the system.
+static void** na_MallocReleasedParts = NA_NULL;
+static size_t na_MallocReleasedPartCount = 0;
+static size_t na_MallocReleasedPartCapacity = 0;
+
+static NA_MallocCache* na_MallocCaches = NA_NULL;
+static NA_THREAD_LOCAL NA_MallocCache* na_MallocCache = NA_NULL;
+
+static NAAtomic32 na_MallocLock = {0};
+
+
+
+NA_HIDEF void na_LockMallocPool(){
+  while(naExchangeAtomic32(&na_MallocLock, 1, NA_MEMORY_ORDER_ACQUIRE)){naPauseAtomic();}
+}
+
+
+
+NA_HIDEF void na_UnlockMallocPool(){
+  naStoreAtomic32(&na_MallocLock, 0, NA_MEMORY_ORDER_RELEASE);
+}
+
+
+
+// Reserves the address range of the size classes. Expects the lock to be
+// locked. Returns NA_FALSE if the system refused.
+NA_HIDEF NABool na_ReserveMallocPool(){
+  // The usable size is a multiple of the part size. We reserve one part more
+  // to be able to align the start.
+  size_t usableSize = ((size_t)NA_MALLOC_POOL_RESERVE_BYTESIZE + NA_MALLOC_PART_BYTESIZE - NA_ONE_s) & NA_MALLOC_PART_MASK;
+  if(!usableSize){usableSize = NA_MALLOC_PART_BYTESIZE;}
+  size_t byteSize = usableSize + NA_MALLOC_PART_BYTESIZE;
+
+  #if NA_OS == NA_OS_WINDOWS
+    NAByte* base = VirtualAlloc(NA_NULL, byteSize, MEM_RESERVE, PAGE_READWRITE);
+    if(!base){return NA_FALSE;}
+  #else
+    int flags = MAP_PRIVATE | MAP_ANON;
+    #ifdef MAP_NORESERVE
+      flags |= MAP_NORESERVE;
+    #endif
+    NAByte* base = mmap(NA_NULL, byteSize, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if((void*)base == MAP_FAILED){return NA_FALSE;}
+  #endif
+
+  NAByte* first = (NAByte*)(((size_t)base + NA_MALLOC_PART_BYTESIZE - NA_ONE_s) & NA_MALLOC_PART_MASK);
+
+  #if NA_OS != NA_OS_WINDOWS
+    // Give back the bytes before and after the aligned range right away.
+    size_t headSize = (size_t)(first - base);
+    size_t tailSize = byteSize - headSize - usableSize;
+    if(headSize){munmap(base, headSize);}
+    if(tailSize){munmap(first + usableSize, tailSize);}
+  #endif
+
+  size_t classIndex = 0;
+  for(size_t i = 0; i < NA_MALLOC_SIZE_CLASS_MAX_BYTESIZE / 16; ++i){
+    while(((i + NA_ONE_s) * 16) > na_MallocClassSizes[classIndex]){classIndex++;}
+    na_MallocClassIndices[i] = (NAByte)classIndex;
+  }
+
+  na_MallocPoolFirstUncarved = first;
+
+  // See na_IsMallocSizeClassPointer for why the byteSize is written last.
+  #if NA_OS == NA_OS_WINDOWS
+    na_MallocPoolBase = first;
+    MemoryBarrier();
+    na_MallocPoolByteSize = usableSize;
+  #else
+    __atomic_store_n(&na_MallocPoolBase, first, __ATOMIC_RELAXED);
+    __atomic_store_n(&na_MallocPoolByteSize, usableSize, __ATOMIC_RELEASE);
+  #endif
+
+  return NA_TRUE;
+}
+
+
+
+// Returns the cache for the current thread, reserving the address range if
+// this is the first cache ever. Returns Null if no address range is
+// available.
+NA_HDEF NA_MallocCache* na_AdoptMallocCache(){
+  NA_MallocCache* cache = NA_NULL;
+  na_LockMallocPool();
+
+  if(!na_MallocPoolFirstUncarved && !na_MallocPoolUnavailable){
+    na_MallocPoolUnavailable = !na_ReserveMallocPool();
+  }
+
+  if(!na_MallocPoolUnavailable){
+    cache = na_MallocCaches;
+    while(cache && !cache->abandoned){cache = cache->next;}
+    if(cache){
+      cache->abandoned = NA_FALSE;
+    }else{
+      cache = calloc(1, sizeof(NA_MallocCache));
+      if(cache){
+        cache->next = na_MallocCaches;
+        na_MallocCaches = cache;
+      }
+    }
+  }
+
+  na_UnlockMallocPool();
+  return cache;
+}
+
+
+
+// Returns the memory of a new part, either one which has been released
+// before or a newly carved one. Returns Null if the range is exhausted.
+NA_HIDEF NA_MallocPart* na_AllocMallocPart(){
+  NAByte* part = NA_NULL;
+
+  na_LockMallocPool();
+  if(na_MallocReleasedPartCount){
+    na_MallocReleasedPartCount--;
+    part = na_MallocReleasedParts[na_MallocReleasedPartCount];
+  }else if(na_MallocPoolFirstUncarved != na_MallocPoolBase + na_MallocPoolByteSize){
+    part = na_MallocPoolFirstUncarved;
+    na_MallocPoolFirstUncarved += NA_MALLOC_PART_BYTESIZE;
+  }
+  na_UnlockMallocPool();
+
+  #if NA_OS == NA_OS_WINDOWS
+    // On windows, the memory must be committed before it can be used. If that
+    // fails, we leave the address uncommitted and fall back to malloc.
+    if(part && !VirtualAlloc(part, NA_MALLOC_PART_BYTESIZE, MEM_COMMIT, PAGE_READWRITE)){
+      part = NA_NULL;
+    }
+  #endif
+
+  return (NA_MallocPart*)part;
+}
+
+
+
+// Gives the memory of the part back to the system but keeps its address.
+NA_HIDEF void na_FreeMallocPart(NA_MallocPart* part){
+  #if NA_OS == NA_OS_WINDOWS
+    VirtualFree(part, NA_MALLOC_PART_BYTESIZE, MEM_DECOMMIT);
+  #else
+    madvise(part, NA_MALLOC_PART_BYTESIZE, MADV_DONTNEED);
+  #endif
+
+  na_LockMallocPool();
+  if(na_MallocReleasedPartCount == na_MallocReleasedPartCapacity){
+    size_t newCapacity = na_MallocReleasedPartCapacity ? 2 * na_MallocReleasedPartCapacity : 64;
+    void** newParts = realloc(na_MallocReleasedParts, sizeof(void*) * newCapacity);
+    if(!newParts){
+      // We lose the address but the memory is given back anyway.
+      na_UnlockMallocPool();
+      return;
+    }
+    na_MallocReleasedParts = newParts;
+    na_MallocReleasedPartCapacity = newCapacity;
+  }
+  na_MallocReleasedParts[na_MallocReleasedPartCount] = part;
+  na_MallocReleasedPartCount++;
+  na_UnlockMallocPool();
+}
+
+
+
+NA_HIDEF NABool na_IsMallocPartFull(const NA_MallocPart* part){
+  return part->usedCount == part->maxCount;
+}
+
+
+
+NA_HIDEF void na_AttachMallocPartAfterCurMallocPart(NA_MallocPart* curPart, NA_MallocPart* part){
+  part->prevPart = curPart;
+  part->nextPart = curPart->nextPart;
+  part->prevPart->nextPart = part;
+  part->nextPart->prevPart = part;
+}
+
+
+
+// Creates a new part for the given size class and makes it the current one.
+// Returns Null if no part is available.
+NA_HIDEF NA_MallocPart* na_EnhanceMallocPool(NA_MallocCache* cache, size_t classIndex){
+  NA_MallocPart* part = na_AllocMallocPart();
+  if(!part){return NA_NULL;}
+
+  part->cache = cache;
+  part->classIndex = classIndex;
+  part->maxCount = (NA_MALLOC_PART_BYTESIZE - sizeof(NA_MallocPart)) / na_MallocClassSizes[classIndex];
+  part->usedCount = 0;
+  part->everUsedCount = 0;
+  part->firstUnused = (NAByte*)part + sizeof(NA_MallocPart);
+  naInitAtomicPtr(&(part->remoteUnused), NA_NULL);
+
+  NA_MallocPart** curPart = &(cache->curParts[classIndex]);
+  if(*curPart){
+    na_AttachMallocPartAfterCurMallocPart(*curPart, part);
+  }else{
+    part->prevPart = part;
+    part->nextPart = part;
+  }
+  *curPart = part;
+  return part;
+}
+
+
+
+// Moves all spaces freed by foreign threads back into the list of unused
+// spaces of the part. Must only be called by the owning thread. Returns
+// NA_TRUE if any space was collected.
+NA_HIDEF NABool na_CollectRemoteMallocPartObjects(NA_MallocPart* part){
+  void* firstRemote = naExchangeAtomicPtr(&(part->remoteUnused), NA_NULL, NA_MEMORY_ORDER_ACQUIRE);
+  if(!firstRemote){return NA_FALSE;}
+
+  size_t remoteCount = 1;
+  void** link = (void**)firstRemote;
+  while(*link){
+    link = (void**)*link;
+    remoteCount++;
+  }
+
+  *link = part->firstUnused;
+  part->firstUnused = firstRemote;
+  part->usedCount -= remoteCount;
+  return NA_TRUE;
+}
+
+
+
+// Returns a part of the given size class with at least one unused space.
+// The current part is expected to be full or not existing.
+NA_HDEF NA_MallocPart* na_GetMallocPartWithSpace(NA_MallocCache* cache, size_t classIndex){
+  NA_MallocPart** curPart = &(cache->curParts[classIndex]);
+  if(*curPart){
+    // If the next part is full as well, no part in the list has any space
+    // left. But first, we look for spaces freed by other threads. Every part
+    // which gained space is moved right after the current part.
+    *curPart = (*curPart)->nextPart;
+    if(!na_IsMallocPartFull(*curPart)){return *curPart;}
+
+    NA_MallocPart* firstPart = *curPart;
+    NA_MallocPart* part = firstPart;
+    do{
+      NA_MallocPart* nextPart = part->nextPart;
+      if(na_CollectRemoteMallocPartObjects(part) && part != firstPart){
+        part->nextPart->prevPart = part->prevPart;
+        part->prevPart->nextPart = part->nextPart;
+        na_AttachMallocPartAfterCurMallocPart(firstPart, part);
+      }
+      part = nextPart;
+    }while(part != firstPart);
+
+    if(na_IsMallocPartFull(*curPart)){*curPart = (*curPart)->nextPart;}
+    if(!na_IsMallocPartFull(*curPart)){return *curPart;}
+  }
+  return na_EnhanceMallocPool(cache, classIndex);
+}
+
+
+
+NA_DEF void* na_MallocSizeClass(size_t byteSize){
+  NA_MallocCache* cache = na_MallocCache;
+  if(!cache){
+    cache = na_AdoptMallocCache();
+    if(!cache){return NA_NULL;}
+    na_MallocCache = cache;
+  }
+
+  size_t classIndex = na_MallocClassIndices[(byteSize - NA_ONE_s) >> 4];
+  NA_MallocPart* part = cache->curParts[classIndex];
+  if(!part || na_IsMallocPartFull(part)){
+    part = na_GetMallocPartWithSpace(cache, classIndex);
+    if(!part){return NA_NULL;}
+  }
+
+  void* pointer = part->firstUnused;
+  if(part->usedCount == part->everUsedCount){
+    part->firstUnused = (NAByte*)pointer + na_MallocClassSizes[classIndex];
+    part->everUsedCount++;
+  }else{
+    part->firstUnused = *((void**)pointer);
+  }
+  part->usedCount++;
+
+  return pointer;
+}
+
+
+
+NA_DEF void na_FreeSizeClass(void* ptr){
+  NA_MallocPart* part = (NA_MallocPart*)((size_t)ptr & NA_MALLOC_PART_MASK);
+
+  #if NA_DEBUG
+    if(ptr < (void*)((NAByte*)part + sizeof(NA_MallocPart)))
+      naError("Pointer seems not to be from naMalloc.");
+  #endif
+
+  // If the part belongs to a different thread, we hand the space over to the
+  // owner of the part.
+  NA_MallocCache* cache = na_MallocCache;
+  if(part->cache != cache){
+    void* remoteUnused = NA_NULL;
+    do{
+      *((void**)ptr) = remoteUnused;
+    }while(!naCompareExchangeAtomicPtr(&(part->remoteUnused), &remoteUnused, ptr, NA_MEMORY_ORDER_RELEASE));
+    return;
+  }
+
+  NA_MallocPart** curPart = &(cache->curParts[part->classIndex]);
+
+  // If the part was full up until now, we reattach it right after the
+  // current part.
+  if(na_IsMallocPartFull(part) && (part->nextPart != part) && (*curPart != part)){
+    part->nextPart->prevPart = part->prevPart;
+    part->prevPart->nextPart = part->nextPart;
+    na_AttachMallocPartAfterCurMallocPart(*curPart, part);
+  }
+
+  *((void**)ptr) = part->firstUnused;
+  part->firstUnused = ptr;
+  part->usedCount--;
+
+  // An empty part is given back unless it is the last one of its class.
+  if(!part->usedCount && part->nextPart != part){
+    if(*curPart == part){*curPart = part->nextPart;}
+    part->prevPart->nextPart = part->nextPart;
+    part->nextPart->prevPart = part->prevPart;
+    na_FreeMallocPart(part);
+  }
+}
+
+#endif // NA_MALLOC_SIZE_CLASSES
+
+
+
+NA_DEF void naDetachMallocThread(){
+  #if NA_MALLOC_SIZE_CLASSES
+    NA_MallocCache* cache = na_MallocCache;
+    if(cache){
+      na_LockMallocPool();
+      cache->abandoned = NA_TRUE;
+      na_UnlockMallocPool();
+      na_MallocCache = NA_NULL;
+    }
+  #endif
+}
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
@@ -16,6 +16,49 @@
 
 
 
+#if NA_MEMORY_TRACE
+  // Removes the record of the allocation at ptr. Unknown pointers are
+  // ignored. See NAMemoryTraceII.h
+  NA_API void na_TraceDeallocation(void* ptr);
+#endif
+
+
+
+#if NA_MALLOC_SIZE_CLASSES
+
+  // The biggest byte size served by the size classes.
+  #define NA_MALLOC_SIZE_CLASS_MAX_BYTESIZE 4096
+
+  // The address range reserved for the size classes. Both are zero until the
+  // first small allocation happened. See NAMallocFree.c
+  extern NAByte* na_MallocPoolBase;
+  extern size_t na_MallocPoolByteSize;
+
+  // Returns a space of the size class fitting byteSize or Null if the
+  // address range is exhausted. byteSize must be within 1 and
+  // NA_MALLOC_SIZE_CLASS_MAX_BYTESIZE.
+  NA_API void* na_MallocSizeClass(size_t byteSize);
+  // Gives back a space returned by na_MallocSizeClass.
+  NA_API void na_FreeSizeClass(void* ptr);
+
+  // Returns true if ptr lies within the address range of the size classes.
+  // The byteSize is written after the base, hence reading it first makes
+  // sure, the base is valid whenever the byteSize is not zero.
+  NA_HIDEF NABool na_IsMallocSizeClassPointer(const void* ptr){
+    #if NA_OS == NA_OS_WINDOWS
+      size_t byteSize = *((volatile size_t*)&na_MallocPoolByteSize);
+      NAByte* base = *((NAByte* volatile*)&na_MallocPoolBase);
+    #else
+      size_t byteSize = __atomic_load_n(&na_MallocPoolByteSize, __ATOMIC_ACQUIRE);
+      NAByte* base = __atomic_load_n(&na_MallocPoolBase, __ATOMIC_RELAXED);
+    #endif
+    return ((size_t)ptr - (size_t)base) < byteSize;
+  }
+
+#endif
+
+
+
 NA_IDEF void* naMalloc(size_t byteSize){
   void* ptr;
 
@@ -24,7 +67,17 @@ NA_IDEF void* naMalloc(size_t byteSize){
       naCrash("size is zero.");
   #endif
 
-  ptr = malloc(byteSize);
+  #if NA_MALLOC_SIZE_CLASSES
+    // Small sizes are served by the size classes. Note that byteSize zero
+    // wraps around and hence is served by malloc.
+    ptr = NA_NULL;
+    if(byteSize - NA_ONE_s < NA_MALLOC_SIZE_CLASS_MAX_BYTESIZE){
+      ptr = na_MallocSizeClass(byteSize);
+    }
+    if(!ptr){ptr = malloc(byteSize);}
+  #else
+    ptr = malloc(byteSize);
+  #endif
 
   #if NA_DEBUG
   if(!ptr)
@@ -42,6 +95,15 @@ NA_IDEF void* naMalloc(size_t byteSize){
 
 
 NA_IDEF void naFree(void* ptr){
+  #if NA_MEMORY_TRACE
+    na_TraceDeallocation(ptr);
+  #endif
+  #if NA_MALLOC_SIZE_CLASSES
+    if(na_IsMallocSizeClassPointer(ptr)){
+      na_FreeSizeClass(ptr);
+      return;
+    }
+  #endif
   free(ptr);
 }
 
@@ -105,6 +167,9 @@ NA_IDEF void* naMallocPageAligned(size_t byteSize){
 
 
 NA_IDEF void naFreeAligned(void* ptr){
+  #if NA_MEMORY_TRACE
+    na_TraceDeallocation(ptr);
+  #endif
   #if NA_OS == NA_OS_WINDOWS
     _aligned_free(ptr);
   #else
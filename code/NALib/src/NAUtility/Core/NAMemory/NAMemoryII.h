@@ -10,7 +10,9 @@
 #include "NAPtrII.h"
 #include "NASmartPtrII.h"
 #include "NAPointerII.h"
+#include "NAArenaII.h"
 #include "NARuntimeII.h"
+#include "NAMemoryTraceII.h"
 
 
 
@@ -0,0 +1,464 @@
+#include "../../NAMemory.h"
+#include "../../NAAtomic.h"
+
+#if NA_MEMORY_TRACE
+  #include <stdio.h>
+  #include <string.h>
+#endif
+
+// //////////////////////////////////////
+// Implementation notes about the memory trace.
+//
+// Every traced allocation is stored as an NA_TraceRecord in a hash table with
+// the pointer as the key. Every record points to the NA_TraceSite it was
+// allocated at. The sites are stored in a second hash table with the file,
+// line, kind and type name as the key. As the file and type names are static
+// strings, comparing their addresses suffices.
+//
+// Both tables are guarded by one spin lock. They are allocated with malloc
+// directly as naMalloc itself is traced. Temporary memory is recorded along
+// with its arena such that all records can be removed when the garbage of
+// that arena is collected.
+
+
+
+#if NA_MEMORY_TRACE
+
+// The traced functions call the untraced ones.
+#undef naMalloc
+#undef naMallocAligned
+#undef naMallocPageAligned
+
+#define NA_TRACE_INITIAL_BUCKET_COUNT 1024
+
+typedef struct NA_TraceSite NA_TraceSite;
+typedef struct NA_TraceRecord NA_TraceRecord;
+
+struct NA_TraceSite{
+  const char* file;
+  int line;
+  NA_MemoryTraceKind kind;
+  const char* typeName;
+  size_t allocCount;
+  size_t freeCount;
+  size_t byteCount;         // The total bytes ever allocated.
+  size_t liveCount;
+  size_t liveBytes;
+  size_t peakLiveBytes;
+  NA_TraceSite* next;       // The next site in the same bucket.
+};
+
+struct NA_TraceRecord{
+  const void* ptr;
+  size_t byteSize;
+  NA_TraceSite* site;
+  const void* arena;        // The arena of temporary memory or Null.
+  NA_TraceRecord* next;     // The next record in the same bucket.
+};
+
+// A hash table simply is an array of buckets with a power of two count.
+typedef struct NA_TraceTable NA_TraceTable;
+struct NA_TraceTable{
+  void** buckets;
+  size_t bucketCount;
+  size_t count;
+};
+
+static NA_TraceTable na_TraceRecords = {NA_NULL, 0, 0};
+static NA_TraceTable na_TraceSites = {NA_NULL, 0, 0};
+
+static NAAtomic32 na_TraceLock = {0};
+
+
+
+NA_HIDEF void na_LockTrace(){
+  while(naExchangeAtomic32(&na_TraceLock, 1, NA_MEMORY_ORDER_ACQUIRE)){naPauseAtomic();}
+}
+
+
+
+NA_HIDEF void na_UnlockTrace(){
+  naStoreAtomic32(&na_TraceLock, 0, NA_MEMORY_ORDER_RELEASE);
+}
+
+
+
+NA_HIDEF size_t na_GetTraceRecordHash(const void* ptr){
+  return ((size_t)ptr >> 4) * (size_t)2654435761u;
+}
+
+
+
+NA_HIDEF size_t na_GetTraceSiteHash(const char* file, int line, const char* typeName){
+  return (((size_t)file >> 3) ^ ((size_t)typeName >> 3) ^ (size_t)line) * (size_t)2654435761u;
+}
+
+
+
+// Makes sure the table has buckets and not too many entries per bucket.
+// Returns NA_FALSE if no memory is available.
+NA_HDEF NABool na_GrowTraceTable(NA_TraceTable* table, NABool isRecordTable){
+  if(table->count < 2 * table->bucketCount){return NA_TRUE;}
+
+  size_t newBucketCount = table->bucketCount ? 2 * table->bucketCount : NA_TRACE_INITIAL_BUCKET_COUNT;
+  void** newBuckets = calloc(newBucketCount, sizeof(void*));
+  if(!newBuckets){return table->buckets != NA_NULL;}
+
+  for(size_t i = 0; i < table->bucketCount; ++i){
+    if(isRecordTable){
+      NA_TraceRecord* record = table->buckets[i];
+      while(record){
+        NA_TraceRecord* next = record->next;
+        size_t index = na_GetTraceRecordHash(record->ptr) & (newBucketCount - 1);
+        record->next = newBuckets[index];
+        newBuckets[index] = record;
+        record = next;
+      }
+    }else{
+      NA_TraceSite* site = table->buckets[i];
+      while(site){
+        NA_TraceSite* next = site->next;
+        size_t index = na_GetTraceSiteHash(site->file, site->line, site->typeName) & (newBucketCount - 1);
+        site->next = newBuckets[index];
+        newBuckets[index] = site;
+        site = next;
+      }
+    }
+  }
+
+  free(table->buckets);
+  table->buckets = newBuckets;
+  table->bucketCount = newBucketCount;
+  return NA_TRUE;
+}
+
+
+
+// Returns the site with the given key, creating it if needed. Expects the
+// lock to be locked.
+NA_HDEF NA_TraceSite* na_GetTraceSite(NA_MemoryTraceKind kind, const char* typeName, const char* file, int line){
+  if(!na_GrowTraceTable(&na_TraceSites, NA_FALSE)){return NA_NULL;}
+
+  size_t index = na_GetTraceSiteHash(file, line, typeName) & (na_TraceSites.bucketCount - 1);
+  NA_TraceSite* site = na_TraceSites.buckets[index];
+  while(site){
+    if(site->line == line && site->file == file && site->typeName == typeName && site->kind == kind){
+      return site;
+    }
+    site = site->next;
+  }
+
+  site = calloc(1, sizeof(NA_TraceSite));
+  if(!site){return NA_NULL;}
+  site->file = file;
+  site->line = line;
+  site->kind = kind;
+  site->typeName = typeName;
+  site->next = na_TraceSites.buckets[index];
+  na_TraceSites.buckets[index] = site;
+  na_TraceSites.count++;
+  return site;
+}
+
+
+
+// Unlinks the given record, updates its site and frees it. prevLink is the
+// link pointing to the record. Expects the lock to be locked.
+NA_HIDEF void na_RemoveTraceRecord(void** prevLink, NA_TraceRecord* record, NABool countAsFreed){
+  *prevLink = record->next;
+  if(countAsFreed){record->site->freeCount++;}
+  record->site->liveCount--;
+  record->site->liveBytes -= record->byteSize;
+  free(record);
+  na_TraceRecords.count--;
+}
+
+
+
+// Removes all records for which the given kind or arena matches. Expects the
+// lock to be locked.
+NA_HDEF void na_RemoveTraceRecords(NA_MemoryTraceKind kind, const void* arena, NABool countAsFreed){
+  for(size_t i = 0; i < na_TraceRecords.bucketCount; ++i){
+    void** prevLink = &(na_TraceRecords.buckets[i]);
+    while(*prevLink){
+      NA_TraceRecord* record = *prevLink;
+      NABool matches = arena ? (record->arena == arena) : (record->site->kind == kind);
+      if(matches){
+        na_RemoveTraceRecord(prevLink, record, countAsFreed);
+      }else{
+        prevLink = (void**)&(record->next);
+      }
+    }
+  }
+}
+
+
+
+NA_DEF void na_TraceAllocation(void* ptr, size_t byteSize, NA_MemoryTraceKind kind, const char* typeName, const void* arena, const char* file, int line){
+  if(!ptr){return;}
+  na_LockTrace();
+
+  NA_TraceSite* site = na_GetTraceSite(kind, typeName, file, line);
+  NA_TraceRecord* record = NA_NULL;
+  if(site && na_GrowTraceTable(&na_TraceRecords, NA_TRUE)){
+    record = malloc(sizeof(NA_TraceRecord));
+  }
+
+  if(record){
+    site->allocCount++;
+    site->byteCount += byteSize;
+    site->liveCount++;
+    site->liveBytes += byteSize;
+    if(site->liveBytes > site->peakLiveBytes){site->peakLiveBytes = site->liveBytes;}
+
+    size_t index = na_GetTraceRecordHash(ptr) & (na_TraceRecords.bucketCount - 1);
+    record->ptr = ptr;
+    record->byteSize = byteSize;
+    record->site = site;
+    record->arena = arena;
+    record->next = na_TraceRecords.buckets[index];
+    na_TraceRecords.buckets[index] = record;
+    na_TraceRecords.count++;
+  }
+
+  na_UnlockTrace();
+}
+
+
+
+NA_DEF void na_TraceDeallocation(void* ptr){
+  if(!ptr){return;}
+  na_LockTrace();
+
+  if(na_TraceRecords.bucketCount){
+    size_t index = na_GetTraceRecordHash(ptr) & (na_TraceRecords.bucketCount - 1);
+    void** prevLink = &(na_TraceRecords.buckets[index]);
+    while(*prevLink){
+      NA_TraceRecord* record = *prevLink;
+      if(record->ptr == ptr){
+        na_RemoveTraceRecord(prevLink, record, NA_TRUE);
+        break;
+      }
+      prevLink = (void**)&(record->next);
+    }
+  }
+
+  na_UnlockTrace();
+}
+
+
+
+NA_DEF void na_TraceArenaCleared(const void* arena){
+  na_LockTrace();
+  na_RemoveTraceRecords(NA_MEMORY_TRACE_MALLOC_TMP, arena, NA_TRUE);
+  na_UnlockTrace();
+}
+
+
+
+NA_DEF void na_TraceRuntimeStopped(){
+  // Collecting the garbage is no leak, hence it is removed before printing.
+  // The objects of the runtime types which are still alive are leaks. They
+  // are printed but removed afterwards as their memory is gone.
+  na_LockTrace();
+  for(size_t i = 0; i < na_TraceRecords.bucketCount; ++i){
+    void** prevLink = &(na_TraceRecords.buckets[i]);
+    while(*prevLink){
+      NA_TraceRecord* record = *prevLink;
+      if(record->arena){
+        na_RemoveTraceRecord(prevLink, record, NA_TRUE);
+      }else{
+        prevLink = (void**)&(record->next);
+      }
+    }
+  }
+  na_UnlockTrace();
+
+  naPrintMemoryTrace();
+
+  na_LockTrace();
+  na_RemoveTraceRecords(NA_MEMORY_TRACE_RUNTIME, NA_NULL, NA_FALSE);
+  na_UnlockTrace();
+}
+
+
+
+NA_HIDEF const char* na_GetTraceSiteName(const NA_TraceSite* site){
+  switch(site->kind){
+  case NA_MEMORY_TRACE_MALLOC: return "naMalloc";
+  case NA_MEMORY_TRACE_MALLOC_ALIGNED: return "naMallocAligned";
+  case NA_MEMORY_TRACE_MALLOC_TMP: return "naMallocTmp";
+  default: return site->typeName;
+  }
+}
+
+
+
+// Sorts the sites by descending peak of live bytes.
+NA_HDEF int na_CompareTraceSites(const void* a, const void* b){
+  const NA_TraceSite* siteA = *(const NA_TraceSite**)a;
+  const NA_TraceSite* siteB = *(const NA_TraceSite**)b;
+  if(siteA->peakLiveBytes != siteB->peakLiveBytes){
+    return (siteA->peakLiveBytes < siteB->peakLiveBytes) ? 1 : -1;
+  }
+  return 0;
+}
+
+
+
+// Sorts the records by their call site and then by address.
+NA_HDEF int na_CompareTraceRecords(const void* a, const void* b){
+  const NA_TraceRecord* recordA = *(const NA_TraceRecord**)a;
+  const NA_TraceRecord* recordB = *(const NA_TraceRecord**)b;
+  if(recordA->site != recordB->site){
+    int fileOrder = strcmp(recordA->site->file, recordB->site->file);
+    if(fileOrder){return fileOrder;}
+    if(recordA->site->line != recordB->site->line){
+      return (recordA->site->line < recordB->site->line) ? -1 : 1;
+    }
+    return ((size_t)recordA->site < (size_t)recordB->site) ? -1 : 1;
+  }
+  return ((size_t)recordA->ptr < (size_t)recordB->ptr) ? -1 : (((size_t)recordA->ptr > (size_t)recordB->ptr) ? 1 : 0);
+}
+
+
+
+// Returns a malloc'ed array with all entries of the table.
+NA_HDEF void** na_CopyTraceTableEntries(const NA_TraceTable* table, NABool isRecordTable){
+  void** entries = malloc((table->count + 1) * sizeof(void*));
+  if(!entries){return NA_NULL;}
+  size_t count = 0;
+  for(size_t i = 0; i < table->bucketCount; ++i){
+    void* entry = table->buckets[i];
+    while(entry){
+      entries[count] = entry;
+      count++;
+      entry = isRecordTable ? (void*)((NA_TraceRecord*)entry)->next : (void*)((NA_TraceSite*)entry)->next;
+    }
+  }
+  return entries;
+}
+
+#endif // NA_MEMORY_TRACE
+
+
+
+NA_DEF void naPrintMemoryTrace(){
+  #if NA_MEMORY_TRACE
+    na_LockTrace();
+
+    NA_TraceSite** sites = (NA_TraceSite**)na_CopyTraceTableEntries(&na_TraceSites, NA_FALSE);
+    if(sites){
+      qsort(sites, na_TraceSites.count, sizeof(NA_TraceSite*), na_CompareTraceSites);
+      printf(NA_NL "Memory trace: %zu call sites, %zu allocations alive" NA_NL, na_TraceSites.count, na_TraceRecords.count);
+      printf("%10s %10s %14s %14s  %-20s %s" NA_NL, "Allocs", "Frees", "Bytes", "Peak bytes", "Kind", "Call site");
+      for(size_t i = 0; i < na_TraceSites.count; ++i){
+        NA_TraceSite* site = sites[i];
+        printf("%10zu %10zu %14zu %14zu  %-20s %s:%d" NA_NL, site->allocCount, site->freeCount, site->byteCount, site->peakLiveBytes, na_GetTraceSiteName(site), site->file, site->line);
+      }
+      free(sites);
+    }
+
+    NA_TraceRecord** records = (NA_TraceRecord**)na_CopyTraceTableEntries(&na_TraceRecords, NA_TRUE);
+    if(records && na_TraceRecords.count){
+      qsort(records, na_TraceRecords.count, sizeof(NA_TraceRecord*), na_CompareTraceRecords);
+      printf(NA_NL "Allocations alive:" NA_NL);
+      for(size_t i = 0; i < na_TraceRecords.count; ++i){
+        NA_TraceRecord* record = records[i];
+        printf("%p: %zu Bytes %s at %s:%d" NA_NL, record->ptr, record->byteSize, na_GetTraceSiteName(record->site), record->site->file, record->site->line);
+      }
+    }
+    free(records);
+
+    na_UnlockTrace();
+  #endif
+}
+
+
+
+#if NA_MEMORY_TRACE
+
+NA_DEF void* na_MallocTraced(size_t byteSize, const char* file, int line){
+  void* ptr = naMalloc(byteSize);
+  na_TraceAllocation(ptr, byteSize, NA_MEMORY_TRACE_MALLOC, NA_NULL, NA_NULL, file, line);
+  return ptr;
+}
+
+
+
+NA_DEF void* na_MallocAlignedTraced(size_t byteSize, size_t align, const char* file, int line){
+  void* ptr = naMallocAligned(byteSize, align);
+  na_TraceAllocation(ptr, byteSize, NA_MEMORY_TRACE_MALLOC_ALIGNED, NA_NULL, NA_NULL, file, line);
+  return ptr;
+}
+
+
+
+NA_DEF void* na_MallocPageAlignedTraced(size_t byteSize, const char* file, int line){
+  void* ptr = naMallocPageAligned(byteSize);
+  na_TraceAllocation(ptr, byteSize, NA_MEMORY_TRACE_MALLOC_ALIGNED, NA_NULL, NA_NULL, file, line);
+  return ptr;
+}
+
+
+
+NA_DEF void* na_NewStructTraced(NATypeInfo* info, const char* file, int line){
+  void* ptr = na_NewStruct(info);
+  na_TraceAllocation(ptr, info->typeSize, NA_MEMORY_TRACE_RUNTIME, info->typeName, NA_NULL, file, line);
+  return ptr;
+}
+
+
+
+NA_DEF void* na_CreateStructTraced(NATypeInfo* info, const char* file, int line){
+  void* ptr = na_CreateStruct(info);
+  na_TraceAllocation(ptr, info->typeSize, NA_MEMORY_TRACE_RUNTIME, info->typeName, NA_NULL, file, line);
+  return ptr;
+}
+
+
+
+NA_DEF void na_NewStructBatchTraced(NATypeInfo* info, void** pointers, size_t count, const char* file, int line){
+  na_NewStructBatch(info, pointers, count);
+  for(size_t i = 0; i < count; ++i){
+    na_TraceAllocation(pointers[i], info->typeSize, NA_MEMORY_TRACE_RUNTIME, info->typeName, NA_NULL, file, line);
+  }
+}
+
+
+
+NA_DEF void na_CreateStructBatchTraced(NATypeInfo* info, void** pointers, size_t count, const char* file, int line){
+  na_CreateStructBatch(info, pointers, count);
+  for(size_t i = 0; i < count; ++i){
+    na_TraceAllocation(pointers[i], info->typeSize, NA_MEMORY_TRACE_RUNTIME, info->typeName, NA_NULL, file, line);
+  }
+}
+
+#endif // NA_MEMORY_TRACE
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
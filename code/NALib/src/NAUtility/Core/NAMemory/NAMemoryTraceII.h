@@ -0,0 +1,108 @@
+// This file contains inline implementations of the file NAMemory.h
+// Do not include this file directly! It will automatically be included when
+// including "NAMemoryII.h"
+
+
+
+#if NA_MEMORY_TRACE
+
+// The kinds of allocations distinguished by the trace.
+typedef enum{
+  NA_MEMORY_TRACE_MALLOC,
+  NA_MEMORY_TRACE_MALLOC_ALIGNED,
+  NA_MEMORY_TRACE_MALLOC_TMP,
+  NA_MEMORY_TRACE_RUNTIME
+} NA_MemoryTraceKind;
+
+// Records an allocation of byteSize bytes at ptr. typeName is the name of
+// the runtime type or Null, arena the arena of temporary memory or Null.
+// The strings are expected to be static. ptr being Null is ignored.
+NA_API void na_TraceAllocation(
+  void* ptr,
+  size_t byteSize,
+  NA_MemoryTraceKind kind,
+  const char* typeName,
+  const void* arena,
+  const char* file,
+  int line);
+
+// Removes the records of all temporary memory of the given arena.
+NA_API void na_TraceArenaCleared(const void* arena);
+
+// Prints the trace and removes the records of all runtime types and
+// temporary memory as their memory is gone.
+NA_API void na_TraceRuntimeStopped(void);
+
+// The following functions call the untraced functions and record the
+// allocation with the given call site.
+NA_API void* na_MallocTraced(size_t byteSize, const char* file, int line);
+NA_API void* na_MallocAlignedTraced(size_t byteSize, size_t align, const char* file, int line);
+NA_API void* na_MallocPageAlignedTraced(size_t byteSize, const char* file, int line);
+NA_API void* na_MallocTmpTraced(size_t byteSize, const char* file, int line);
+NA_API void* na_NewStructTraced(NATypeInfo* info, const char* file, int line);
+NA_API void* na_CreateStructTraced(NATypeInfo* info, const char* file, int line);
+NA_API void  na_NewStructBatchTraced(NATypeInfo* info, void** pointers, size_t count, const char* file, int line);
+NA_API void  na_CreateStructBatchTraced(NATypeInfo* info, void** pointers, size_t count, const char* file, int line);
+
+// From here on, all allocations are redirected to the traced functions.
+// Note that naAlloc expands to naMalloc and hence is traced as well.
+#undef naMalloc
+#define naMalloc(byteSize)\
+  na_MallocTraced(byteSize, __FILE__, __LINE__)
+
+#undef naMallocAligned
+#define naMallocAligned(byteSize, align)\
+  na_MallocAlignedTraced(byteSize, align, __FILE__, __LINE__)
+
+#undef naMallocPageAligned
+#define naMallocPageAligned(byteSize)\
+  na_MallocPageAlignedTraced(byteSize, __FILE__, __LINE__)
+
+#undef naMallocTmp
+#define naMallocTmp(byteSize)\
+  na_MallocTmpTraced(byteSize, __FILE__, __LINE__)
+
+#undef naNew
+#define naNew(typeName)\
+  ((typeName*)na_NewStructTraced(&na_ ## typeName ## TypeInfo, __FILE__, __LINE__))
+
+#undef naCreate
+#define naCreate(typeName)\
+  ((typeName*)na_CreateStructTraced(&na_ ## typeName ## TypeInfo, __FILE__, __LINE__))
+
+#undef naNewBatch
+#define naNewBatch(typeName, pointers, count)\
+  na_NewStructBatchTraced(&na_ ## typeName ## TypeInfo, (void**)(pointers), count, __FILE__, __LINE__)
+
+#undef naCreateBatch
+#define naCreateBatch(typeName, pointers, count)\
+  na_CreateStructBatchTraced(&na_ ## typeName ## TypeInfo, (void**)(pointers), count, __FILE__, __LINE__)
+
+#endif // NA_MEMORY_TRACE
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
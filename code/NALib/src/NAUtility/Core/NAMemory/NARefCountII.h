@@ -32,10 +32,67 @@ struct NARefCount{
 
 #define NA_REFCOUNT_DUMMY_VALUE (uint32)0xaaaaaaaa
 
+// When NA_ATOMIC_REFCOUNT is 1, the highest bit of the count field denotes
+// whether the count shall be changed atomically. See NAConfiguration.h
+#if NA_ATOMIC_REFCOUNT == 1
+  #define NA_REFCOUNT_ATOMIC_FLAG ((size_t)1 << (sizeof(size_t) * 8 - 1))
+#endif
+
+
+
+#if NA_ATOMIC_REFCOUNT != 0
+
+  // Reads the count field. As another thread might change the count at the
+  // same time, the value is read atomically but without any ordering.
+  NA_HIDEF size_t na_LoadRefCountAtomic(const NARefCount* refCount){
+    #if NA_OS == NA_OS_WINDOWS
+      return *((volatile const size_t*)&(refCount->count));
+    #else
+      return __atomic_load_n(&(refCount->count), __ATOMIC_RELAXED);
+    #endif
+  }
+
+  // Increasing the count needs no ordering: The thread retaining already
+  // owns a reference and hence the object can not vanish in the meantime.
+  NA_HIDEF void na_IncRefCountAtomic(NARefCount* refCount){
+    #if NA_OS == NA_OS_WINDOWS
+      #if NA_ADDRESS_BITS == 64
+        InterlockedIncrement64((volatile LONG64*)&(refCount->count));
+      #else
+        InterlockedIncrement((volatile LONG*)&(refCount->count));
+      #endif
+    #else
+      __atomic_add_fetch(&(refCount->count), 1, __ATOMIC_RELAXED);
+    #endif
+  }
+
+  // Decreasing the count must release all writes of this thread to the object
+  // and the thread reaching zero must acquire the writes of all other threads
+  // before calling the destructor. Returns the new count.
+  NA_HIDEF size_t na_DecRefCountAtomic(NARefCount* refCount){
+    #if NA_OS == NA_OS_WINDOWS
+      #if NA_ADDRESS_BITS == 64
+        return (size_t)InterlockedDecrement64((volatile LONG64*)&(refCount->count));
+      #else
+        return (size_t)InterlockedDecrement((volatile LONG*)&(refCount->count));
+      #endif
+    #else
+      return __atomic_sub_fetch(&(refCount->count), 1, __ATOMIC_ACQ_REL);
+    #endif
+  }
+
+#endif
+
 
 
 NA_HIDEF size_t na_GetRefCountCount(const NARefCount* refCount){
-  return refCount->count;
+  #if NA_ATOMIC_REFCOUNT == 2
+    return na_LoadRefCountAtomic(refCount);
+  #elif NA_ATOMIC_REFCOUNT == 1
+    return na_LoadRefCountAtomic(refCount) & ~NA_REFCOUNT_ATOMIC_FLAG;
+  #else
+    return refCount->count;
+  #endif
 }
 
 
@@ -50,8 +107,18 @@ NA_IDEF NARefCount* naInitRefCount(NARefCount* refCount){
 
 
 
+NA_IDEF NARefCount* naInitRefCountAtomic(NARefCount* refCount){
+  naInitRefCount(refCount);
+  #if NA_ATOMIC_REFCOUNT == 1
+    refCount->count |= NA_REFCOUNT_ATOMIC_FLAG;
+  #endif
+  return refCount;
+}
+
+
+
 NA_IDEF NABool naIsRefCountZero(NARefCount* refCount){
-  return refCount->count == 0;
+  return na_GetRefCountCount(refCount) == 0;
 }
 
 
@@ -67,19 +134,35 @@ NA_IDEF NARefCount* naRetainRefCount(NARefCount* refCount){
       // The next test can detect some erroneous behaviour in the code. Note
       // however that most likely the true cause of the error did occur long
       // before reaching here.
-      if(refCount->count == NA_ZERO)
+      if(na_GetRefCountCount(refCount) == NA_ZERO)
         naError("Retaining NARefCount with a count of 0");
-      if(refCount->count == NA_MAX_s)
+      if(na_GetRefCountCount(refCount) == NA_MAX_s)
         naError("Reference count overflow");
     }
   #endif
-  refCount->count++;
+
+  #if NA_ATOMIC_REFCOUNT == 2
+    na_IncRefCountAtomic(refCount);
+  #elif NA_ATOMIC_REFCOUNT == 1
+    if(na_LoadRefCountAtomic(refCount) & NA_REFCOUNT_ATOMIC_FLAG){
+      na_IncRefCountAtomic(refCount);
+    }else{
+      refCount->count++;
+    }
+  #else
+    refCount->count++;
+  #endif
+
   return refCount;
 }
 
 
 
-NA_IDEF void naReleaseRefCount(NARefCount* refCount, void* data, NAMutator destructor){
+// Decreases the count and returns NA_TRUE if the count reached zero. In that
+// case, the destructor has been called. Only the one thread reaching zero
+// gets NA_TRUE, hence the caller can safely free the memory of the object.
+NA_HIDEF NABool na_ReleaseRefCount(NARefCount* refCount, void* data, NAMutator destructor){
+  size_t newCount;
   #if NA_DEBUG
     if(!refCount)
       naCrash("refCount is Null-Pointer.");
@@ -88,20 +171,34 @@ NA_IDEF void naReleaseRefCount(NARefCount* refCount, void* data, NAMutator destr
     // The next test can detect some erroneous behaviour in the code. Note
     // however that most likely the true cause of the error did occur long
     // before reaching here.
-    if(refCount->count == NA_ZERO)
+    if(na_GetRefCountCount(refCount) == NA_ZERO)
       naError("Releasing NARefCount with a count of 0");
   #endif
+
   // Note that the author decided to always count to zero, even if it is clear
   // that the pointer will eventually be freed and the data will be lost in
   // nirvana. But often times in debugging, when retaining and releasing is not
   // done correctly, an NARefCount is released too often. When refCount is 0
   // and NA_DEBUG is 1, this can be detected!
-  refCount->count--;
+  #if NA_ATOMIC_REFCOUNT == 2
+    newCount = na_DecRefCountAtomic(refCount);
+  #elif NA_ATOMIC_REFCOUNT == 1
+    if(na_LoadRefCountAtomic(refCount) & NA_REFCOUNT_ATOMIC_FLAG){
+      newCount = na_DecRefCountAtomic(refCount) & ~NA_REFCOUNT_ATOMIC_FLAG;
+    }else{
+      newCount = --refCount->count;
+    }
+  #else
+    newCount = --refCount->count;
+  #endif
 
-  if(refCount->count == NA_ZERO){
+  if(newCount == NA_ZERO){
     // Call the destructor on the data if available.
     if(destructor){destructor(data);}
+    return NA_TRUE;
   }
+  return NA_FALSE;
+
   // Note that other programming languages have incorporated this very idea
   // of self-organized reference-counting pointers deeply within its core.
   // Their runtime-systems keep giant pools of free objects at hand and take
@@ -112,6 +209,12 @@ NA_IDEF void naReleaseRefCount(NARefCount* refCount, void* data, NAMutator destr
 
 
 
+NA_IDEF void naReleaseRefCount(NARefCount* refCount, void* data, NAMutator destructor){
+  na_ReleaseRefCount(refCount, data, destructor);
+}
+
+
+
 // This is free and unencumbered software released into the public domain.
 
 // Anyone is free to copy, modify, publish, use, compile, sell, or
@@ -1,10 +1,21 @@
 
 #include "../../NAMemory.h"
 #include "../../NABinaryData.h"
+#if NA_MEMORY_POOL_THREAD_SAFE
+  #include "../../NAThreading.h"
+  #include "../../NAAtomic.h"
+#endif
 
 #if NA_DEBUG
   #include "stdio.h"
 #endif
+#if NA_MEMORY_POOL_RESERVE_BYTESIZE != 0 && NA_OS != NA_OS_WINDOWS
+  #include <sys/mman.h>
+#endif
+#if NA_MEMORY_TRACE
+  // naMallocTmp is defined in this file. See NAMemoryTraceII.h
+  #undef naMallocTmp
+#endif
 
 // //////////////////////////////////////
 // Implementation notes from the author about the Memory Pools.
@@ -77,26 +88,73 @@
 //
 // Upon deleting spaces, a part may become completely empty. If that is the
 // case, the part gets automatically deallocated, hence freeing all of the
-// memory.
+// memory. Well, almost: A few empty parts are kept as spare parts which any
+// type can reuse. See NA_MEMORY_POOL_SPARE_PART_COUNT.
+
+// /////////////
+// Reserved address ranges:
+//
+// When NA_MEMORY_POOL_RESERVE_BYTESIZE is non-zero, the parts are not
+// allocated with naMallocAligned but carved out of large address ranges
+// reserved directly from the system. An NA_PoolReserve stores such a range
+// and how far it has been carved already. As the ranges are aligned, every
+// part is aligned too and the address mask works just the same.
+//
+// Parts which are given back are not returned to any heap. Instead, the
+// system is told that their memory is no longer needed and their addresses
+// are stored in the releasedParts array of the runtime. The next part needed
+// takes one of these addresses before carving a new one. Note that the
+// address is not stored in the part itself as writing to it would bring back
+// the memory the system just took.
+
+// /////////////
+// Thread-safe pools:
+//
+// When NA_MEMORY_POOL_THREAD_SAFE is set to 1, the curPart field of the
+// NA_TypeInfo is not used. Instead, every thread owns an NA_ThreadPool which
+// stores one curPart for every registered type. Hence every thread has its
+// own circular list of parts per type and all of the above works exactly the
+// same without any locking as long as a pointer is deleted on the same thread
+// which allocated it.
+//
+// Each part knows the thread pool it belongs to. If a pointer is deleted on a
+// foreign thread, the space is not put into the firstUnused list but pushed
+// onto a second list called remoteUnused with an atomic compare-and-swap.
+// The owning thread collects these spaces as soon as it runs out of space in
+// its parts, just before it would need to create a new part.
+//
+// A thread which no longer needs the runtime can detach from it. Its thread
+// pool then gets marked as abandoned and will be adopted by the next thread
+// needing a pool. Only registering types and adopting thread pools requires
+// a mutex.
 
 // /////////////
 // Garbage collection:
 //
 // NALib also has a small garbage collection mechanism: If you just need a
 // temporary pointer which shall automatically be freed, use naMallocTmp.
-// This will return a pointer which is also stored in a garbage pool. That
-// pool is a simple, single-linked list of memory blocks the same size as
-// the memory blocks above, but simply storing arrays of temporarily allocated
-// pointers.
+// This will return a pointer from an NAArena with blocks the same size as
+// the memory blocks above. Hence, temporary memory costs little more than
+// moving a pointer forward. In thread-safe mode, every NA_ThreadPool has its
+// own arena, so no locking is needed.
 //
 // When you call naCollectGarbage or if you stop the Runtime, that memory
 // will be completely erased.
 
 
 
+// The number of addresses an NA_PoolPart occupies. When the pools are thread
+// safe, the fields written by foreign threads are placed in the second half
+// such that they do not share a cache line with the fields of the owner.
+#if NA_MEMORY_POOL_THREAD_SAFE
+  #define NA_POOLPART_ADDRESS_COUNT 16
+#else
+  #define NA_POOLPART_ADDRESS_COUNT 8
+#endif
+
 // This structure is stored in the first bytes of every part block.
-// Its size is ALWAYS 8 times an addressSize, the rest of the block is
-// available for the memory.
+// Its size is ALWAYS NA_POOLPART_ADDRESS_COUNT times an addressSize, the rest
+// of the block is available for the memory.
 typedef struct NA_PoolPart NA_PoolPart;
 struct NA_PoolPart{
   NA_TypeInfo* typeInfo;
@@ -112,6 +170,11 @@ struct NA_PoolPart{
   // It is used in debugging though. Points at first byte of the whole pool
   // for consistency check.
   void* dummy;
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    NA_ThreadPool* threadPool;  // The pool of the owning thread.
+    NAAtomicPtr remoteUnused;   // Spaces deleted by foreign threads.
+    void* padding[6];
+  #endif
 };
 
 struct NA_TypeInfo{
@@ -119,22 +182,62 @@ struct NA_TypeInfo{
   size_t            typeSize;
   NAMutator         destructor;
   NABool            refCounting;
-  #if NA_DEBUG
-    const char*     typeName;
-  #endif
+  NABool            atomicRefCount;
+  size_t            poolIndex;
+  size_t            partCount;
+  size_t            maxPartCount;
+  const char*       typeName;
 };
 
 
 
-// The number of entries in a garbage pointer list part.  The 2 denotes the
-// first two entries of the NAMallocGarbage struct.
-#define NA_MALLOC_GARBAGE_POINTER_COUNT (NA_POOLPART_BYTESIZE / NA_ADDRESS_BYTES - 2)
+#if NA_MEMORY_POOL_RESERVE_BYTESIZE != 0
+  // An address range reserved from the system. Parts are carved out of it
+  // starting at firstPart.
+  typedef struct NA_PoolReserve NA_PoolReserve;
+  struct NA_PoolReserve{
+    void* base;                 // The address as returned by the system.
+    size_t byteSize;            // The byteSize as reserved with the system.
+    NAByte* firstUncarved;
+    NAByte* end;
+    NA_PoolReserve* next;
+  };
 
-struct NAMallocGarbage{
-  NAMallocGarbage* next;
-  size_t cur;
-  void* pointers[NA_MALLOC_GARBAGE_POINTER_COUNT];
-};
+  // The alignment of the reserved ranges when huge pages are used.
+  #define NA_POOL_HUGE_PAGE_BYTESIZE ((size_t)1 << 21)
+#endif
+
+
+
+#if NA_MEMORY_POOL_THREAD_SAFE
+  // The number of objects of one type alive in the parts of one thread pool.
+  // Only the owning thread changes it but other threads read it for the
+  // runtime statistics.
+  #if defined NA_TYPE_INT64
+    typedef NAAtomic64 NA_PoolObjectCount;
+  #else
+    typedef NAAtomic32 NA_PoolObjectCount;
+  #endif
+
+  // Every thread using the runtime system owns one NA_ThreadPool. It stores
+  // the current part of every registered type, indexed by the poolIndex of
+  // the type. Index 0 is never used as it denotes an unregistered type.
+  struct NA_ThreadPool{
+    NA_PoolPart** curParts;
+    NA_PoolObjectCount* objectCounts; // Indexed like curParts.
+    size_t curPartCount;
+    NABool abandoned;
+    NA_ThreadPool* next;
+    NAArena tmpArena;           // The memory of naMallocTmp of the thread.
+  };
+
+  // The pool of the current thread. As the runtime might have been stopped
+  // and restarted since this thread last used it, the pool is only valid if
+  // the generation matches the one of the running runtime.
+  static NA_THREAD_LOCAL NA_ThreadPool* na_ThreadPool = NA_NULL;
+  static NA_THREAD_LOCAL size_t na_ThreadPoolGeneration = 0;
+  static size_t na_RuntimeGeneration = 0;
+#endif
 
 
 
@@ -146,7 +249,7 @@ NARuntime* na_Runtime = NA_NULL;
 // Security check: The pool byteSize must be big enough to store one struct
 // of NA_PoolPart. Note that byteSize 0 has the meaning of using the
 // memory page size.
-#if (NA_POOLPART_BYTESIZE != 0) && (NA_POOLPART_BYTESIZE <= 8 * NA_ADDRESS_BYTES)
+#if (NA_POOLPART_BYTESIZE != 0) && (NA_POOLPART_BYTESIZE <= NA_POOLPART_ADDRESS_COUNT * NA_ADDRESS_BYTES)
   #error "Memory pool size is too small"
 #endif
 
@@ -189,6 +292,16 @@ NA_HIDEF void na_RegisterTypeInfo(NA_TypeInfo* typeInfo){
   // We cleanup the old infos and set the new ones to be valid.
   naFree(na_Runtime->typeInfos);
   na_Runtime->typeInfos = newinfos;
+
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    // Types are never unregistered while the runtime is running in
+    // thread-safe mode, hence the count is a unique index starting at 1.
+    #if NA_ATOMIC_GCC
+      __atomic_store_n(&(typeInfo->poolIndex), na_Runtime->typeInfoCount, __ATOMIC_RELAXED);
+    #else
+      *((volatile size_t*)&(typeInfo->poolIndex)) = na_Runtime->typeInfoCount;
+    #endif
+  #endif
 }
 
 
@@ -218,15 +331,168 @@ NA_HIDEF void na_UnregisterTypeInfo(NA_TypeInfo* typeInfo){
   // We restore the original typeSize in case NA_MEMORY_POOL_AGGRESSIVE_CLEANUP
   // is set to 1 which means, the type might get re-registered.
   if(typeInfo->refCounting){typeInfo->typeSize -= sizeof(NARefCount);}
+  typeInfo->poolIndex = 0;
 }
 
 
 
-NA_HDEF size_t na_GetTypeInfoAllocatedCount(NA_TypeInfo* typeInfo){
-  NA_PoolPart* firstpart = typeInfo->curPart;
-  NA_PoolPart* curPart = firstpart->nextPart;
-  size_t totalCount = firstpart->usedCount;
-  while(curPart != firstpart){
+#if NA_MEMORY_POOL_THREAD_SAFE
+
+  // Returns the pool of the current thread or Null if this thread has no
+  // pool in the currently running runtime.
+  NA_HIDEF NA_ThreadPool* na_GetCurrentThreadPool(){
+    return (na_ThreadPoolGeneration == na_RuntimeGeneration) ? na_ThreadPool : NA_NULL;
+  }
+
+
+
+  // Returns either an abandoned thread pool or a new one. Expects the mutex
+  // of the runtime to be locked.
+  NA_HIDEF NA_ThreadPool* na_AdoptThreadPool(){
+    NA_ThreadPool* threadPool = na_Runtime->threadPools;
+    while(threadPool){
+      if(threadPool->abandoned){
+        threadPool->abandoned = NA_FALSE;
+        return threadPool;
+      }
+      threadPool = threadPool->next;
+    }
+
+    threadPool = naAlloc(NA_ThreadPool);
+    threadPool->curParts = NA_NULL;
+    threadPool->objectCounts = NA_NULL;
+    threadPool->curPartCount = 0;
+    threadPool->abandoned = NA_FALSE;
+    naInitArena(&(threadPool->tmpArena), na_Runtime->partSize);
+    threadPool->next = na_Runtime->threadPools;
+    na_Runtime->threadPools = threadPool;
+    return threadPool;
+  }
+
+
+
+  // Returns the poolIndex of the given type. The index may be written by
+  // another thread registering the type at the same time. If so, 0 will be
+  // returned and the caller will go the slow path guarded by the mutex.
+  // The field is a plain size_t as it is part of the public NATypeInfo. Other
+  // than with the builtins of GCC and Clang, it is accessed as volatile which
+  // is indivisible for an aligned size_t on all supported platforms.
+  NA_HIDEF size_t na_GetTypeInfoPoolIndex(const NA_TypeInfo* typeInfo){
+    #if NA_ATOMIC_GCC
+      return __atomic_load_n(&(typeInfo->poolIndex), __ATOMIC_RELAXED);
+    #else
+      return *((volatile const size_t*)&(typeInfo->poolIndex));
+    #endif
+  }
+
+
+
+  // Adds value to the count of objects of the part type in the pool owning
+  // the part. As only the owning thread writes the count, a relaxed load and
+  // store is enough.
+  NA_HIDEF void na_AddPoolObjectCount(const NA_PoolPart* part, NAInt value){
+    NA_PoolObjectCount* objectCount = &(part->threadPool->objectCounts[part->typeInfo->poolIndex]);
+    #if defined NA_TYPE_INT64
+      naStoreAtomic64(objectCount, naLoadAtomic64(objectCount, NA_MEMORY_ORDER_RELAXED) + value, NA_MEMORY_ORDER_RELAXED);
+    #else
+      naStoreAtomic32(objectCount, naLoadAtomic32(objectCount, NA_MEMORY_ORDER_RELAXED) + (int32)value, NA_MEMORY_ORDER_RELAXED);
+    #endif
+  }
+
+
+
+  NA_HIDEF size_t na_GetPoolObjectCount(const NA_PoolObjectCount* objectCount){
+    #if defined NA_TYPE_INT64
+      return (size_t)naLoadAtomic64(objectCount, NA_MEMORY_ORDER_RELAXED);
+    #else
+      return (size_t)naLoadAtomic32(objectCount, NA_MEMORY_ORDER_RELAXED);
+    #endif
+  }
+
+
+
+  // Returns true if the current thread has a pool with a current part for
+  // the given type. This is the fast check done for every allocation. Any
+  // thread sees a type for the first time by locking the mutex in
+  // na_PrepareThreadPool, hence all fields of the type are up to date.
+  NA_HIDEF NABool na_IsThreadPoolReady(const NA_TypeInfo* typeInfo){
+    size_t poolIndex;
+    return (na_ThreadPoolGeneration == na_RuntimeGeneration)
+      && (poolIndex = na_GetTypeInfoPoolIndex(typeInfo))
+      && (poolIndex < na_ThreadPool->curPartCount)
+      && na_ThreadPool->curParts[poolIndex];
+  }
+
+
+
+  // Makes sure the given type is registered and the current thread has a pool
+  // with a slot for that type.
+  NA_HDEF void na_PrepareThreadPool(NA_TypeInfo* typeInfo){
+    naLockMutex(na_Runtime->mutex);
+
+    if(na_ThreadPoolGeneration != na_RuntimeGeneration){
+      na_ThreadPool = na_AdoptThreadPool();
+      na_ThreadPoolGeneration = na_RuntimeGeneration;
+    }
+
+    // As this is the first time any thread uses this type, we register it.
+    if(!typeInfo->poolIndex){
+      na_RegisterTypeInfo(typeInfo);
+    }
+
+    // We enlarge the slots of the thread pool to hold all registered types.
+    if(typeInfo->poolIndex >= na_ThreadPool->curPartCount){
+      size_t newCount = na_Runtime->typeInfoCount + NA_ONE_s;
+      NA_PoolPart** newParts = naMalloc(sizeof(NA_PoolPart*) * newCount);
+      NA_PoolObjectCount* newObjectCounts = naMalloc(sizeof(NA_PoolObjectCount) * newCount);
+      if(na_ThreadPool->curParts){
+        naCopyn(newParts, na_ThreadPool->curParts, sizeof(NA_PoolPart*) * na_ThreadPool->curPartCount);
+        naCopyn(newObjectCounts, na_ThreadPool->objectCounts, sizeof(NA_PoolObjectCount) * na_ThreadPool->curPartCount);
+      }
+      naZeron(&(newParts[na_ThreadPool->curPartCount]), sizeof(NA_PoolPart*) * (newCount - na_ThreadPool->curPartCount));
+      naZeron(&(newObjectCounts[na_ThreadPool->curPartCount]), sizeof(NA_PoolObjectCount) * (newCount - na_ThreadPool->curPartCount));
+      naFree(na_ThreadPool->curParts);
+      naFree(na_ThreadPool->objectCounts);
+      na_ThreadPool->curParts = newParts;
+      na_ThreadPool->objectCounts = newObjectCounts;
+      na_ThreadPool->curPartCount = newCount;
+    }
+
+    naUnlockMutex(na_Runtime->mutex);
+  }
+
+#endif
+
+
+
+// Returns a pointer to the field storing the current part of the given type.
+// In thread-safe mode, that is the field of the current thread.
+NA_HIDEF NA_PoolPart** na_GetCurPoolPartRef(NA_TypeInfo* typeInfo){
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    return &(na_ThreadPool->curParts[typeInfo->poolIndex]);
+  #else
+    return &(typeInfo->curPart);
+  #endif
+}
+
+
+
+// Returns the address where the pointer to the next unused space is stored
+// within an unused space. See na_EjectPoolPartObject for an explanation.
+NA_HIDEF void** na_GetPoolPartObjectLink(const NA_TypeInfo* typeInfo, void* pointer){
+  if(typeInfo->refCounting){
+    return (void**)((NAByte*)pointer + sizeof(NARefCount));
+  }else{
+    return (void**)pointer;
+  }
+}
+
+
+
+NA_HIDEF size_t na_GetPoolPartListAllocatedCount(NA_PoolPart* firstPart){
+  NA_PoolPart* curPart = firstPart->nextPart;
+  size_t totalCount = firstPart->usedCount;
+  while(curPart != firstPart){
     totalCount += curPart->usedCount;
     curPart = curPart->nextPart;
   }
@@ -235,27 +501,274 @@ NA_HDEF size_t na_GetTypeInfoAllocatedCount(NA_TypeInfo* typeInfo){
 
 
 
+NA_HDEF size_t na_GetTypeInfoAllocatedCount(NA_TypeInfo* typeInfo){
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    size_t totalCount = 0;
+    NA_ThreadPool* threadPool = na_Runtime->threadPools;
+    while(threadPool){
+      if(typeInfo->poolIndex < threadPool->curPartCount && threadPool->curParts[typeInfo->poolIndex]){
+        totalCount += na_GetPoolPartListAllocatedCount(threadPool->curParts[typeInfo->poolIndex]);
+      }
+      threadPool = threadPool->next;
+    }
+    return totalCount;
+  #else
+    return typeInfo->curPart ? na_GetPoolPartListAllocatedCount(typeInfo->curPart) : 0;
+  #endif
+}
+
+
+
 NA_HIDEF NABool na_IsPoolPartFull(NA_PoolPart* part){
   return (part->usedCount == part->maxCount);
 }
 
 
 
-NA_HIDEF void na_AttachPoolPartAfterCurPoolPart(NA_TypeInfo* typeInfo, NA_PoolPart* part){
-  part->prevPart = typeInfo->curPart;
-  part->nextPart = typeInfo->curPart->nextPart;
+NA_HIDEF void na_AttachPoolPartAfterCurPoolPart(NA_PoolPart* curPart, NA_PoolPart* part){
+  part->prevPart = curPart;
+  part->nextPart = curPart->nextPart;
   part->prevPart->nextPart = part;
   part->nextPart->prevPart = part;
 }
 
+#if NA_MEMORY_POOL_RESERVE_BYTESIZE != 0
+
+  // Reserves a new address range from the system and adds it to the runtime.
+  NA_HIDEF NA_PoolReserve* na_AddPoolReserve(){
+    size_t align = na_Runtime->partSize;
+    #if NA_MEMORY_POOL_HUGE_PAGES && defined MADV_HUGEPAGE
+      if(align < NA_POOL_HUGE_PAGE_BYTESIZE){align = NA_POOL_HUGE_PAGE_BYTESIZE;}
+    #endif
+
+    // The usable size is a multiple of the part size. We reserve one
+    // alignment more to be able to align the start.
+    size_t usableSize = (((size_t)NA_MEMORY_POOL_RESERVE_BYTESIZE + na_Runtime->partSize - NA_ONE_s) & na_Runtime->partSizeMask);
+    if(!usableSize){usableSize = na_Runtime->partSize;}
+
+    NA_PoolReserve* reserve = naAlloc(NA_PoolReserve);
+    reserve->byteSize = usableSize + align;
+
+    #if NA_OS == NA_OS_WINDOWS
+      reserve->base = VirtualAlloc(NA_NULL, reserve->byteSize, MEM_RESERVE, PAGE_READWRITE);
+      if(!reserve->base){
+        #if NA_DEBUG
+          naCrash("Could not reserve address range");
+        #endif
+        naFree(reserve);
+        return NA_NULL;
+      }
+    #else
+      int flags = MAP_PRIVATE | MAP_ANON;
+      #ifdef MAP_NORESERVE
+        flags |= MAP_NORESERVE;
+      #endif
+      reserve->base = mmap(NA_NULL, reserve->byteSize, PROT_READ | PROT_WRITE, flags, -1, 0);
+      if(reserve->base == MAP_FAILED){
+        #if NA_DEBUG
+          naCrash("Could not reserve address range");
+        #endif
+        naFree(reserve);
+        return NA_NULL;
+      }
+    #endif
+
+    reserve->firstUncarved = (NAByte*)(((size_t)reserve->base + align - NA_ONE_s) & ~(align - NA_ONE_s));
+    reserve->end = reserve->firstUncarved + usableSize;
+
+    #if NA_OS != NA_OS_WINDOWS
+      // Posix allows to unmap parts of a mapping. Hence we give back the bytes
+      // before and after the aligned range right away.
+      size_t headSize = (size_t)(reserve->firstUncarved - (NAByte*)reserve->base);
+      size_t tailSize = reserve->byteSize - headSize - usableSize;
+      if(headSize){munmap(reserve->base, headSize);}
+      if(tailSize){munmap(reserve->end, tailSize);}
+      reserve->base = reserve->firstUncarved;
+      reserve->byteSize = usableSize;
+
+      #if NA_MEMORY_POOL_HUGE_PAGES && defined MADV_HUGEPAGE
+        madvise(reserve->base, reserve->byteSize, MADV_HUGEPAGE);
+      #endif
+    #endif
+
+    reserve->next = na_Runtime->poolReserves;
+    na_Runtime->poolReserves = reserve;
+    return reserve;
+  }
+
+
+
+  // Returns the memory of a part, either one which has been released before
+  // or a newly carved one. In thread-safe mode, the mutex must be locked.
+  NA_HIDEF NA_PoolPart* na_AllocPoolPartMemory(){
+    NAByte* part;
+    if(na_Runtime->releasedPartCount){
+      na_Runtime->releasedPartCount--;
+      part = na_Runtime->releasedParts[na_Runtime->releasedPartCount];
+    }else{
+      NA_PoolReserve* reserve = na_Runtime->poolReserves;
+      if(!reserve || reserve->firstUncarved == reserve->end){
+        reserve = na_AddPoolReserve();
+        if(!reserve){return NA_NULL;}
+      }
+      part = reserve->firstUncarved;
+      reserve->firstUncarved += na_Runtime->partSize;
+    }
+
+    #if NA_OS == NA_OS_WINDOWS
+      // On windows, the memory must be committed before it can be used.
+      VirtualAlloc(part, na_Runtime->partSize, MEM_COMMIT, PAGE_READWRITE);
+    #endif
+
+    return (NA_PoolPart*)part;
+  }
+
+
+
+  // Gives the memory of the part back to the system but keeps its address.
+  // In thread-safe mode, the mutex must be locked.
+  NA_HIDEF void na_FreePoolPartMemory(NA_PoolPart* part){
+    #if NA_OS == NA_OS_WINDOWS
+      VirtualFree(part, na_Runtime->partSize, MEM_DECOMMIT);
+    #else
+      madvise(part, na_Runtime->partSize, MADV_DONTNEED);
+    #endif
+
+    if(na_Runtime->releasedPartCount == na_Runtime->releasedPartCapacity){
+      size_t newCapacity = na_Runtime->releasedPartCapacity ? 2 * na_Runtime->releasedPartCapacity : 64;
+      void** newParts = naMalloc(sizeof(void*) * newCapacity);
+      if(na_Runtime->releasedParts){
+        naCopyn(newParts, na_Runtime->releasedParts, sizeof(void*) * na_Runtime->releasedPartCount);
+      }
+      naFree(na_Runtime->releasedParts);
+      na_Runtime->releasedParts = newParts;
+      na_Runtime->releasedPartCapacity = newCapacity;
+    }
+    na_Runtime->releasedParts[na_Runtime->releasedPartCount] = part;
+    na_Runtime->releasedPartCount++;
+  }
+
+
+
+  // Returns all reserved address ranges to the system.
+  NA_HIDEF void na_FreePoolReserves(){
+    while(na_Runtime->poolReserves){
+      NA_PoolReserve* reserve = na_Runtime->poolReserves;
+      na_Runtime->poolReserves = reserve->next;
+      #if NA_OS == NA_OS_WINDOWS
+        VirtualFree(reserve->base, 0, MEM_RELEASE);
+      #else
+        munmap(reserve->base, reserve->byteSize);
+      #endif
+      naFree(reserve);
+    }
+    naFree(na_Runtime->releasedParts);
+    na_Runtime->releasedParts = NA_NULL;
+    na_Runtime->releasedPartCount = 0;
+    na_Runtime->releasedPartCapacity = 0;
+  }
+
+#else
+
+  NA_HIDEF NA_PoolPart* na_AllocPoolPartMemory(){
+    return (NA_PoolPart*)naMallocAligned(na_Runtime->partSize, na_Runtime->partSize);
+  }
+
+  NA_HIDEF void na_FreePoolPartMemory(NA_PoolPart* part){
+    naFreeAligned(part);
+  }
+
+#endif
+
+
+
+// Returns the memory for a new part of the given type. Empty parts which had
+// been kept as spare parts are reused first. Parts are created and freed
+// rarely, hence locking the mutex in thread-safe mode does not harm. The
+// number of parts is counted for the runtime statistics. Returns Null if
+// there is no memory left.
+NA_HIDEF NA_PoolPart* na_AllocPoolPart(NA_TypeInfo* typeInfo){
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    naLockMutex(na_Runtime->mutex);
+  #endif
+
+  NA_PoolPart* part = na_Runtime->spareParts;
+  if(part){
+    na_Runtime->spareParts = part->nextPart;
+    na_Runtime->sparePartCount--;
+  }else{
+    // We create a new part with the size of a full part but we type it as
+    // NA_PoolPart to access the first bytes.
+    part = na_AllocPoolPartMemory();
+    #if NA_DEBUG
+      if(!part)
+        naError("Out of memory. No pool part could be allocated.");
+    #endif
+  }
+
+  if(part){
+    typeInfo->partCount++;
+    if(typeInfo->partCount > typeInfo->maxPartCount){
+      typeInfo->maxPartCount = typeInfo->partCount;
+    }
+  }
+
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    naUnlockMutex(na_Runtime->mutex);
+  #endif
+
+  return part;
+}
+
+
+
+// Gives back the memory of an empty part. The part is kept as a spare part
+// if there are less than NA_MEMORY_POOL_SPARE_PART_COUNT spare parts.
+// Otherwise, it is freed.
+NA_HIDEF void na_FreePoolPart(NA_PoolPart* part){
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    naLockMutex(na_Runtime->mutex);
+  #endif
+
+  part->typeInfo->partCount--;
+
+  #if NA_MEMORY_POOL_SPARE_PART_COUNT > 0
+    if(na_Runtime->sparePartCount < NA_MEMORY_POOL_SPARE_PART_COUNT){
+      part->nextPart = na_Runtime->spareParts;
+      na_Runtime->spareParts = part;
+      na_Runtime->sparePartCount++;
+    }else{
+      na_FreePoolPartMemory(part);
+    }
+  #else
+    na_FreePoolPartMemory(part);
+  #endif
+
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    naUnlockMutex(na_Runtime->mutex);
+  #endif
+}
+
+
+
+// Frees all spare parts. In thread-safe mode, the mutex must be locked.
+NA_HIDEF void na_FreeSpareParts(){
+  while(na_Runtime->spareParts){
+    NA_PoolPart* part = na_Runtime->spareParts;
+    na_Runtime->spareParts = part->nextPart;
+    na_FreePoolPartMemory(part);
+  }
+  na_Runtime->sparePartCount = 0;
+}
+
+
+
 // This function gets called when no part has any more space.
 // A new part is created and added to the list at the current position.
-NA_HIDEF void na_EnhancePool(NA_TypeInfo* typeInfo){
-  NA_PoolPart* part;
-
-  // We create a new part with the size of a full part but we type it as
-  // NA_PoolPart to access the first bytes.
-  part = (NA_PoolPart*)naMallocAligned(na_Runtime->partSize, na_Runtime->partSize);
+// Returns NA_FALSE if there is no memory left for a new part.
+NA_HIDEF NABool na_EnhancePool(NA_TypeInfo* typeInfo, NA_PoolPart** curPart){
+  NA_PoolPart* part = na_AllocPoolPart(typeInfo);
+  if(!part){return NA_FALSE;}
   #if NA_DEBUG
     // Do you think the following check is not necessary? You'd be surprised
     // how many systems do not align memory correctly!
@@ -285,80 +798,202 @@ NA_HIDEF void na_EnhancePool(NA_TypeInfo* typeInfo){
     part->dummy = part;
   #endif
 
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    part->threadPool = na_ThreadPool;
+    naInitAtomicPtr(&(part->remoteUnused), NA_NULL);
+  #endif
+
   // Add the new part after the current part or set the part as the first and
   // only part, if there is none available yet.
-  if(typeInfo->curPart){
-    na_AttachPoolPartAfterCurPoolPart(typeInfo, part);
+  if(*curPart){
+    na_AttachPoolPartAfterCurPoolPart(*curPart, part);
   }else{
     part->prevPart = part;
     part->nextPart = part;
   }
 
   // Set the newly created part to be the current part.
-  typeInfo->curPart = part;
+  *curPart = part;
+  return NA_TRUE;
 }
 
 
 
-NA_DEF void* na_NewStructInternal(NATypeInfo* info){
-  #if NA_DEBUG
-    if(!naIsRuntimeRunning())
-      naCrash("Runtime not running. Use naStartRuntime()");
-    if(!info)
-      naCrash("Given type identifier is Null-Pointer. Do not call na_NewStruct directly. Use the naNew macro.");
-    if(info->typeSize == 0)
-      naError("Type size is zero. Is the type void?");
+#if NA_MEMORY_POOL_THREAD_SAFE
+
+  // Moves all spaces deleted by foreign threads back into the list of unused
+  // spaces of the part. Must only be called by the owning thread or when no
+  // other thread uses the runtime. Returns NA_TRUE if any space was collected.
+  NA_HIDEF NABool na_CollectRemotePoolPartObjects(NA_PoolPart* part){
+    void* firstRemote = naExchangeAtomicPtr(&(part->remoteUnused), NA_NULL, NA_MEMORY_ORDER_ACQUIRE);
+    if(!firstRemote){return NA_FALSE;}
+
+    // The remote list ends with Null. We search its last entry and count
+    // the spaces on the way.
+    size_t remoteCount = 1;
+    void** link = na_GetPoolPartObjectLink(part->typeInfo, firstRemote);
+    while(*link){
+      link = na_GetPoolPartObjectLink(part->typeInfo, *link);
+      remoteCount++;
+    }
+
+    // The remote list is prepended to the list of unused spaces.
+    *link = part->firstUnused;
+    part->firstUnused = firstRemote;
+    part->usedCount -= remoteCount;
+    na_AddPoolObjectCount(part, -(NAInt)remoteCount);
+    return NA_TRUE;
+  }
+
+
+
+  // Goes through all parts of the current thread for the type of curPart and
+  // collects the spaces deleted by foreign threads. Every part which gained
+  // space is moved right after the current part.
+  NA_HIDEF void na_CollectRemotePoolObjects(NA_PoolPart** curPart){
+    NA_PoolPart* firstPart = *curPart;
+    NA_PoolPart* part = firstPart;
+    do{
+      NA_PoolPart* nextPart = part->nextPart;
+      if(na_CollectRemotePoolPartObjects(part) && part != firstPart){
+        part->nextPart->prevPart = part->prevPart;
+        part->prevPart->nextPart = part->nextPart;
+        na_AttachPoolPartAfterCurPoolPart(firstPart, part);
+      }
+      part = nextPart;
+    }while(part != firstPart);
+
+    if(na_IsPoolPartFull(*curPart)){
+      *curPart = (*curPart)->nextPart;
+    }
+  }
+
+
+
+  // Puts the given list of spaces onto the remoteUnused list of the part.
+  // The spaces from firstPointer up to the one owning lastLink are expected
+  // to be linked already. This is the only function which is called for a
+  // part by threads not owning it.
+  NA_HIDEF void na_PushRemotePoolPartObjects(NA_PoolPart* part, void* firstPointer, void** lastLink){
+    void* remoteUnused = NA_NULL;
+    do{
+      *lastLink = remoteUnused;
+    }while(!naCompareExchangeAtomicPtr(&(part->remoteUnused), &remoteUnused, firstPointer, NA_MEMORY_ORDER_RELEASE));
+  }
+
+#endif
+
+
+
+// Returns the current part of the given type and makes sure it has at least
+// one unused space, registering the type or creating a new part if needed.
+// Returns Null if there is no memory left for a new part.
+NA_HIDEF NA_PoolPart* na_GetPoolPartWithSpace(NA_TypeInfo* typeInfo){
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    // Make sure, the type is registered and the current thread has a slot
+    // for it. This is also called whenever the thread has no part yet.
+    if(!na_IsThreadPoolReady(typeInfo)){
+      na_PrepareThreadPool(typeInfo);
+    }
   #endif
 
-  NA_TypeInfo* typeInfo = (NA_TypeInfo*)info;
+  NA_PoolPart** curPart = na_GetCurPoolPartRef(typeInfo);
 
   // If there is no current part, create a first one.
   // This happends either upon first naNew of this type ever or when aggressive
   // memory cleanup is activated. See Configuration.h
-  if(!typeInfo->curPart){
-    // As this is the first one, we register the type to the runtime system.
-    na_RegisterTypeInfo(typeInfo);
-    na_EnhancePool(typeInfo);
-    #if NA_DEBUG
-      if(!typeInfo->curPart)
-        naCrash("No part available even after enhancing.");
+  if(!*curPart){
+    #if !NA_MEMORY_POOL_THREAD_SAFE
+      // As this is the first one, we register the type to the runtime system.
+      na_RegisterTypeInfo(typeInfo);
     #endif
+    if(!na_EnhancePool(typeInfo, curPart)){
+      #if !NA_MEMORY_POOL_THREAD_SAFE
+        na_UnregisterTypeInfo(typeInfo);
+      #endif
+      return NA_NULL;
+    }
   }
 
   // If the current part is full, we try the next in the part list.
-  if(na_IsPoolPartFull(typeInfo->curPart)){
-    typeInfo->curPart = typeInfo->curPart->nextPart;
+  if(na_IsPoolPartFull(*curPart)){
+    *curPart = (*curPart)->nextPart;
     // If the next in the part list is full too, no part in the list has any
     // space left and hence we must create a new part.
-    if(na_IsPoolPartFull(typeInfo->curPart)){na_EnhancePool(typeInfo);}
+    if(na_IsPoolPartFull(*curPart)){
+      #if NA_MEMORY_POOL_THREAD_SAFE
+        // But first, we look for spaces deleted by other threads.
+        na_CollectRemotePoolObjects(curPart);
+        if(na_IsPoolPartFull(*curPart) && !na_EnhancePool(typeInfo, curPart)){return NA_NULL;}
+      #else
+        if(!na_EnhancePool(typeInfo, curPart)){return NA_NULL;}
+      #endif
+    }
   }
 
   // Now, we can be sure that the current part has space.
   #if NA_DEBUG
-    if(na_IsPoolPartFull(typeInfo->curPart))
+    if(na_IsPoolPartFull(*curPart))
       naCrash("Still no space after creating new space.");
   #endif
 
+  return *curPart;
+}
+
+
+
+NA_HIDEF void na_InitTypeInfoRefCount(const NA_TypeInfo* typeInfo, NARefCount* refCount){
+  if(typeInfo->atomicRefCount){
+    naInitRefCountAtomic(refCount);
+  }else{
+    naInitRefCount(refCount);
+  }
+}
+
+
+
+NA_HIDEF void na_CheckNewStructInfo(const NATypeInfo* info){
+  #if NA_DEBUG
+    if(!naIsRuntimeRunning())
+      naCrash("Runtime not running. Use naStartRuntime()");
+    if(!info)
+      naCrash("Given type identifier is Null-Pointer. Do not call na_NewStruct directly. Use the naNew macro.");
+    if(info->typeSize == 0)
+      naError("Type size is zero. Is the type void?");
+  #else
+    NA_UNUSED(info);
+  #endif
+}
+
+
+
+NA_DEF void* na_NewStructInternal(NATypeInfo* info){
+  na_CheckNewStructInfo(info);
+
+  NA_TypeInfo* typeInfo = (NA_TypeInfo*)info;
+  NA_PoolPart* part = na_GetPoolPartWithSpace(typeInfo);
+  if(!part){return NA_NULL;}
+
   // We get the pointer to the first currently unused space.
-  void* pointer = typeInfo->curPart->firstUnused;
+  void* pointer = part->firstUnused;
   void* retPointer = pointer;
   
   // In case this is a reference counting type, initialize the refCounter
   // and set the retPointer to the correct position.
   if(typeInfo->refCounting){
-    naInitRefCount(pointer);
+    na_InitTypeInfoRefCount(typeInfo, pointer);
     retPointer = (NAByte*)pointer + sizeof(NARefCount);
   }
 
   // We find out which will be the next pointer to return.
-  if(typeInfo->curPart->usedCount == typeInfo->curPart->everUsedCount){
+  if(part->usedCount == part->everUsedCount){
     // The current space has not been used ever and is de facto the one unused
     // space with the lowest address in this part. Use the next address one
     // typeSize ahead for the next space.
-    typeInfo->curPart->firstUnused = (NAByte*)(typeInfo->curPart->firstUnused) + typeInfo->typeSize;
+    part->firstUnused = (NAByte*)(part->firstUnused) + typeInfo->typeSize;
 
     // Increase the number of ever used spaces in this part.
-    typeInfo->curPart->everUsedCount++;
+    part->everUsedCount++;
   }else{
     // The space has already been used and deleted before which means, it
     // currently stores a pointer to the next unused space.
@@ -367,17 +1002,20 @@ NA_DEF void* na_NewStructInternal(NATypeInfo* info){
     // NARefCount structure which still is useful for error checking. So one
     // can still detect if the programmer erroneously wants to retain or
     // release the pointer.
-    typeInfo->curPart->firstUnused = *((void**)retPointer);
+    part->firstUnused = *((void**)retPointer);
   }
 
   // Increase the number of spaces used in this part.
-  typeInfo->curPart->usedCount++;
+  part->usedCount++;
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    na_AddPoolObjectCount(part, 1);
+  #endif
 
   #if NA_DEBUG
     #if defined NA_SYSTEM_SIZEINT_NOT_ADDRESS_SIZE
       naError("No native integer type to successfully run the runtime system.");
     #else
-      if(typeInfo->curPart != (NA_PoolPart*)((size_t)pointer & na_Runtime->partSizeMask))
+      if(part != (NA_PoolPart*)((size_t)pointer & na_Runtime->partSizeMask))
         naError("Pointer seems to be outside of part");
     #endif
   #endif
@@ -387,6 +1025,69 @@ NA_DEF void* na_NewStructInternal(NATypeInfo* info){
 
 
 
+NA_HDEF void na_NewStructBatchInternal(NATypeInfo* info, void** pointers, size_t count){
+  NA_TypeInfo* typeInfo = (NA_TypeInfo*)info;
+  size_t refCountSize;
+
+  na_CheckNewStructInfo(info);
+  #if NA_DEBUG
+    if(count && !pointers)
+      naCrash("pointers is Null");
+  #endif
+
+  refCountSize = typeInfo->refCounting ? sizeof(NARefCount) : 0;
+
+  while(count){
+    NA_PoolPart* part = na_GetPoolPartWithSpace(typeInfo);
+    size_t runCount;
+    NAByte* pointer;
+    size_t i;
+    #if NA_MEMORY_POOL_THREAD_SAFE
+      size_t prevUsedCount;
+    #endif
+
+    if(!part){
+      // Out of memory. The remaining pointers are set to Null.
+      naZeron(pointers, sizeof(void*) * count);
+      return;
+    }
+    #if NA_MEMORY_POOL_THREAD_SAFE
+      prevUsedCount = part->usedCount;
+    #endif
+
+    // First, we use up the spaces which have been deleted before. They form
+    // a list starting at firstUnused, exactly like in na_NewStructInternal.
+    while(count && part->usedCount < part->everUsedCount){
+      pointer = part->firstUnused;
+      if(refCountSize){na_InitTypeInfoRefCount(typeInfo, (NARefCount*)pointer);}
+      part->firstUnused = *((void**)(pointer + refCountSize));
+      *pointers++ = pointer + refCountSize;
+      part->usedCount++;
+      count--;
+    }
+
+    // Now, firstUnused points to the never used spaces at the end of the part
+    // which lie consecutively in memory. We take as many as needed in one run.
+    runCount = part->maxCount - part->everUsedCount;
+    if(runCount > count){runCount = count;}
+    pointer = part->firstUnused;
+    for(i = 0; i < runCount; ++i){
+      if(refCountSize){na_InitTypeInfoRefCount(typeInfo, (NARefCount*)pointer);}
+      *pointers++ = pointer + refCountSize;
+      pointer += typeInfo->typeSize;
+    }
+    part->firstUnused = pointer;
+    part->everUsedCount += runCount;
+    part->usedCount += runCount;
+    count -= runCount;
+    #if NA_MEMORY_POOL_THREAD_SAFE
+      na_AddPoolObjectCount(part, (NAInt)(part->usedCount - prevUsedCount));
+    #endif
+  }
+}
+
+
+
 NA_DEF void* na_NewStruct(NATypeInfo* info){
   #if NA_DEBUG
     NA_TypeInfo* typeInfo = (NA_TypeInfo*)info;
@@ -406,71 +1107,116 @@ NA_DEF void* na_CreateStruct(NATypeInfo* info){
 
 
 
-NA_HIDEF void na_EjectPoolPartObject(NA_PoolPart* part, void* pointer){
-  // The memory at pointer is expected to be erased and hence garbage.
+NA_DEF void na_NewStructBatch(NATypeInfo* info, void** pointers, size_t count){
+  #if NA_DEBUG
+    NA_TypeInfo* typeInfo = (NA_TypeInfo*)info;
+    if(typeInfo->refCounting)
+      naError("Do not use naNewBatch for reference-counting types. Use naCreateBatch.");
+  #endif
+  na_NewStructBatchInternal(info, pointers, count);
+}
+NA_DEF void na_CreateStructBatch(NATypeInfo* info, void** pointers, size_t count){
+  #if NA_DEBUG
+    NA_TypeInfo* typeInfo = (NA_TypeInfo*)info;
+    if(!typeInfo->refCounting)
+      naError("Do not use naCreateBatch for non-reference-counting types. Use naNewBatch.");
+  #endif
+  na_NewStructBatchInternal(info, pointers, count);
+}
 
-  // We explicitely store a pointer to the next unused space at that
-  // position, ultimately creating a list.
-  // Note that for reference counting types, we store the next pointer at
-  // the place where the actual content is stored, not the reference count.
-  // With that, it is still possible to do some error checks when for example
-  // the programmer wants to erroneously retain or release a pointer which
-  // has already been erased.
-  if(part->typeInfo->refCounting){
-    *((void**)((NAByte*)pointer + sizeof(NARefCount))) = part->firstUnused;
-  }else{
-    *((void**)pointer) = part->firstUnused;
-  }
-  part->firstUnused = pointer;
+
+
+// Gives back count spaces to the part. The memory of the spaces is expected
+// to be erased and hence garbage. The spaces are expected to already form a
+// list starting at firstPointer where lastLink is the link of the last space.
+NA_HIDEF void na_EjectPoolPartObjects(NA_PoolPart* part, void* firstPointer, void** lastLink, size_t count){
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    // If the part belongs to a different thread, we hand the spaces over to
+    // the owner of the part.
+    if(part->threadPool != na_GetCurrentThreadPool()){
+      na_PushRemotePoolPartObjects(part, firstPointer, lastLink);
+      return;
+    }
+  #endif
+
+  NA_PoolPart** curPart = na_GetCurPoolPartRef(part->typeInfo);
+
+  // We prepend the list to the unused spaces of the part.
+  *lastLink = part->firstUnused;
+  part->firstUnused = firstPointer;
 
   // If the part was full up until now, we reattach it in the list such that
   // it comes one after the current part. But only if there are more than one
   // parts around and the current part of the typeInfo is not already the
   // current part.
-  if(na_IsPoolPartFull(part) && (part->nextPart != part) && (part->typeInfo->curPart != part)){
+  if(na_IsPoolPartFull(part) && (part->nextPart != part) && (*curPart != part)){
     part->nextPart->prevPart = part->prevPart;
     part->prevPart->nextPart = part->nextPart;
-    na_AttachPoolPartAfterCurPoolPart(part->typeInfo, part);
+    na_AttachPoolPartAfterCurPoolPart(*curPart, part);
   }
 
   // We reduce the number of used spaces in this part.
-  part->usedCount--;
+  part->usedCount -= count;
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    na_AddPoolObjectCount(part, -(NAInt)count);
+  #endif
 
   // If no more spaces are in use, we can shrink that part away.
   if(!part->usedCount){
     if(part->nextPart == part){
       #if NA_MEMORY_POOL_AGGRESSIVE_CLEANUP == 1
         // If this part is the last part of the pool and the cleanup is set to
-        // aggressive, we shrink it away and unregister the type.
+        // aggressive, we shrink it away and unregister the type. In thread
+        // safe mode, the type stays registered as other threads may use it.
         NA_TypeInfo* typeInfo = part->typeInfo;
-        naFreeAligned(part);
-        typeInfo->curPart = NA_NULL;
-        na_UnregisterTypeInfo(typeInfo);
+        na_FreePoolPart(part);
+        *curPart = NA_NULL;
+        #if !NA_MEMORY_POOL_THREAD_SAFE
+          na_UnregisterTypeInfo(typeInfo);
+        #else
+          NA_UNUSED(typeInfo);
+        #endif
       #endif
     }else{
       // There are other parts in the pool. If the empty part is the one which
       // is the current part of the pool, we move to the next part.
-      if(part->typeInfo->curPart == part){
-        part->typeInfo->curPart = part->nextPart;
+      if(*curPart == part){
+        *curPart = part->nextPart;
       }
 
       // Now, one could think of checking whether there are more parts with
       // free space available and keep the part if there is absolutely none
       // available. But that would become a bit of a list nightmare and would
-      // destroy the simplicity of the current approach. Still, might be an
-      // idea.
+      // destroy the simplicity of the current approach. Instead, the memory
+      // of the part is kept as a spare part which any type can reuse. See
+      // NA_MEMORY_POOL_SPARE_PART_COUNT.
 
       // We unlink the part from the list.
       part->prevPart->nextPart = part->nextPart;
       part->nextPart->prevPart = part->prevPart;
-      // And delete its memory.
-      naFreeAligned(part);
+      // And give back its memory.
+      na_FreePoolPart(part);
     }
   }
 }
 
 
 
+NA_HIDEF void na_EjectPoolPartObject(NA_PoolPart* part, void* pointer){
+  // The memory at pointer is expected to be erased and hence garbage.
+
+  // We explicitely store a pointer to the next unused space at that
+  // position, ultimately creating a list.
+  // Note that for reference counting types, we store the next pointer at
+  // the place where the actual content is stored, not the reference count.
+  // With that, it is still possible to do some error checks when for example
+  // the programmer wants to erroneously retain or release a pointer which
+  // has already been erased.
+  na_EjectPoolPartObjects(part, pointer, na_GetPoolPartObjectLink(part->typeInfo, pointer), 1);
+}
+
+
+
 NA_DEF void naDelete(void* pointer){
   NA_PoolPart* part;
 
@@ -495,6 +1241,10 @@ NA_DEF void naDelete(void* pointer){
         naError("Pointer belongs to a reference-counting entity. Use naRelease instead of naDelete!");
     #endif
 
+    #if NA_MEMORY_TRACE
+      na_TraceDeallocation(pointer);
+    #endif
+
     // Erase the content of the space with the destructor if applicable
     if(part->typeInfo->destructor){part->typeInfo->destructor(pointer);}
 
@@ -505,6 +1255,58 @@ NA_DEF void naDelete(void* pointer){
 
 
 
+NA_DEF void naDeleteBatch(void** pointers, size_t count){
+  size_t i;
+
+  #if NA_DEBUG
+    if(!naIsRuntimeRunning())
+      naCrash("Runtime not running. Use naStartRuntime()");
+    if(count && !pointers)
+      naCrash("pointers is Null");
+  #endif
+
+  #if defined NA_SYSTEM_SIZEINT_NOT_ADDRESS_SIZE
+    NA_UNUSED(i);
+    NA_UNUSED(pointers);
+    NA_UNUSED(count);
+  #else
+
+    i = 0;
+    while(i < count){
+      // Consecutive pointers belonging to the same part are linked together
+      // and given back to the part all at once.
+      NA_PoolPart* part = (NA_PoolPart*)((size_t)pointers[i] & na_Runtime->partSizeMask);
+      void* firstPointer = pointers[i];
+      void** lastLink = NA_NULL;
+      size_t groupCount = 0;
+
+      #if NA_DEBUG
+        if(part->dummy != part)
+          naError("Pointer seems not to be from a pool.");
+        if(part->typeInfo->refCounting)
+          naError("Pointer belongs to a reference-counting entity. Use naRelease instead of naDeleteBatch!");
+      #endif
+
+      while(i < count && (NA_PoolPart*)((size_t)pointers[i] & na_Runtime->partSizeMask) == part){
+        void* pointer = pointers[i];
+        #if NA_MEMORY_TRACE
+          na_TraceDeallocation(pointer);
+        #endif
+        if(part->typeInfo->destructor){part->typeInfo->destructor(pointer);}
+        if(lastLink){*lastLink = pointer;}
+        lastLink = na_GetPoolPartObjectLink(part->typeInfo, pointer);
+        groupCount++;
+        i++;
+      }
+
+      na_EjectPoolPartObjects(part, firstPointer, lastLink, groupCount);
+    }
+
+  #endif
+}
+
+
+
 NA_DEF void* naRetain(void* pointer){
   #if NA_DEBUG
     if(!naIsRuntimeRunning())
@@ -564,12 +1366,16 @@ NA_DEF void naRelease(void* pointer){
 
     // Release the space and delete it with the destructor if refCount is zero.
     NARefCount* refCount = (NARefCount*)((NAByte*)pointer - sizeof(NARefCount));
-    naReleaseRefCount(refCount, pointer, part->typeInfo->destructor);
     // Note: The following test could also be achieved by using a special
-    // mutator function in the previous naReleaseRefCount call. But this would
-    // always cause a function call, even for types without a destructor.
-    // Therefore, we do this here:
-    if(!na_GetRefCountCount(refCount)){
+    // mutator function in the release call. But this would always cause a
+    // function call, even for types without a destructor. Therefore, we do
+    // this here. Note that the count must not be read again after releasing
+    // as with atomic reference counts, another thread might have reached
+    // zero in the meantime.
+    if(na_ReleaseRefCount(refCount, pointer, part->typeInfo->destructor)){
+      #if NA_MEMORY_TRACE
+        na_TraceDeallocation(pointer);
+      #endif
       na_EjectPoolPartObject(part, refCount);
     }
 
@@ -592,15 +1398,48 @@ NA_DEF void naReleaseConst(const void* pointer){
 
 
 
-NA_HIDEF void na_EnhanceMallocGarbage(){
-  NAMallocGarbage* newGarbage = naAlloc(NAMallocGarbage);
-#if NA_DEBUG
-  if(!newGarbage)
-    naCrash("No garbage memory allocated");
+#if NA_MEMORY_POOL_THREAD_SAFE
+
+  // Returns the pool of the current thread. If the thread has none yet, an
+  // abandoned one is adopted or a new one is created.
+  NA_HIDEF NA_ThreadPool* na_AttachThreadPool(){
+    NA_ThreadPool* threadPool = na_GetCurrentThreadPool();
+    if(!threadPool){
+      naLockMutex(na_Runtime->mutex);
+      threadPool = na_AdoptThreadPool();
+      na_ThreadPool = threadPool;
+      na_ThreadPoolGeneration = na_RuntimeGeneration;
+      naUnlockMutex(na_Runtime->mutex);
+    }
+    return threadPool;
+  }
+
 #endif
-  newGarbage->next = na_Runtime->mallocGarbage;
-  newGarbage->cur = 0;
-  na_Runtime->mallocGarbage = newGarbage;
+
+
+
+// Returns the arena of naMallocTmp of the current thread.
+NA_HIDEF NAArena* na_GetTmpArena(){
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    return &(na_AttachThreadPool()->tmpArena);
+  #else
+    return &(na_Runtime->tmpArena);
+  #endif
+}
+
+
+
+// Frees the temporary memory of the given arena. One block is kept for the
+// next temporary allocations except when cleaning up aggressively.
+NA_HIDEF void na_CollectTmpArena(NAArena* arena){
+  #if NA_MEMORY_TRACE
+    na_TraceArenaCleared(arena);
+  #endif
+  #if NA_MEMORY_POOL_AGGRESSIVE_CLEANUP == 1
+    naClearArena(arena);
+  #else
+    naResetArena(arena);
+  #endif
 }
 
 
@@ -611,29 +1450,24 @@ NA_DEF void* naMallocTmp(size_t byteSize){
     naCrash("Runtime not running. Use naStartRuntime()");
 #endif
 
+  NAArena* arena = na_GetTmpArena();
+
 #if NA_GARBAGE_TMP_AUTOCOLLECT_LIMIT != 0
-  if(na_Runtime->totalMallocGarbageByteCount > (size_t)NA_GARBAGE_TMP_AUTOCOLLECT_LIMIT){naCollectGarbage();}
+  if(naGetArenaByteSize(arena) > (size_t)NA_GARBAGE_TMP_AUTOCOLLECT_LIMIT){na_CollectTmpArena(arena);}
 #endif
 
-  na_Runtime->totalMallocGarbageByteCount += byteSize;
-  void* newPtr = naMalloc(byteSize);
+  return naMallocArena(arena, byteSize);
+}
 
-  if(!na_Runtime->mallocGarbage || (na_Runtime->mallocGarbage->cur == NA_MALLOC_GARBAGE_POINTER_COUNT)){
-    na_EnhanceMallocGarbage();
-  }
 
-#if NA_DEBUG
-  if(!na_Runtime->mallocGarbage)
-    naCrash("Garbage struct is Null");
-  if(na_Runtime->mallocGarbage->cur >= NA_MALLOC_GARBAGE_POINTER_COUNT)
-    naCrash("Buffer overrun.");
-#endif
 
-  NAMallocGarbage* garbage = na_Runtime->mallocGarbage;
-  garbage->pointers[garbage->cur] = newPtr;
-  garbage->cur++;
-  return newPtr;
-}
+#if NA_MEMORY_TRACE
+  NA_DEF void* na_MallocTmpTraced(size_t byteSize, const char* file, int line){
+    void* ptr = naMallocTmp(byteSize);
+    na_TraceAllocation(ptr, byteSize, NA_MEMORY_TRACE_MALLOC_TMP, NA_NULL, na_GetTmpArena(), file, line);
+    return ptr;
+  }
+#endif
 
 
 
@@ -642,37 +1476,17 @@ NA_DEF void naCollectGarbage(){
   if(!naIsRuntimeRunning())
     naCrash("Runtime not running. Use naStartRuntime()");
 #endif
-  while(na_Runtime->mallocGarbage){
-    void** ptr = na_Runtime->mallocGarbage->pointers;
-    for(size_t i = 0; i < na_Runtime->mallocGarbage->cur; ++i){
-      naFree(*ptr);
-      ptr++;
-    }
-    NAMallocGarbage* nextGarbage = na_Runtime->mallocGarbage->next;
+  na_CollectTmpArena(na_GetTmpArena());
+}
 
-    // If this was the last part, we decide if we want to delete it depending
-    // on the aggressive setting.
-  #if NA_MEMORY_POOL_AGGRESSIVE_CLEANUP == 1
-    naFree(na_Runtime->mallocGarbage);
-    na_Runtime->mallocGarbage = nextGarbage;
-  #else
-    if(nextGarbage){
-      naFree(na_Runtime->mallocGarbage);
-      na_Runtime->mallocGarbage = nextGarbage;
-    }else{
-      if (na_Runtime->mallocGarbage){
-        na_Runtime->mallocGarbage->cur = 0;
-      }else{
-        #if NA_DEBUG
-          naError("This should not happen but code sanity checks require it.");
-        #endif
-      }
-      break;
-    }
-  #endif
-  }
 
-  na_Runtime->totalMallocGarbageByteCount = 0;
+
+NA_DEF size_t naGetRuntimeGarbageByteSize(){
+#if NA_DEBUG
+  if(!naIsRuntimeRunning())
+    naCrash("Runtime not running. Use naStartRuntime()");
+#endif
+  return naGetArenaByteSize(na_GetTmpArena());
 }
 
 
@@ -687,7 +1501,7 @@ NA_DEF void naStartRuntime(){
     #if NA_DEBUG
       if(naIsRuntimeRunning())
         naCrash("Runtime already running");
-      if(sizeof(NA_PoolPart) != (8 * NA_ADDRESS_BYTES))
+      if(sizeof(NA_PoolPart) != (NA_POOLPART_ADDRESS_COUNT * NA_ADDRESS_BYTES))
         naError("NA_PoolPart struct encoding misaligned");
     #endif
     na_Runtime = naAlloc(NARuntime);
@@ -701,30 +1515,77 @@ NA_DEF void naStartRuntime(){
     #else
       #error "Pool part byteSize is too large"
     #endif
-    na_Runtime->mallocGarbage = NA_NULL;
-    na_Runtime->totalMallocGarbageByteCount = 0;
+    #if !NA_MEMORY_POOL_THREAD_SAFE
+      naInitArena(&(na_Runtime->tmpArena), na_Runtime->partSize);
+    #endif
     na_Runtime->typeInfoCount = 0;
     na_Runtime->typeInfos = NA_NULL;
+    na_Runtime->spareParts = NA_NULL;
+    na_Runtime->sparePartCount = 0;
+    #if NA_MEMORY_POOL_RESERVE_BYTESIZE != 0
+      na_Runtime->poolReserves = NA_NULL;
+      na_Runtime->releasedParts = NA_NULL;
+      na_Runtime->releasedPartCount = 0;
+      na_Runtime->releasedPartCapacity = 0;
+    #endif
+    #if NA_MEMORY_POOL_THREAD_SAFE
+      na_Runtime->mutex = naMakeMutex();
+      na_Runtime->threadPools = NA_NULL;
+      // All thread pools of a previous runtime become invalid.
+      na_RuntimeGeneration++;
+    #endif
   #endif
 }
 
 
 
+// Frees all parts of the circular part list of the given part.
+NA_HIDEF void na_FreePoolPartList(NA_PoolPart* firstPart){
+  NA_PoolPart* curPart = firstPart;
+  while(curPart){
+    NA_PoolPart* nextPart = curPart->nextPart;
+    na_FreePoolPartMemory(curPart);
+    if(nextPart == firstPart){break;}
+    curPart = nextPart;
+  }
+}
+
+
+
 NA_DEF void naStopRuntime(){
-  // First, we collect the garbage
-  naCollectGarbage();
-  #if NA_MEMORY_POOL_AGGRESSIVE_CLEANUP == 0
-    if(na_Runtime->mallocGarbage){
-      naFree(na_Runtime->mallocGarbage);
-      na_Runtime->mallocGarbage = NA_NULL;
+  #if NA_DEBUG
+    if(!naIsRuntimeRunning())
+      naCrash("Runtime not running. Use naStartRuntime()");
+  #endif
+
+  // First, we collect the garbage. In thread-safe mode, the temporary memory
+  // of all threads is freed together with their pools below.
+  #if !NA_MEMORY_POOL_THREAD_SAFE
+    naClearArena(&(na_Runtime->tmpArena));
+  #endif
+
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    // No other thread is expected to use the runtime anymore. All spaces
+    // which had been deleted by foreign threads are collected such that they
+    // will not be detected as leaks.
+    NA_ThreadPool* threadPool = na_Runtime->threadPools;
+    while(threadPool){
+      for(size_t i = 0; i < threadPool->curPartCount; ++i){
+        NA_PoolPart* firstPart = threadPool->curParts[i];
+        NA_PoolPart* part = firstPart;
+        while(part){
+          na_CollectRemotePoolPartObjects(part);
+          part = part->nextPart;
+          if(part == firstPart){break;}
+        }
+      }
+      threadPool = threadPool->next;
     }
   #endif
 
   // Then, we detect, if there are any memory leaks.
   #if NA_DEBUG
     NABool leakMessagePrinted = NA_FALSE;
-    if(!naIsRuntimeRunning())
-      naCrash("Runtime not running. Use naStartRuntime()");
 
     // Go through all registered types and output a leak message if necessary.
     for(size_t i = 0; i < na_Runtime->typeInfoCount; ++i){
@@ -741,30 +1602,234 @@ NA_DEF void naStopRuntime(){
     }
   #endif
 
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    // Free all parts of all thread pools.
+    while(na_Runtime->threadPools){
+      threadPool = na_Runtime->threadPools;
+      for(size_t i = 0; i < threadPool->curPartCount; ++i){
+        na_FreePoolPartList(threadPool->curParts[i]);
+      }
+      na_Runtime->threadPools = threadPool->next;
+      naClearArena(&(threadPool->tmpArena));
+      naFree(threadPool->curParts);
+      naFree(threadPool->objectCounts);
+      naFree(threadPool);
+    }
+    na_ThreadPool = NA_NULL;
+    na_ThreadPoolGeneration = 0;
+  #endif
+
   // Go through all remaining registered types and completely erase them
   // from memory.
   while(na_Runtime->typeInfos){
-    NA_PoolPart* firstpart;
-    NA_PoolPart* curPart;
-    NA_PoolPart* nextPart;
-
     // Free all parts.
-    firstpart = na_Runtime->typeInfos[0]->curPart;
-    curPart = firstpart;
-    while(curPart){
-      nextPart = curPart->nextPart;
-      naFreeAligned(curPart);
-      if(nextPart == firstpart){break;}
-      curPart = nextPart;
-    }
+    na_FreePoolPartList(na_Runtime->typeInfos[0]->curPart);
 
     // Finally, unregister the type.
     na_Runtime->typeInfos[0]->curPart = NA_NULL;
+    na_Runtime->typeInfos[0]->partCount = 0;
+    na_Runtime->typeInfos[0]->maxPartCount = 0;
     na_UnregisterTypeInfo(na_Runtime->typeInfos[0]);
   }
 
+  na_FreeSpareParts();
+  #if NA_MEMORY_POOL_RESERVE_BYTESIZE != 0
+    na_FreePoolReserves();
+  #endif
+
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    naClearMutex(na_Runtime->mutex);
+  #endif
+
   naFree(na_Runtime);
   na_Runtime = NA_NULL;
+
+  #if NA_MEMORY_TRACE
+    na_TraceRuntimeStopped();
+  #endif
+}
+
+
+
+NA_DEF void naTrimRuntimeSpareParts(){
+  #if NA_DEBUG
+    if(!naIsRuntimeRunning())
+      naCrash("Runtime not running. Use naStartRuntime()");
+  #endif
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    naLockMutex(na_Runtime->mutex);
+    na_FreeSpareParts();
+    naUnlockMutex(na_Runtime->mutex);
+  #else
+    na_FreeSpareParts();
+  #endif
+}
+
+
+
+NA_DEF void naDetachRuntimeThread(){
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    NA_ThreadPool* threadPool;
+    // A thread which is not attached does not touch the runtime at all as it
+    // may already have been stopped by another thread.
+    if(!na_ThreadPool){return;}
+  #endif
+  #if NA_DEBUG
+    if(!naIsRuntimeRunning())
+      naCrash("Runtime not running. Use naStartRuntime()");
+  #endif
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    threadPool = na_GetCurrentThreadPool();
+    if(threadPool){
+      #if NA_MEMORY_TRACE
+        na_TraceArenaCleared(&(threadPool->tmpArena));
+      #endif
+      naClearArena(&(threadPool->tmpArena));
+      naLockMutex(na_Runtime->mutex);
+      threadPool->abandoned = NA_TRUE;
+      naUnlockMutex(na_Runtime->mutex);
+      na_ThreadPool = NA_NULL;
+      na_ThreadPoolGeneration = 0;
+    }
+  #endif
+}
+
+
+
+// Computes the stats of one registered type. In thread-safe mode, the mutex
+// must be locked.
+NA_HIDEF void na_FillRuntimeTypeStats(NARuntimeTypeStats* typeStats, NA_TypeInfo* typeInfo){
+  naZeron(typeStats, sizeof(NARuntimeTypeStats));
+  typeStats->typeName = typeInfo->typeName;
+  typeStats->typeSize = typeInfo->typeSize;
+
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    // The part lists of the other threads change without the mutex, hence
+    // only the object counts published by the threads are summed up.
+    NA_ThreadPool* threadPool = na_Runtime->threadPools;
+    while(threadPool){
+      if(typeInfo->poolIndex < threadPool->curPartCount){
+        typeStats->objectCount += na_GetPoolObjectCount(&(threadPool->objectCounts[typeInfo->poolIndex]));
+      }
+      threadPool = threadPool->next;
+    }
+  #else
+    if(typeInfo->curPart){
+      typeStats->objectCount = na_GetPoolPartListAllocatedCount(typeInfo->curPart);
+    }
+  #endif
+
+  // All parts of a type hold the same number of objects.
+  typeStats->partCount = typeInfo->partCount;
+  typeStats->capacityCount = typeInfo->partCount * ((na_Runtime->partSize - sizeof(NA_PoolPart)) / typeInfo->typeSize);
+
+  typeStats->maxPartCount = typeInfo->maxPartCount;
+  typeStats->bytesReserved = typeStats->partCount * na_Runtime->partSize;
+  typeStats->bytesUsed = typeStats->objectCount * typeInfo->typeSize;
+  typeStats->maxBytesReserved = typeStats->maxPartCount * na_Runtime->partSize;
+  if(typeStats->capacityCount){
+    typeStats->fragmentation = 1. - (double)typeStats->objectCount / (double)typeStats->capacityCount;
+  }
+}
+
+
+
+// Returns a newly allocated array with the stats of all registered types and
+// stores the number of types in typeCount. The callbacks of the user are
+// called with these copies in order to not hold the mutex during the calls.
+NA_HIDEF NARuntimeTypeStats* na_CreateRuntimeTypeStatsArray(size_t* typeCount){
+  NARuntimeTypeStats* typeStatsArray = NA_NULL;
+
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    naLockMutex(na_Runtime->mutex);
+  #endif
+
+  *typeCount = na_Runtime->typeInfoCount;
+  if(*typeCount){
+    typeStatsArray = naMalloc(sizeof(NARuntimeTypeStats) * *typeCount);
+    for(size_t i = 0; i < *typeCount; ++i){
+      na_FillRuntimeTypeStats(&(typeStatsArray[i]), na_Runtime->typeInfos[i]);
+    }
+  }
+
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    naUnlockMutex(na_Runtime->mutex);
+  #endif
+
+  return typeStatsArray;
+}
+
+
+
+NA_DEF void naGetRuntimeStats(NARuntimeStats* stats){
+  size_t typeCount;
+  NARuntimeTypeStats* typeStatsArray;
+  size_t i;
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    NA_ThreadPool* threadPool;
+  #endif
+
+  #if NA_DEBUG
+    if(!naIsRuntimeRunning())
+      naCrash("Runtime not running. Use naStartRuntime()");
+    if(!stats)
+      naCrash("stats is Null");
+  #endif
+
+  naZeron(stats, sizeof(NARuntimeStats));
+
+  typeStatsArray = na_CreateRuntimeTypeStatsArray(&typeCount);
+  stats->typeCount = typeCount;
+  for(i = 0; i < typeCount; ++i){
+    stats->objectCount += typeStatsArray[i].objectCount;
+    stats->capacityCount += typeStatsArray[i].capacityCount;
+    stats->partCount += typeStatsArray[i].partCount;
+    stats->bytesReserved += typeStatsArray[i].bytesReserved;
+    stats->bytesUsed += typeStatsArray[i].bytesUsed;
+  }
+  naFree(typeStatsArray);
+
+  if(stats->capacityCount){
+    stats->fragmentation = 1. - (double)stats->objectCount / (double)stats->capacityCount;
+  }
+
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    naLockMutex(na_Runtime->mutex);
+    threadPool = na_Runtime->threadPools;
+    while(threadPool){
+      stats->garbageByteCount += naGetArenaByteSize(&(threadPool->tmpArena));
+      stats->maxGarbageByteCount += naGetArenaMaxByteSize(&(threadPool->tmpArena));
+      threadPool = threadPool->next;
+    }
+  #else
+    stats->garbageByteCount = naGetArenaByteSize(&(na_Runtime->tmpArena));
+    stats->maxGarbageByteCount = naGetArenaMaxByteSize(&(na_Runtime->tmpArena));
+  #endif
+  stats->sparePartCount = na_Runtime->sparePartCount;
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    naUnlockMutex(na_Runtime->mutex);
+  #endif
+}
+
+
+
+NA_DEF void naIterateRuntimeTypeStats(NARuntimeTypeStatsCallback callback, void* data){
+  size_t typeCount;
+  NARuntimeTypeStats* typeStatsArray;
+  size_t i;
+
+  #if NA_DEBUG
+    if(!naIsRuntimeRunning())
+      naCrash("Runtime not running. Use naStartRuntime()");
+    if(!callback)
+      naCrash("callback is Null");
+  #endif
+
+  typeStatsArray = na_CreateRuntimeTypeStatsArray(&typeCount);
+  for(i = 0; i < typeCount; ++i){
+    callback(&(typeStatsArray[i]), data);
+  }
+  naFree(typeStatsArray);
 }
 
 
@@ -12,9 +12,11 @@ struct NATypeInfo{
   size_t            typeSize;
   NAMutator         destructor;
   NABool            refCounting;
-  #if NA_DEBUG
-    const char*     typeName;
-  #endif
+  NABool            atomicRefCount;
+  size_t            poolIndex;      // Only used with NA_MEMORY_POOL_THREAD_SAFE
+  size_t            partCount;      // Statistics, see naIterateRuntimeTypeStats
+  size_t            maxPartCount;
+  const char*       typeName;
 };
 
 
@@ -22,22 +24,30 @@ struct NATypeInfo{
 // This is the runtime type macro which actually creates a global variable
 // called na_MyStruct_Typeinfo (for whatever MyStruct is) storing all values.
 #undef NA_RUNTIME_TYPE
-#if NA_DEBUG
-  #define NA_RUNTIME_TYPE(typeName, destructor, refCounting)\
-    NATypeInfo na_ ## typeName ## TypeInfo =\
-    {NA_NULL,\
-    sizeof(typeName),\
-    (NAMutator)destructor,\
-    refCounting,\
-    #typeName}
-#else
-  #define NA_RUNTIME_TYPE(typeName, destructor, refCounting)\
-    NATypeInfo na_ ## typeName ## TypeInfo =\
-    {NA_NULL,\
-    sizeof(typeName),\
-    (NAMutator)destructor,\
-    refCounting}
-#endif
+#define NA_RUNTIME_TYPE(typeName, destructor, refCounting)\
+  NATypeInfo na_ ## typeName ## TypeInfo =\
+  {NA_NULL,\
+  sizeof(typeName),\
+  (NAMutator)destructor,\
+  refCounting,\
+  NA_FALSE,\
+  0,\
+  0,\
+  0,\
+  #typeName}
+
+#undef NA_RUNTIME_TYPE_ATOMIC
+#define NA_RUNTIME_TYPE_ATOMIC(typeName, destructor)\
+  NATypeInfo na_ ## typeName ## TypeInfo =\
+  {NA_NULL,\
+  sizeof(typeName),\
+  (NAMutator)destructor,\
+  NA_TRUE,\
+  NA_TRUE,\
+  0,\
+  0,\
+  0,\
+  #typeName}
 
 
 
@@ -58,24 +68,49 @@ struct NATypeInfo{
 // If you experience an error here with naCreate: Have you marked your type
 // with NA_RUNTIME_TYPE? See NA_RUNTIME_TYPE below.
 
+#undef naNewBatch
+#define naNewBatch(typeName, pointers, count)\
+  na_NewStructBatch(&na_ ## typeName ## TypeInfo, (void**)(pointers), count)
+
+#undef naCreateBatch
+#define naCreateBatch(typeName, pointers, count)\
+  na_CreateStructBatch(&na_ ## typeName ## TypeInfo, (void**)(pointers), count)
+
 NA_API void* na_NewStruct(NATypeInfo* info);
 NA_API void* na_CreateStruct(NATypeInfo* info);
+NA_API void  na_NewStructBatch(NATypeInfo* info, void** pointers, size_t count);
+NA_API void  na_CreateStructBatch(NATypeInfo* info, void** pointers, size_t count);
 
 
 
 typedef struct NA_TypeInfo NA_TypeInfo;
-typedef struct NAMallocGarbage NAMallocGarbage;
 typedef struct NARuntime NARuntime;
+#if NA_MEMORY_POOL_THREAD_SAFE
+  typedef struct NA_ThreadPool NA_ThreadPool;
+#endif
 
 // The runtime struct stores base informations about the runtime.
 struct NARuntime{
   size_t memPageSize;
   size_t partSize;
   size_t partSizeMask;
-  NAMallocGarbage* mallocGarbage;
-  size_t totalMallocGarbageByteCount;
+  #if !NA_MEMORY_POOL_THREAD_SAFE
+    NAArena tmpArena;            // The memory of naMallocTmp.
+  #endif
   size_t typeInfoCount;
   NA_TypeInfo** typeInfos;
+  void* spareParts;              // Empty parts kept for reuse, see
+  size_t sparePartCount;         // NA_MEMORY_POOL_SPARE_PART_COUNT.
+  #if NA_MEMORY_POOL_RESERVE_BYTESIZE != 0
+    void* poolReserves;          // Address ranges the parts are carved from.
+    void** releasedParts;        // Carved parts given back to the system.
+    size_t releasedPartCount;
+    size_t releasedPartCapacity;
+  #endif
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    void* mutex;                 // An NAMutex guarding all fields above.
+    NA_ThreadPool* threadPools;  // All thread pools ever used.
+  #endif
 };
 
 extern NARuntime* na_Runtime;
@@ -88,16 +123,6 @@ NA_IDEF NABool naIsRuntimeRunning(){
 
 
 
-NA_IDEF size_t naGetRuntimeGarbageByteSize(){
-  #if NA_DEBUG
-    if(!naIsRuntimeRunning())
-      naCrash("Runtime not running. Use naStartRuntime()");
-  #endif
-  return na_Runtime->totalMallocGarbageByteCount;
-}
-
-
-
 NA_IDEF size_t naGetRuntimeMemoryPageSize(){
   #if NA_DEBUG
     if(!naIsRuntimeRunning())
@@ -0,0 +1,725 @@
+#include "../NAThreading.h"
+#include "../NAAtomic.h"
+#include "../NABinaryData.h"
+
+// //////////////////////////////////////
+// Implementation notes about the thread pool.
+//
+// Every worker owns an NA_TaskDeque, a ring buffer of tasks protected by a
+// spin lock. The owner pushes and pops tasks at the back, other workers steal
+// tasks from the front. Tasks dispatched by threads which are not workers of
+// the pool are pushed onto the injection deque of the pool which is treated
+// like the deque of a worker not owned by anyone. The locks are held only
+// for the few instructions needed to move one task, hence a spin lock is
+// sufficient.
+//
+// A worker not finding any task registers itself in idleCount, searches all
+// deques once more and then sleeps on the wake semaphore. Dispatching a task
+// first pushes it and then takes one registered worker out of idleCount and
+// signals the semaphore. As both sides first write and then read the other
+// side under a lock or with a sequentially consistent atomic operation, no
+// task can be dispatched unnoticed by a worker going to sleep. A worker
+// finding a task after having registered as idle takes back its
+// registration. If a dispatching thread was faster, the worker instead
+// consumes the signal meant for it.
+//
+// A task group stores the number of its pending tasks and a flag denoting
+// whether a thread waits for the group in one atomic integer. The thread
+// executing the last task of the group signals the semaphore of the group
+// only if the flag is set. Hence once the waiting thread sees zero pending
+// tasks, no other thread accesses the group anymore and it can safely be
+// cleared.
+
+
+
+// Set in the state of a task group while a thread waits for it.
+#define NA_TASK_GROUP_WAITING 0x40000000
+
+#define NA_TASK_DEQUE_INITIAL_CAPACITY 64
+
+typedef struct NA_Task NA_Task;
+typedef struct NA_TaskDeque NA_TaskDeque;
+typedef struct NA_ThreadPoolWorker NA_ThreadPoolWorker;
+
+struct NA_Task{
+  NAMutator function;
+  void* arg;
+  NATaskGroup* group;
+};
+
+struct NA_TaskDeque{
+  NA_Task* tasks;
+  size_t capacity;              // Always a power of two.
+  size_t first;                 // Index of the oldest task.
+  size_t count;
+  NAAtomic32 lock;
+};
+
+struct NA_ThreadPoolWorker{
+  NAThreadPool* pool;
+  size_t index;
+  NAThread thread;
+  NA_TaskDeque deque;
+};
+
+struct NAThreadPool{
+  NA_ThreadPoolWorker* workers;
+  size_t workerCount;
+  NA_TaskDeque injectionDeque;
+  NAAtomic32 nextVictim;  // Where outside threads start stealing.
+  NAAtomic32 idleCount;
+  NAAtomic32 stopping;
+  NA_Semaphore wakeSemaphore;
+  NA_Semaphore exitSemaphore;
+};
+
+struct NATaskGroup{
+  NAThreadPool* pool;
+  NAAtomic32 state;   // Pending tasks plus NA_TASK_GROUP_WAITING
+  NA_Semaphore doneSemaphore;
+};
+
+// The worker executing on the current thread or Null.
+static NA_THREAD_LOCAL NA_ThreadPoolWorker* na_CurrentThreadPoolWorker = NA_NULL;
+
+static NAAtomicPtr na_DefaultThreadPool = {NA_NULL};
+static NAAtomic32 na_DefaultThreadPoolLock = {0};
+
+
+
+// Decrements the counter if it is greater than zero. Returns NA_TRUE if the
+// counter has been decremented.
+NA_HIDEF NABool na_TryDecrementThreadPoolCounter(NAAtomic32* counter){
+  int32 value = naLoadAtomic32(counter, NA_MEMORY_ORDER_SEQ_CST);
+  while(value > 0){
+    if(naCompareExchangeAtomic32(counter, &value, value - 1, NA_MEMORY_ORDER_SEQ_CST)){return NA_TRUE;}
+  }
+  return NA_FALSE;
+}
+
+
+
+NA_HIDEF void na_LockThreadPoolSpinLock(NAAtomic32* lock){
+  while(naExchangeAtomic32(lock, 1, NA_MEMORY_ORDER_ACQUIRE)){naPauseAtomic();}
+}
+
+
+
+NA_HIDEF void na_UnlockThreadPoolSpinLock(NAAtomic32* lock){
+  naStoreAtomic32(lock, 0, NA_MEMORY_ORDER_RELEASE);
+}
+
+
+
+NA_HIDEF void na_InitTaskDeque(NA_TaskDeque* deque){
+  deque->tasks = naMalloc(NA_TASK_DEQUE_INITIAL_CAPACITY * sizeof(NA_Task));
+  deque->capacity = NA_TASK_DEQUE_INITIAL_CAPACITY;
+  deque->first = 0;
+  deque->count = 0;
+  naInitAtomic32(&(deque->lock), 0);
+}
+
+
+
+NA_HIDEF void na_ClearTaskDeque(NA_TaskDeque* deque){
+  #if NA_DEBUG
+    if(deque->count)
+      naError("Deque still contains tasks.");
+  #endif
+  naFree(deque->tasks);
+}
+
+
+
+NA_HIDEF void na_PushTaskDeque(NA_TaskDeque* deque, NA_Task task){
+  na_LockThreadPoolSpinLock(&(deque->lock));
+  if(deque->count == deque->capacity){
+    // The deque is full. Double the capacity and move the tasks such that
+    // the oldest one is stored first.
+    size_t i;
+    NA_Task* newTasks = naMalloc(2 * deque->capacity * sizeof(NA_Task));
+    for(i = 0; i < deque->count; i++){
+      newTasks[i] = deque->tasks[(deque->first + i) & (deque->capacity - 1)];
+    }
+    naFree(deque->tasks);
+    deque->tasks = newTasks;
+    deque->capacity *= 2;
+    deque->first = 0;
+  }
+  deque->tasks[(deque->first + deque->count) & (deque->capacity - 1)] = task;
+  deque->count++;
+  na_UnlockThreadPoolSpinLock(&(deque->lock));
+}
+
+
+
+// Removes the newest task of the deque. Returns NA_FALSE if empty.
+NA_HIDEF NABool na_PopTaskDeque(NA_TaskDeque* deque, NA_Task* task){
+  NABool found = NA_FALSE;
+  na_LockThreadPoolSpinLock(&(deque->lock));
+  if(deque->count){
+    deque->count--;
+    *task = deque->tasks[(deque->first + deque->count) & (deque->capacity - 1)];
+    found = NA_TRUE;
+  }
+  na_UnlockThreadPoolSpinLock(&(deque->lock));
+  return found;
+}
+
+
+
+// Removes the oldest task of the deque. Returns NA_FALSE if empty.
+NA_HIDEF NABool na_StealTaskDeque(NA_TaskDeque* deque, NA_Task* task){
+  NABool found = NA_FALSE;
+  na_LockThreadPoolSpinLock(&(deque->lock));
+  if(deque->count){
+    *task = deque->tasks[deque->first];
+    deque->first = (deque->first + 1) & (deque->capacity - 1);
+    deque->count--;
+    found = NA_TRUE;
+  }
+  na_UnlockThreadPoolSpinLock(&(deque->lock));
+  return found;
+}
+
+
+
+// Searches a task to execute. A worker first looks in its own deque. Then,
+// the injection deque and the deques of all other workers are searched.
+// worker is Null when searching from a thread outside of the pool.
+NA_HIDEF NABool na_FindThreadPoolTask(NAThreadPool* pool, NA_ThreadPoolWorker* worker, NA_Task* task){
+  size_t start;
+  size_t i;
+  if(worker){
+    if(na_PopTaskDeque(&(worker->deque), task)){return NA_TRUE;}
+    start = worker->index + 1;
+  }else{
+    start = (size_t)naFetchAddAtomic32(&(pool->nextVictim), 1, NA_MEMORY_ORDER_RELAXED);
+  }
+  if(na_StealTaskDeque(&(pool->injectionDeque), task)){return NA_TRUE;}
+  for(i = 0; i < pool->workerCount; i++){
+    NA_ThreadPoolWorker* victim = &(pool->workers[(start + i) % pool->workerCount]);
+    if(victim != worker && na_StealTaskDeque(&(victim->deque), task)){return NA_TRUE;}
+  }
+  return NA_FALSE;
+}
+
+
+
+NA_HIDEF void na_FinishGroupTask(NATaskGroup* group){
+  // If the thread waiting for the group sleeps, it has set the waiting flag
+  // and only the very last task of the group will wake it up. After the
+  // decrement, the group must not be accessed in any other case.
+  int32 prevState = naFetchAddAtomic32(&(group->state), -1, NA_MEMORY_ORDER_SEQ_CST);
+  if(prevState == NA_TASK_GROUP_WAITING + 1){
+    na_SignalSemaphore(&(group->doneSemaphore), 1);
+  }
+}
+
+
+
+NA_HIDEF void na_ExecuteThreadPoolTask(NA_Task* task){
+  task->function(task->arg);
+  if(task->group){na_FinishGroupTask(task->group);}
+}
+
+
+
+// Returns the pool-specific worker of the current thread or Null.
+NA_HIDEF NA_ThreadPoolWorker* na_GetCurrentThreadPoolWorker(NAThreadPool* pool){
+  NA_ThreadPoolWorker* worker = na_CurrentThreadPoolWorker;
+  return (worker && worker->pool == pool) ? worker : NA_NULL;
+}
+
+
+
+NA_HDEF void na_RunThreadPoolWorker(void* arg){
+  NA_ThreadPoolWorker* worker = (NA_ThreadPoolWorker*)arg;
+  NAThreadPool* pool = worker->pool;
+  NA_Task task;
+  na_CurrentThreadPoolWorker = worker;
+
+  while(1){
+    if(na_FindThreadPoolTask(pool, worker, &task)){
+      na_ExecuteThreadPoolTask(&task);
+      continue;
+    }
+    if(naLoadAtomic32(&(pool->stopping), NA_MEMORY_ORDER_SEQ_CST)){break;}
+
+    // Register as idle and search once more before going to sleep.
+    naFetchAddAtomic32(&(pool->idleCount), 1, NA_MEMORY_ORDER_SEQ_CST);
+    if(na_FindThreadPoolTask(pool, worker, &task)){
+      if(!na_TryDecrementThreadPoolCounter(&(pool->idleCount))){
+        na_WaitSemaphore(&(pool->wakeSemaphore));
+      }
+      na_ExecuteThreadPoolTask(&task);
+    }else{
+      na_WaitSemaphore(&(pool->wakeSemaphore));
+    }
+  }
+
+  // Detach before signaling: As soon as naClearThreadPool returns, the
+  // runtime may be stopped. The detaching of the thread wrapper afterwards
+  // then has nothing left to do.
+  na_CurrentThreadPoolWorker = NA_NULL;
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    naDetachRuntimeThread();
+  #endif
+  #if NA_MALLOC_SIZE_CLASSES
+    naDetachMallocThread();
+  #endif
+  na_SignalSemaphore(&(pool->exitSemaphore), 1);
+}
+
+
+
+NA_HIDEF void na_PushThreadPoolTask(NAThreadPool* pool, NA_Task task){
+  NA_ThreadPoolWorker* worker = na_GetCurrentThreadPoolWorker(pool);
+  if(worker){
+    na_PushTaskDeque(&(worker->deque), task);
+  }else{
+    na_PushTaskDeque(&(pool->injectionDeque), task);
+  }
+  if(na_TryDecrementThreadPoolCounter(&(pool->idleCount))){
+    na_SignalSemaphore(&(pool->wakeSemaphore), 1);
+  }
+}
+
+
+
+NA_DEF size_t naGetSystemProcessorCount(void){
+  #if NA_OS == NA_OS_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (size_t)info.dwNumberOfProcessors;
+  #else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (size_t)count : 1;
+  #endif
+}
+
+
+
+NA_DEF NAThreadPool* naMakeThreadPool(size_t workerCount){
+  size_t i;
+  NAThreadPool* pool = naAlloc(NAThreadPool);
+  if(!workerCount){workerCount = naGetSystemProcessorCount();}
+
+  pool->workers = naMalloc(workerCount * sizeof(NA_ThreadPoolWorker));
+  pool->workerCount = workerCount;
+  na_InitTaskDeque(&(pool->injectionDeque));
+  naInitAtomic32(&(pool->nextVictim), 0);
+  naInitAtomic32(&(pool->idleCount), 0);
+  naInitAtomic32(&(pool->stopping), 0);
+  na_InitSemaphore(&(pool->wakeSemaphore));
+  na_InitSemaphore(&(pool->exitSemaphore));
+
+  // All workers must be complete before any of them runs as they steal from
+  // each other.
+  for(i = 0; i < workerCount; i++){
+    NA_ThreadPoolWorker* worker = &(pool->workers[i]);
+    worker->pool = pool;
+    worker->index = i;
+    worker->thread = naMakeThread("NALib Thread Pool Worker", na_RunThreadPoolWorker, worker);
+    na_InitTaskDeque(&(worker->deque));
+  }
+  for(i = 0; i < workerCount; i++){
+    naRunThread(pool->workers[i].thread);
+  }
+  return pool;
+}
+
+
+
+NA_DEF void naClearThreadPool(NAThreadPool* pool){
+  size_t i;
+  #if NA_DEBUG
+    if(!pool)
+      naCrash("pool is Null");
+    if(pool == naLoadAtomicPtr(&na_DefaultThreadPool, NA_MEMORY_ORDER_RELAXED))
+      naError("The default pool can not be cleared.");
+    if(na_GetCurrentThreadPoolWorker(pool))
+      naError("A pool can not be cleared by one of its own workers.");
+  #endif
+
+  // Workers only stop when they do not find any task. Wake up all sleeping
+  // workers and wait until all of them have stopped.
+  naStoreAtomic32(&(pool->stopping), 1, NA_MEMORY_ORDER_SEQ_CST);
+  na_SignalSemaphore(&(pool->wakeSemaphore), pool->workerCount);
+  for(i = 0; i < pool->workerCount; i++){
+    na_WaitSemaphore(&(pool->exitSemaphore));
+  }
+
+  for(i = 0; i < pool->workerCount; i++){
+    naClearThread(pool->workers[i].thread);
+    na_ClearTaskDeque(&(pool->workers[i].deque));
+  }
+  na_ClearTaskDeque(&(pool->injectionDeque));
+  na_ClearSemaphore(&(pool->wakeSemaphore));
+  na_ClearSemaphore(&(pool->exitSemaphore));
+  naFree(pool->workers);
+  naFree(pool);
+}
+
+
+
+NA_DEF NAThreadPool* naGetDefaultThreadPool(void){
+  NAThreadPool* pool = naLoadAtomicPtr(&na_DefaultThreadPool, NA_MEMORY_ORDER_ACQUIRE);
+  if(!pool){
+    na_LockThreadPoolSpinLock(&na_DefaultThreadPoolLock);
+    pool = naLoadAtomicPtr(&na_DefaultThreadPool, NA_MEMORY_ORDER_RELAXED);
+    if(!pool){
+      pool = naMakeThreadPool(0);
+      naStoreAtomicPtr(&na_DefaultThreadPool, pool, NA_MEMORY_ORDER_RELEASE);
+    }
+    na_UnlockThreadPoolSpinLock(&na_DefaultThreadPoolLock);
+  }
+  return pool;
+}
+
+
+
+NA_DEF size_t naGetThreadPoolWorkerCount(const NAThreadPool* pool){
+  return pool->workerCount;
+}
+
+
+
+NA_DEF void naDispatchTask(NAThreadPool* pool, NAMutator task, void* arg){
+  NA_Task newTask;
+  #if NA_DEBUG
+    if(!pool)
+      naCrash("pool is Null");
+    if(!task)
+      naCrash("task is Null");
+  #endif
+  newTask.function = task;
+  newTask.arg = arg;
+  newTask.group = NA_NULL;
+  na_PushThreadPoolTask(pool, newTask);
+}
+
+
+
+NA_DEF NATaskGroup* naMakeTaskGroup(NAThreadPool* pool){
+  NATaskGroup* group;
+  #if NA_DEBUG
+    if(!pool)
+      naCrash("pool is Null");
+  #endif
+  group = naAlloc(NATaskGroup);
+  group->pool = pool;
+  naInitAtomic32(&(group->state), 0);
+  na_InitSemaphore(&(group->doneSemaphore));
+  return group;
+}
+
+
+
+NA_DEF void naClearTaskGroup(NATaskGroup* group){
+  #if NA_DEBUG
+    if(naLoadAtomic32(&(group->state), NA_MEMORY_ORDER_SEQ_CST))
+      naError("Group still has pending tasks. Use naWaitTaskGroup first.");
+  #endif
+  na_ClearSemaphore(&(group->doneSemaphore));
+  naFree(group);
+}
+
+
+
+NA_DEF void naDispatchGroupTask(NATaskGroup* group, NAMutator task, void* arg){
+  NA_Task newTask;
+  #if NA_DEBUG
+    if(!task)
+      naCrash("task is Null");
+    if((naLoadAtomic32(&(group->state), NA_MEMORY_ORDER_SEQ_CST) & ~NA_TASK_GROUP_WAITING) == NA_TASK_GROUP_WAITING - 1)
+      naError("Too many pending tasks in group.");
+  #endif
+  newTask.function = task;
+  newTask.arg = arg;
+  newTask.group = group;
+  naFetchAddAtomic32(&(group->state), 1, NA_MEMORY_ORDER_SEQ_CST);
+  na_PushThreadPoolTask(group->pool, newTask);
+}
+
+
+
+NA_DEF void naWaitTaskGroup(NATaskGroup* group){
+  NAThreadPool* pool = group->pool;
+  NA_ThreadPoolWorker* worker = na_GetCurrentThreadPoolWorker(pool);
+  NA_Task task;
+
+  while(1){
+    int32 state = naLoadAtomic32(&(group->state), NA_MEMORY_ORDER_SEQ_CST);
+    #if NA_DEBUG
+      if(state & NA_TASK_GROUP_WAITING)
+        naError("Another thread is already waiting for this group.");
+    #endif
+    if(!state){break;}
+
+    // Help executing tasks, whether they belong to the group or not.
+    if(na_FindThreadPoolTask(pool, worker, &task)){
+      na_ExecuteThreadPoolTask(&task);
+      continue;
+    }
+
+    // All remaining tasks of the group are executed by other threads right
+    // now. Sleep until the last of them is done. If the state changed in the
+    // meantime, simply try again.
+    if(naCompareExchangeAtomic32(&(group->state), &state, state | NA_TASK_GROUP_WAITING, NA_MEMORY_ORDER_SEQ_CST)){
+      na_WaitSemaphore(&(group->doneSemaphore));
+      naFetchAddAtomic32(&(group->state), -NA_TASK_GROUP_WAITING, NA_MEMORY_ORDER_SEQ_CST);
+    }
+  }
+}
+
+
+
+// //////////////////////////////////////
+// Parallel loops
+//
+// Every task of a parallel loop processes one NA_ParallelPart. A part
+// stores the range it started with and, for reductions, the partial result
+// directly behind the struct. The task processes its range chunk by chunk
+// from the front. Before every chunk, it checks whether the deque it pushes
+// to is empty, which means that all parts it split off so far have been
+// stolen. Only then, the second half of the remaining range is split off
+// into a new part. Hence, every part covers a contiguous range starting at
+// its origin and the partial results can be combined in the order of their
+// origins.
+
+typedef struct NA_ParallelLoop NA_ParallelLoop;
+typedef struct NA_ParallelPart NA_ParallelPart;
+
+struct NA_ParallelLoop{
+  NAThreadPool* pool;
+  NATaskGroup* group;
+  NAInt grainSize;
+  NAParallelForBody forBody;
+  NAParallelReduceBody reduceBody;
+  void* data;
+  const void* identity;
+  size_t resultByteSize;
+  NA_ParallelPart* finishedParts;
+  size_t finishedPartCount;
+  NAAtomic32 finishedLock;
+};
+
+struct NA_ParallelPart{
+  NA_ParallelLoop* loop;
+  NARangei range;
+  NA_ParallelPart* next;
+};
+
+// The partial result is stored behind the part, aligned like malloc does.
+#define NA_PARALLEL_PART_RESULT_OFFSET ((sizeof(NA_ParallelPart) + 15) & ~(size_t)15)
+
+
+
+NA_HIDEF void* na_GetParallelPartResult(NA_ParallelPart* part){
+  return (NAByte*)part + NA_PARALLEL_PART_RESULT_OFFSET;
+}
+
+
+
+NA_HIDEF NA_ParallelPart* na_NewParallelPart(NA_ParallelLoop* loop, NARangei range){
+  NA_ParallelPart* part = naMalloc(NA_PARALLEL_PART_RESULT_OFFSET + loop->resultByteSize);
+  part->loop = loop;
+  part->range = range;
+  part->next = NA_NULL;
+  if(loop->resultByteSize){
+    naCopyn(na_GetParallelPartResult(part), loop->identity, loop->resultByteSize);
+  }
+  return part;
+}
+
+
+
+// Returns NA_TRUE if the deque the current thread dispatches to is empty.
+NA_HIDEF NABool na_IsCurrentTaskDequeEmpty(NAThreadPool* pool){
+  NA_ThreadPoolWorker* worker = na_GetCurrentThreadPoolWorker(pool);
+  NA_TaskDeque* deque = worker ? &(worker->deque) : &(pool->injectionDeque);
+  NABool isEmpty;
+  na_LockThreadPoolSpinLock(&(deque->lock));
+  isEmpty = (deque->count == 0);
+  na_UnlockThreadPoolSpinLock(&(deque->lock));
+  return isEmpty;
+}
+
+
+
+NA_HIDEF void na_ExecuteParallelChunk(NA_ParallelPart* part, NARangei chunk){
+  NA_ParallelLoop* loop = part->loop;
+  if(loop->forBody){
+    loop->forBody(chunk, loop->data);
+  }else{
+    loop->reduceBody(chunk, na_GetParallelPartResult(part), loop->data);
+  }
+}
+
+
+
+NA_HDEF void na_RunParallelPart(void* arg){
+  NA_ParallelPart* part = (NA_ParallelPart*)arg;
+  NA_ParallelLoop* loop = part->loop;
+  NARangei range = part->range;
+
+  while(range.length > loop->grainSize){
+    if(range.length >= 2 * loop->grainSize && na_IsCurrentTaskDequeEmpty(loop->pool)){
+      NAInt half = range.length / 2;
+      NA_ParallelPart* newPart = na_NewParallelPart(
+        loop,
+        naMakeRangei(range.origin + half, range.length - half));
+      naDispatchGroupTask(loop->group, na_RunParallelPart, newPart);
+      range.length = half;
+    }else{
+      na_ExecuteParallelChunk(part, naMakeRangei(range.origin, loop->grainSize));
+      range.origin += loop->grainSize;
+      range.length -= loop->grainSize;
+    }
+  }
+  na_ExecuteParallelChunk(part, range);
+
+  if(loop->resultByteSize){
+    na_LockThreadPoolSpinLock(&(loop->finishedLock));
+    part->next = loop->finishedParts;
+    loop->finishedParts = part;
+    loop->finishedPartCount++;
+    na_UnlockThreadPoolSpinLock(&(loop->finishedLock));
+  }else{
+    naFree(part);
+  }
+}
+
+
+
+NA_HIDEF int na_CompareParallelParts(const void* a, const void* b){
+  NAInt originA = (*(const NA_ParallelPart**)a)->range.origin;
+  NAInt originB = (*(const NA_ParallelPart**)b)->range.origin;
+  return (originA < originB) ? -1 : ((originA > originB) ? 1 : 0);
+}
+
+
+
+NA_HIDEF void na_RunParallelLoop(NA_ParallelLoop* loop, NARangei range, void* result, NAParallelCombiner combine){
+  NA_ParallelPart* part;
+  #if NA_DEBUG
+    if(loop->grainSize < 0)
+      naError("grainSize must not be negative.");
+    if(range.length < 0)
+      naError("range length must not be negative.");
+  #endif
+  if(range.length <= 0){return;}
+
+  loop->pool = naGetDefaultThreadPool();
+  if(!loop->grainSize){
+    // Aim at eight chunks per thread, counting the calling thread as well.
+    loop->grainSize = range.length / (NAInt)(8 * (naGetThreadPoolWorkerCount(loop->pool) + 1));
+    if(!loop->grainSize){loop->grainSize = 1;}
+  }
+  loop->identity = result;
+  loop->finishedParts = NA_NULL;
+  loop->finishedPartCount = 0;
+  naInitAtomic32(&(loop->finishedLock), 0);
+
+  // The calling thread processes the first part itself.
+  loop->group = naMakeTaskGroup(loop->pool);
+  part = na_NewParallelPart(loop, range);
+  na_RunParallelPart(part);
+  naWaitTaskGroup(loop->group);
+  naClearTaskGroup(loop->group);
+
+  if(loop->resultByteSize){
+    size_t i;
+    NA_ParallelPart** parts = naMalloc(loop->finishedPartCount * sizeof(NA_ParallelPart*));
+    part = loop->finishedParts;
+    for(i = 0; i < loop->finishedPartCount; i++){
+      parts[i] = part;
+      part = part->next;
+    }
+    qsort(parts, loop->finishedPartCount, sizeof(NA_ParallelPart*), na_CompareParallelParts);
+    for(i = 0; i < loop->finishedPartCount; i++){
+      combine(result, na_GetParallelPartResult(parts[i]), loop->data);
+      naFree(parts[i]);
+    }
+    naFree(parts);
+  }
+}
+
+
+
+NA_DEF void naParallelFor(
+  NARangei range,
+  NAInt grainSize,
+  NAParallelForBody body,
+  void* data)
+{
+  NA_ParallelLoop loop;
+  #if NA_DEBUG
+    if(!body)
+      naCrash("body is Null");
+  #endif
+  loop.grainSize = grainSize;
+  loop.forBody = body;
+  loop.reduceBody = NA_NULL;
+  loop.data = data;
+  loop.resultByteSize = 0;
+  na_RunParallelLoop(&loop, range, NA_NULL, NA_NULL);
+}
+
+
+
+NA_DEF void naParallelReduce(
+  NARangei range,
+  NAInt grainSize,
+  void* result,
+  size_t resultByteSize,
+  NAParallelReduceBody body,
+  NAParallelCombiner combine,
+  void* data)
+{
+  NA_ParallelLoop loop;
+  #if NA_DEBUG
+    if(!result)
+      naCrash("result is Null");
+    if(!resultByteSize)
+      naError("resultByteSize is zero.");
+    if(!body)
+      naCrash("body is Null");
+    if(!combine)
+      naCrash("combine is Null");
+  #endif
+  loop.grainSize = grainSize;
+  loop.forBody = NA_NULL;
+  loop.reduceBody = body;
+  loop.data = data;
+  loop.resultByteSize = resultByteSize;
+  na_RunParallelLoop(&loop, range, result, combine);
+}
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
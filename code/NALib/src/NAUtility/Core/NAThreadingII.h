@@ -6,12 +6,27 @@
 
 
 #include "../NAMemory.h"
+#include "../NAAtomic.h"
+
+// Posix threads are used on all systems other than Windows and Mac or when
+// requested with NA_THREADING_USE_PTHREADS.
+#if NA_OS != NA_OS_WINDOWS && (NA_OS != NA_OS_MAC_OS_X || NA_THREADING_USE_PTHREADS)
+  #define NA_USE_PTHREADS 1
+#else
+  #define NA_USE_PTHREADS 0
+#endif
 
 #if NA_OS == NA_OS_WINDOWS
   #include <windows.h>
-#elif NA_OS == NA_OS_MAC_OS_X
+#elif NA_USE_PTHREADS
+  #include <unistd.h>
+  #include <pthread.h>
+  #include <errno.h>
+  #include <time.h>
+#else
   #include <objc/objc.h>
   #include <unistd.h>
+  #include <pthread.h>
   #include <dispatch/dispatch.h>
   // Workaround for XCode 3 where the following macro is not defined:
   #ifndef DISPATCH_QUEUE_SERIAL
@@ -35,7 +50,7 @@ NA_IDEF int naSleepU(size_t microSeconds){
   #if NA_OS == NA_OS_WINDOWS
     Sleep((DWORD)(microSeconds / 1000));
     return 0;
-  #elif NA_OS == NA_OS_MAC_OS_X
+  #else
     return usleep((useconds_t)(microSeconds));
   #endif
 }
@@ -46,7 +61,7 @@ NA_IDEF int naSleepM(size_t milliSeconds){
   #if NA_OS == NA_OS_WINDOWS
     Sleep((DWORD)(milliSeconds));
     return 0;
-  #elif NA_OS == NA_OS_MAC_OS_X
+  #else
     return usleep((useconds_t)(milliSeconds * 1000LL));
   #endif
 }
@@ -57,7 +72,7 @@ NA_IDEF int naSleepS(double seconds){
   #if NA_OS == NA_OS_WINDOWS
     Sleep((DWORD)(seconds * 1000));
     return 0;
-  #elif NA_OS == NA_OS_MAC_OS_X
+  #else
     return usleep((useconds_t)(seconds * 1000000LL));
   #endif
 }
@@ -79,7 +94,9 @@ NA_IDEF int naSleepS(double seconds){
 
 #if NA_OS == NA_OS_WINDOWS
   typedef HANDLE            NANativeThread;
-#elif NA_OS == NA_OS_MAC_OS_X
+#elif NA_USE_PTHREADS
+  typedef pthread_t         NANativeThread;
+#else
   typedef dispatch_queue_t  NANativeThread;
 #endif
 
@@ -99,6 +116,8 @@ NA_IDEF NAThread naMakeThread(const char* threadName, NAMutator function, void*
   threadstruct->name = threadName;
   #if NA_OS == NA_OS_WINDOWS
     threadstruct->nativeThread = NA_NULL; // Note that on windows, creating the thread would immediately start it.
+  #elif NA_USE_PTHREADS
+    // Same with posix threads. The thread is created in naRunThread.
   #else
     threadstruct->nativeThread = dispatch_queue_create(threadName, DISPATCH_QUEUE_SERIAL);
   #endif
@@ -113,6 +132,8 @@ NA_IDEF void naClearThread(NAThread thread){
   NAThreadStruct* threadstruct = (NAThreadStruct*)thread;
   #if NA_OS == NA_OS_WINDOWS
     CloseHandle(threadstruct->nativeThread);
+  #elif NA_USE_PTHREADS
+    // The posix threads are detached and clean up themselves.
   #else
     #if NA_MACOS_USES_ARC
       // Thread will be released automatically when ARC is turned on.
@@ -131,8 +152,41 @@ NA_IDEF void naClearThread(NAThread thread){
   NA_HDEF static DWORD __stdcall na_RunWindowsThread(LPVOID arg){
     NAThreadStruct* thread = (NAThreadStruct*)arg;
     thread->function(thread->arg);
+    #if NA_MEMORY_POOL_THREAD_SAFE
+      // Hand over the memory pools of this thread to the runtime system.
+      naDetachRuntimeThread();
+    #endif
+    #if NA_MALLOC_SIZE_CLASSES
+      naDetachMallocThread();
+    #endif
     return 0;
   }
+#elif NA_USE_PTHREADS
+  // Same for posix threads.
+  NA_HIDEF void* na_RunPosixThread(void* arg){
+    NAThreadStruct* thread = (NAThreadStruct*)arg;
+    thread->function(thread->arg);
+    #if NA_MEMORY_POOL_THREAD_SAFE
+      naDetachRuntimeThread();
+    #endif
+    #if NA_MALLOC_SIZE_CLASSES
+      naDetachMallocThread();
+    #endif
+    return NA_NULL;
+  }
+#else
+  // Same for GCD. The worker threads of GCD are reused for other work items,
+  // hence the memory of this thread is handed over after every function.
+  NA_HIDEF void na_RunGCDThread(void* arg){
+    NAThreadStruct* thread = (NAThreadStruct*)arg;
+    thread->function(thread->arg);
+    #if NA_MEMORY_POOL_THREAD_SAFE
+      naDetachRuntimeThread();
+    #endif
+    #if NA_MALLOC_SIZE_CLASSES
+      naDetachMallocThread();
+    #endif
+  }
 #endif
 
 
@@ -141,8 +195,22 @@ NA_IDEF void naRunThread(NAThread thread){
   NAThreadStruct* threadstruct = (NAThreadStruct*)thread;
   #if NA_OS == NA_OS_WINDOWS
     threadstruct->nativeThread = CreateThread(NULL, 0, na_RunWindowsThread, threadstruct, 0, 0);
+  #elif NA_USE_PTHREADS
+    // The thread is detached as there is no function in NALib waiting for a
+    // thread to end.
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int error = pthread_create(&(threadstruct->nativeThread), &attr, na_RunPosixThread, threadstruct);
+    pthread_attr_destroy(&attr);
+    #if NA_DEBUG
+      if(error)
+        naError("Thread could not be created.");
+    #else
+      NA_UNUSED(error);
+    #endif
   #else
-    dispatch_async_f(threadstruct->nativeThread, threadstruct->arg, threadstruct->function);
+    dispatch_async_f(threadstruct->nativeThread, threadstruct, na_RunGCDThread);
   #endif
 }
 
@@ -178,6 +246,18 @@ NA_IDEF void naRunThread(NAThread thread){
   // the same thread. The author thinks that this is inconsistent and therefore
   // has implemented mutexes like this to be the same on all systems.
 
+#elif NA_USE_PTHREADS
+
+  typedef struct NAPosixMutex NAPosixMutex;
+  struct NAPosixMutex{
+    pthread_mutex_t mutex;
+    #if NA_DEBUG
+      NABool seemslocked;
+    #endif
+  };
+  // When debugging, the mutex checks for errors. Hence locking a mutex twice
+  // on the same thread is detected just like on Windows.
+
 #else
 
   #if NA_DEBUG
@@ -208,6 +288,19 @@ NA_IDEF NAMutex naMakeMutex(void){
       windowsMutex->seemslocked = NA_FALSE;
     #endif
     return windowsMutex;
+  #elif NA_USE_PTHREADS
+    NAPosixMutex* posixMutex = naAlloc(NAPosixMutex);
+    #if NA_DEBUG
+      pthread_mutexattr_t attr;
+      pthread_mutexattr_init(&attr);
+      pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
+      pthread_mutex_init(&(posixMutex->mutex), &attr);
+      pthread_mutexattr_destroy(&attr);
+      posixMutex->seemslocked = NA_FALSE;
+    #else
+      pthread_mutex_init(&(posixMutex->mutex), NA_NULL);
+    #endif
+    return posixMutex;
   #else
 
     #if NA_DEBUG
@@ -233,6 +326,10 @@ NA_IDEF void naClearMutex(NAMutex mutex){
       CloseHandle(windowsMutex->mutex);
     #endif
     naFree(windowsMutex);
+  #elif NA_USE_PTHREADS
+    NAPosixMutex* posixMutex = (NAPosixMutex*)mutex;
+    pthread_mutex_destroy(&(posixMutex->mutex));
+    naFree(posixMutex);
   #else
     #if NA_DEBUG
       NAMacintoshMutex* macintoshmutex = (NAMacintoshMutex*)mutex;
@@ -274,7 +371,18 @@ NA_IDEF void naLockMutex(NAMutex mutex){
     #if NA_DEBUG
       windowsMutex->seemslocked = NA_TRUE;
     #endif
-   #else
+  #elif NA_USE_PTHREADS
+    NAPosixMutex* posixMutex = (NAPosixMutex*)mutex;
+    #if NA_DEBUG
+      if(pthread_mutex_lock(&(posixMutex->mutex)) == EDEADLK){
+        naError("Mutex was already locked by this thread. This is not how Mutexes in NALib work.");
+        return;
+      }
+      posixMutex->seemslocked = NA_TRUE;
+    #else
+      pthread_mutex_lock(&(posixMutex->mutex));
+    #endif
+  #else
     #if NA_DEBUG
       NAMacintoshMutex* macintoshmutex = (NAMacintoshMutex*)mutex;
       dispatch_semaphore_wait(macintoshmutex->mutex, DISPATCH_TIME_FOREVER);
@@ -306,6 +414,15 @@ NA_IDEF void naUnlockMutex(NAMutex mutex){
     #else
       ReleaseMutex(windowsMutex->mutex);
     #endif
+  #elif NA_USE_PTHREADS
+    NAPosixMutex* posixMutex = (NAPosixMutex*)mutex;
+    #if NA_DEBUG
+      posixMutex->seemslocked = NA_FALSE;
+      if(pthread_mutex_unlock(&(posixMutex->mutex)))
+        naError("Mutex was not locked by this thread.");
+    #else
+      pthread_mutex_unlock(&(posixMutex->mutex));
+    #endif
   #else
     #if NA_DEBUG
       NAMacintoshMutex* macintoshmutex = (NAMacintoshMutex*)mutex;
@@ -324,6 +441,9 @@ NA_IDEF void naUnlockMutex(NAMutex mutex){
     #if NA_OS == NA_OS_WINDOWS
       NAWindowsMutex* windowsMutex = (NAWindowsMutex*)mutex;
       return windowsMutex->seemslocked;
+    #elif NA_USE_PTHREADS
+      NAPosixMutex* posixMutex = (NAPosixMutex*)mutex;
+      return posixMutex->seemslocked;
     #else
       NAMacintoshMutex* macintoshmutex = (NAMacintoshMutex*)mutex;
       return macintoshmutex->seemslocked;
@@ -380,6 +500,17 @@ NA_IDEF NABool naTryMutex(NAMutex mutex){
         }
       }
     #endif
+  #elif NA_USE_PTHREADS
+    // Note that trylock also fails if the current thread has locked the
+    // mutex, just as NALib expects.
+    NAPosixMutex* posixMutex = (NAPosixMutex*)mutex;
+    if(pthread_mutex_trylock(&(posixMutex->mutex))){
+      return NA_FALSE;
+    }
+    #if NA_DEBUG
+      posixMutex->seemslocked = NA_TRUE;
+    #endif
+    return NA_TRUE;
   #else
     #if NA_DEBUG
       NAMacintoshMutex* macintoshmutex = (NAMacintoshMutex*)mutex;
@@ -406,7 +537,28 @@ NA_IDEF NABool naTryMutex(NAMutex mutex){
 
 #if NA_OS == NA_OS_WINDOWS
   typedef HANDLE            NANativeAlarm;
-#elif NA_OS == NA_OS_MAC_OS_X
+#elif NA_USE_PTHREADS
+  // With posix threads, an alarm is a condition variable with a flag telling
+  // whether the alarm has been triggered since the waiting thread started to
+  // wait. The flag is guarded by the mutex.
+  typedef struct NAPosixAlarm NAPosixAlarm;
+  struct NAPosixAlarm{
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    NABool triggered;
+  };
+  typedef NAPosixAlarm*     NANativeAlarm;
+
+  // The clock used for the timeouts. Where available, a monotonic clock is
+  // used such that changing the system time does not affect the timeout.
+  #if defined CLOCK_MONOTONIC && NA_OS != NA_OS_MAC_OS_X
+    #define NA_POSIX_ALARM_MONOTONIC 1
+    #define NA_POSIX_ALARM_CLOCK CLOCK_MONOTONIC
+  #else
+    #define NA_POSIX_ALARM_MONOTONIC 0
+    #define NA_POSIX_ALARM_CLOCK CLOCK_REALTIME
+  #endif
+#else
   typedef dispatch_semaphore_t  NANativeAlarm;
 #endif
 
@@ -417,7 +569,19 @@ NA_IDEF NAAlarm naMakeAlarm(void){
   #if NA_OS == NA_OS_WINDOWS
     alarmer = CreateEvent(NULL, FALSE, FALSE, NULL);
     return (NAAlarm)alarmer;
-#else
+  #elif NA_USE_PTHREADS
+    alarmer = naAlloc(NAPosixAlarm);
+    pthread_mutex_init(&(alarmer->mutex), NA_NULL);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    #if NA_POSIX_ALARM_MONOTONIC
+      pthread_condattr_setclock(&attr, NA_POSIX_ALARM_CLOCK);
+    #endif
+    pthread_cond_init(&(alarmer->cond), &attr);
+    pthread_condattr_destroy(&attr);
+    alarmer->triggered = NA_FALSE;
+    return (NAAlarm)alarmer;
+  #else
     alarmer = dispatch_semaphore_create(0);
     return (NAAlarm)NA_COCOA_PTR_OBJC_TO_C(alarmer);
   #endif
@@ -428,6 +592,11 @@ NA_IDEF NAAlarm naMakeAlarm(void){
 NA_IDEF void naClearAlarm(NAAlarm alarmer){
   #if NA_OS == NA_OS_WINDOWS
     CloseHandle(alarmer);
+  #elif NA_USE_PTHREADS
+    NAPosixAlarm* posixAlarm = (NAPosixAlarm*)alarmer;
+    pthread_cond_destroy(&(posixAlarm->cond));
+    pthread_mutex_destroy(&(posixAlarm->mutex));
+    naFree(posixAlarm);
   #else
     #if NA_MACOS_USES_ARC
       NA_UNUSED(alarmer);
@@ -454,6 +623,36 @@ NA_IDEF NABool naAwaitAlarm(NAAlarm alarmer, double maxWaitTime){
       result = WaitForSingleObject(alarmer, (DWORD)(1000. * maxWaitTime));
     }
     return (result == WAIT_OBJECT_0);
+  #elif NA_USE_PTHREADS
+    NAPosixAlarm* posixAlarm = (NAPosixAlarm*)alarmer;
+    #if NA_DEBUG
+      if(maxWaitTime < 0.)
+        naError("maxWaitTime should not be negative. Beware of the zero!");
+    #endif
+    pthread_mutex_lock(&(posixAlarm->mutex));
+    // Triggers before the call are not detected, just like on the other
+    // systems.
+    posixAlarm->triggered = NA_FALSE;
+    if(maxWaitTime == 0){
+      while(!posixAlarm->triggered){
+        pthread_cond_wait(&(posixAlarm->cond), &(posixAlarm->mutex));
+      }
+    }else{
+      struct timespec timeout;
+      clock_gettime(NA_POSIX_ALARM_CLOCK, &timeout);
+      double seconds = (double)timeout.tv_nsec * 1e-9 + maxWaitTime;
+      time_t fullSeconds = (time_t)seconds;
+      timeout.tv_sec += fullSeconds;
+      timeout.tv_nsec = (long)((seconds - (double)fullSeconds) * 1e9);
+      if(timeout.tv_nsec >= 1000000000L){timeout.tv_nsec = 999999999L;}
+      while(!posixAlarm->triggered){
+        if(pthread_cond_timedwait(&(posixAlarm->cond), &(posixAlarm->mutex), &timeout) == ETIMEDOUT){break;}
+      }
+    }
+    NABool result = posixAlarm->triggered;
+    posixAlarm->triggered = NA_FALSE;
+    pthread_mutex_unlock(&(posixAlarm->mutex));
+    return result;
   #else
     long result;
     #if NA_DEBUG
@@ -475,6 +674,12 @@ NA_IDEF NABool naAwaitAlarm(NAAlarm alarmer, double maxWaitTime){
 NA_IDEF void naTriggerAlarm(NAAlarm alarmer){
   #if NA_OS == NA_OS_WINDOWS
     SetEvent(alarmer);
+  #elif NA_USE_PTHREADS
+    NAPosixAlarm* posixAlarm = (NAPosixAlarm*)alarmer;
+    pthread_mutex_lock(&(posixAlarm->mutex));
+    posixAlarm->triggered = NA_TRUE;
+    pthread_cond_signal(&(posixAlarm->cond));
+    pthread_mutex_unlock(&(posixAlarm->mutex));
   #else
     dispatch_semaphore_signal((NA_COCOA_BRIDGE dispatch_semaphore_t)alarmer);
   #endif
@@ -482,6 +687,417 @@ NA_IDEF void naTriggerAlarm(NAAlarm alarmer){
 
 
 
+// ////////////////////////////
+// SEMAPHORES
+// ////////////////////////////
+
+// A counting semaphore used internally to put threads to sleep. Waiting
+// decrements the count and sleeps as long as it is zero. Signaling increments
+// the count and wakes up as many waiting threads.
+
+#if NA_OS == NA_OS_WINDOWS
+  typedef HANDLE NA_Semaphore;
+#elif NA_USE_PTHREADS
+  typedef struct NA_Semaphore NA_Semaphore;
+  struct NA_Semaphore{
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    size_t count;
+  };
+#else
+  typedef dispatch_semaphore_t NA_Semaphore;
+#endif
+
+
+
+NA_HIDEF void na_InitSemaphore(NA_Semaphore* semaphore){
+  #if NA_OS == NA_OS_WINDOWS
+    *semaphore = CreateSemaphore(NULL, 0, 0x7fffffff, NULL);
+  #elif NA_USE_PTHREADS
+    pthread_mutex_init(&(semaphore->mutex), NA_NULL);
+    pthread_cond_init(&(semaphore->cond), NA_NULL);
+    semaphore->count = 0;
+  #else
+    *semaphore = dispatch_semaphore_create(0);
+  #endif
+}
+
+
+
+NA_HIDEF void na_ClearSemaphore(NA_Semaphore* semaphore){
+  #if NA_OS == NA_OS_WINDOWS
+    CloseHandle(*semaphore);
+  #elif NA_USE_PTHREADS
+    pthread_cond_destroy(&(semaphore->cond));
+    pthread_mutex_destroy(&(semaphore->mutex));
+  #else
+    #if NA_MACOS_USES_ARC
+      // Semaphore will be released automatically when ARC is turned on.
+      NA_UNUSED(semaphore);
+    #else
+      dispatch_release(*semaphore);
+    #endif
+  #endif
+}
+
+
+
+NA_HIDEF void na_WaitSemaphore(NA_Semaphore* semaphore){
+  #if NA_OS == NA_OS_WINDOWS
+    WaitForSingleObject(*semaphore, INFINITE);
+  #elif NA_USE_PTHREADS
+    pthread_mutex_lock(&(semaphore->mutex));
+    while(!semaphore->count){
+      pthread_cond_wait(&(semaphore->cond), &(semaphore->mutex));
+    }
+    semaphore->count--;
+    pthread_mutex_unlock(&(semaphore->mutex));
+  #else
+    dispatch_semaphore_wait(*semaphore, DISPATCH_TIME_FOREVER);
+  #endif
+}
+
+
+
+NA_HIDEF void na_SignalSemaphore(NA_Semaphore* semaphore, size_t count){
+  #if NA_OS == NA_OS_WINDOWS
+    ReleaseSemaphore(*semaphore, (LONG)count, NULL);
+  #elif NA_USE_PTHREADS
+    pthread_mutex_lock(&(semaphore->mutex));
+    semaphore->count += count;
+    if(count == 1){
+      pthread_cond_signal(&(semaphore->cond));
+    }else{
+      pthread_cond_broadcast(&(semaphore->cond));
+    }
+    pthread_mutex_unlock(&(semaphore->mutex));
+  #else
+    while(count){
+      dispatch_semaphore_signal(*semaphore);
+      count--;
+    }
+  #endif
+}
+
+
+
+// ////////////////////////////
+// READER-WRITER LOCKS
+// ////////////////////////////
+
+// Windows has slim reader-writer locks. All other systems including Mac
+// provide posix reader-writer locks.
+#if NA_OS == NA_OS_WINDOWS
+  typedef SRWLOCK           NANativeRWLock;
+#else
+  typedef pthread_rwlock_t  NANativeRWLock;
+#endif
+
+
+
+NA_IDEF NARWLock naMakeRWLock(void){
+  NANativeRWLock* rwLock = naAlloc(NANativeRWLock);
+  #if NA_OS == NA_OS_WINDOWS
+    InitializeSRWLock(rwLock);
+  #else
+    pthread_rwlock_init(rwLock, NA_NULL);
+  #endif
+  return rwLock;
+}
+
+
+
+NA_IDEF void naClearRWLock(NARWLock rwLock){
+  #if NA_OS == NA_OS_WINDOWS
+    // Slim reader-writer locks need not be destroyed.
+  #else
+    pthread_rwlock_destroy((NANativeRWLock*)rwLock);
+  #endif
+  naFree(rwLock);
+}
+
+
+
+NA_IDEF void naLockRWLockRead(NARWLock rwLock){
+  #if NA_OS == NA_OS_WINDOWS
+    AcquireSRWLockShared((NANativeRWLock*)rwLock);
+  #else
+    int error = pthread_rwlock_rdlock((NANativeRWLock*)rwLock);
+    #if NA_DEBUG
+      if(error)
+        naError("Could not lock for reading. Is it locked by this thread already?");
+    #else
+      NA_UNUSED(error);
+    #endif
+  #endif
+}
+
+
+
+NA_IDEF void naUnlockRWLockRead(NARWLock rwLock){
+  #if NA_OS == NA_OS_WINDOWS
+    ReleaseSRWLockShared((NANativeRWLock*)rwLock);
+  #else
+    pthread_rwlock_unlock((NANativeRWLock*)rwLock);
+  #endif
+}
+
+
+
+NA_IDEF void naLockRWLockWrite(NARWLock rwLock){
+  #if NA_OS == NA_OS_WINDOWS
+    AcquireSRWLockExclusive((NANativeRWLock*)rwLock);
+  #else
+    int error = pthread_rwlock_wrlock((NANativeRWLock*)rwLock);
+    #if NA_DEBUG
+      if(error)
+        naError("Could not lock for writing. Is it locked by this thread already?");
+    #else
+      NA_UNUSED(error);
+    #endif
+  #endif
+}
+
+
+
+NA_IDEF void naUnlockRWLockWrite(NARWLock rwLock){
+  #if NA_OS == NA_OS_WINDOWS
+    ReleaseSRWLockExclusive((NANativeRWLock*)rwLock);
+  #else
+    pthread_rwlock_unlock((NANativeRWLock*)rwLock);
+  #endif
+}
+
+
+
+NA_IDEF NABool naTryRWLockRead(NARWLock rwLock){
+  #if NA_OS == NA_OS_WINDOWS
+    return TryAcquireSRWLockShared((NANativeRWLock*)rwLock) ? NA_TRUE : NA_FALSE;
+  #else
+    return pthread_rwlock_tryrdlock((NANativeRWLock*)rwLock) ? NA_FALSE : NA_TRUE;
+  #endif
+}
+
+
+
+NA_IDEF NABool naTryRWLockWrite(NARWLock rwLock){
+  #if NA_OS == NA_OS_WINDOWS
+    return TryAcquireSRWLockExclusive((NANativeRWLock*)rwLock) ? NA_TRUE : NA_FALSE;
+  #else
+    return pthread_rwlock_trywrlock((NANativeRWLock*)rwLock) ? NA_FALSE : NA_TRUE;
+  #endif
+}
+
+
+
+// ////////////////////////////
+// ADAPTIVE MUTEXES
+// ////////////////////////////
+
+// The number of times a thread tries to lock before it goes to sleep.
+#define NA_ADAPTIVE_MUTEX_SPIN_COUNT 100
+
+// The count stores the number of threads owning or waiting for the mutex.
+// Every thread increasing the count from a non-zero value goes to sleep and
+// will be woken up by exactly one unlock which hands over the mutex. Spinning
+// only tries to change the count from zero to one.
+typedef struct NA_AdaptiveMutex NA_AdaptiveMutex;
+struct NA_AdaptiveMutex{
+  NAAtomic32 count;
+  NA_Semaphore semaphore;
+};
+
+
+
+NA_IDEF NAAdaptiveMutex naMakeAdaptiveMutex(void){
+  NA_AdaptiveMutex* adaptiveMutex = naAlloc(NA_AdaptiveMutex);
+  naInitAtomic32(&(adaptiveMutex->count), 0);
+  na_InitSemaphore(&(adaptiveMutex->semaphore));
+  return adaptiveMutex;
+}
+
+
+
+NA_IDEF void naClearAdaptiveMutex(NAAdaptiveMutex mutex){
+  NA_AdaptiveMutex* adaptiveMutex = (NA_AdaptiveMutex*)mutex;
+  #if NA_DEBUG
+    if(naLoadAtomic32(&(adaptiveMutex->count), NA_MEMORY_ORDER_RELAXED))
+      naError("Mutex is still locked.");
+  #endif
+  na_ClearSemaphore(&(adaptiveMutex->semaphore));
+  naFree(adaptiveMutex);
+}
+
+
+
+NA_IDEF void naLockAdaptiveMutex(NAAdaptiveMutex mutex){
+  NA_AdaptiveMutex* adaptiveMutex = (NA_AdaptiveMutex*)mutex;
+  int i;
+  for(i = 0; i < NA_ADAPTIVE_MUTEX_SPIN_COUNT; i++){
+    int32 expected = 0;
+    if(naLoadAtomic32(&(adaptiveMutex->count), NA_MEMORY_ORDER_RELAXED) == 0
+      && naCompareExchangeAtomic32(&(adaptiveMutex->count), &expected, 1, NA_MEMORY_ORDER_ACQUIRE)){
+      return;
+    }
+    naPauseAtomic();
+  }
+  if(naFetchAddAtomic32(&(adaptiveMutex->count), 1, NA_MEMORY_ORDER_ACQUIRE) > 0){
+    na_WaitSemaphore(&(adaptiveMutex->semaphore));
+  }
+}
+
+
+
+NA_IDEF void naUnlockAdaptiveMutex(NAAdaptiveMutex mutex){
+  NA_AdaptiveMutex* adaptiveMutex = (NA_AdaptiveMutex*)mutex;
+  int32 prevCount = naFetchAddAtomic32(&(adaptiveMutex->count), -1, NA_MEMORY_ORDER_RELEASE);
+  #if NA_DEBUG
+    if(prevCount <= 0)
+      naError("Mutex was not locked.");
+  #endif
+  if(prevCount > 1){
+    na_SignalSemaphore(&(adaptiveMutex->semaphore), 1);
+  }
+}
+
+
+
+NA_IDEF NABool naTryAdaptiveMutex(NAAdaptiveMutex mutex){
+  NA_AdaptiveMutex* adaptiveMutex = (NA_AdaptiveMutex*)mutex;
+  int32 expected = 0;
+  return naCompareExchangeAtomic32(&(adaptiveMutex->count), &expected, 1, NA_MEMORY_ORDER_ACQUIRE);
+}
+
+
+
+// ////////////////////////////
+// BARRIERS AND LATCHES
+// ////////////////////////////
+
+// A barrier counts the arrived threads. The last thread resets the count,
+// starts the next phase and wakes up all others. Two semaphores are used in
+// turns such that a fast thread arriving in the next phase can not steal a
+// wakeup of a thread still sleeping in the previous phase.
+typedef struct NA_Barrier NA_Barrier;
+struct NA_Barrier{
+  int32 threadCount;
+  NAAtomic32 arrivedCount;
+  NAAtomic32 phase;
+  NA_Semaphore semaphores[2];
+};
+
+// A latch counts down. Threads waiting register in waitingCount which is set
+// to -1 by the thread counting down to zero. This thread wakes up all
+// registered threads. Threads finding -1 do not wait at all.
+typedef struct NA_Latch NA_Latch;
+struct NA_Latch{
+  NAAtomic32 count;
+  NAAtomic32 waitingCount;
+  NA_Semaphore semaphore;
+};
+
+
+
+NA_IDEF NABarrier naMakeBarrier(size_t threadCount){
+  NA_Barrier* barrier;
+  #if NA_DEBUG
+    if(threadCount == 0)
+      naError("threadCount is zero.");
+    if(threadCount > NA_MAX_i32)
+      naError("threadCount is too big.");
+  #endif
+  barrier = naAlloc(NA_Barrier);
+  barrier->threadCount = (int32)threadCount;
+  naInitAtomic32(&(barrier->arrivedCount), 0);
+  naInitAtomic32(&(barrier->phase), 0);
+  na_InitSemaphore(&(barrier->semaphores[0]));
+  na_InitSemaphore(&(barrier->semaphores[1]));
+  return barrier;
+}
+
+
+
+NA_IDEF void naClearBarrier(NABarrier barrier){
+  NA_Barrier* nativeBarrier = (NA_Barrier*)barrier;
+  na_ClearSemaphore(&(nativeBarrier->semaphores[0]));
+  na_ClearSemaphore(&(nativeBarrier->semaphores[1]));
+  naFree(nativeBarrier);
+}
+
+
+
+NA_IDEF NABool naWaitBarrier(NABarrier barrier){
+  NA_Barrier* nativeBarrier = (NA_Barrier*)barrier;
+  // The phase can not change before this thread arrived.
+  int32 phase = naLoadAtomic32(&(nativeBarrier->phase), NA_MEMORY_ORDER_ACQUIRE);
+  NA_Semaphore* semaphore = &(nativeBarrier->semaphores[phase & 1]);
+  int32 arrivedCount = naFetchAddAtomic32(&(nativeBarrier->arrivedCount), 1, NA_MEMORY_ORDER_ACQ_REL) + 1;
+  if(arrivedCount == nativeBarrier->threadCount){
+    naStoreAtomic32(&(nativeBarrier->arrivedCount), 0, NA_MEMORY_ORDER_RELAXED);
+    naStoreAtomic32(&(nativeBarrier->phase), phase + 1, NA_MEMORY_ORDER_RELEASE);
+    na_SignalSemaphore(semaphore, (size_t)(nativeBarrier->threadCount - 1));
+    return NA_TRUE;
+  }else{
+    na_WaitSemaphore(semaphore);
+    return NA_FALSE;
+  }
+}
+
+
+
+NA_IDEF NALatch naMakeLatch(size_t count){
+  NA_Latch* latch;
+  #if NA_DEBUG
+    if(count > NA_MAX_i32)
+      naError("count is too big.");
+  #endif
+  latch = naAlloc(NA_Latch);
+  naInitAtomic32(&(latch->count), (int32)count);
+  naInitAtomic32(&(latch->waitingCount), count ? 0 : -1);
+  na_InitSemaphore(&(latch->semaphore));
+  return latch;
+}
+
+
+
+NA_IDEF void naClearLatch(NALatch latch){
+  NA_Latch* nativeLatch = (NA_Latch*)latch;
+  na_ClearSemaphore(&(nativeLatch->semaphore));
+  naFree(nativeLatch);
+}
+
+
+
+NA_IDEF void naCountDownLatch(NALatch latch){
+  NA_Latch* nativeLatch = (NA_Latch*)latch;
+  int32 prevCount = naFetchAddAtomic32(&(nativeLatch->count), -1, NA_MEMORY_ORDER_ACQ_REL);
+  #if NA_DEBUG
+    if(prevCount <= 0)
+      naError("Latch has already been counted down to zero.");
+  #endif
+  if(prevCount == 1){
+    int32 waitingCount = naExchangeAtomic32(&(nativeLatch->waitingCount), -1, NA_MEMORY_ORDER_ACQ_REL);
+    if(waitingCount > 0){
+      na_SignalSemaphore(&(nativeLatch->semaphore), (size_t)waitingCount);
+    }
+  }
+}
+
+
+
+NA_IDEF void naWaitLatch(NALatch latch){
+  NA_Latch* nativeLatch = (NA_Latch*)latch;
+  int32 waitingCount = naLoadAtomic32(&(nativeLatch->waitingCount), NA_MEMORY_ORDER_ACQUIRE);
+  while(waitingCount >= 0){
+    if(naCompareExchangeAtomic32(&(nativeLatch->waitingCount), &waitingCount, waitingCount + 1, NA_MEMORY_ORDER_ACQ_REL)){
+      na_WaitSemaphore(&(nativeLatch->semaphore));
+      return;
+    }
+  }
+}
+
+
+
 // This is free and unencumbered software released into the public domain.
 
 // Anyone is free to copy, modify, publish, use, compile, sell, or
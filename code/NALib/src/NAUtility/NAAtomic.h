@@ -0,0 +1,163 @@
+
+#ifndef NA_ATOMIC_INCLUDED
+#define NA_ATOMIC_INCLUDED
+#ifdef __cplusplus
+  extern "C"{
+#endif
+
+// Atomics
+//
+// An atomic variable can be read and written by multiple threads at the same
+// time without a mutex. Every operation on it is indivisible: A thread either
+// sees the value before or after an operation of another thread but never a
+// mixture of both.
+//
+// Depending on the compiler, the atomics are implemented with the __atomic
+// builtins of GCC and Clang, the Interlocked functions of WINAPI or the
+// <stdatomic.h> header of C11. See NACompiler.h for the detection of the
+// compiler and the C standard.
+//
+// The atomic types are structs such that they can not be accessed other than
+// with the functions below by accident. Use the init functions to set the
+// initial value before any other thread can see the variable. Static
+// variables can be initialized with zero like any other struct: = {0}.
+//
+// NAAtomic64 is only available if the system has a native 64 bit integer
+// type, which is the case if NA_TYPE_INT64 is defined.
+
+#include "../NABase.h"
+
+typedef struct NAAtomic32 NAAtomic32;
+typedef struct NAAtomic64 NAAtomic64;
+typedef struct NAAtomicPtr NAAtomicPtr;
+
+// The memory order of an atomic operation defines how the reads and writes
+// of the thread before and after the operation are visible to other threads.
+// They mirror the memory orders of C11:
+//
+// NA_MEMORY_ORDER_RELAXED  Only the atomic operation itself is atomic. No
+//                          ordering of any other reads and writes.
+// NA_MEMORY_ORDER_ACQUIRE  Reads and writes after this operation can not
+//                          happen before it. Use it for loads. A thread
+//                          acquiring a value sees all writes which happened
+//                          before a release of that value.
+// NA_MEMORY_ORDER_RELEASE  Reads and writes before this operation can not
+//                          happen after it. Use it for stores.
+// NA_MEMORY_ORDER_ACQ_REL  Both acquire and release. Use it for operations
+//                          which read and write like exchange.
+// NA_MEMORY_ORDER_SEQ_CST  Like acq_rel and additionally, all threads see
+//                          all seq_cst operations in the same order.
+//
+// Loads can not have release semantics and stores can not have acquire
+// semantics. When debugging, an error is emitted in these cases. If you are
+// in doubt, use NA_MEMORY_ORDER_SEQ_CST. On Windows, all operations other
+// than relaxed loads and stores behave like seq_cst.
+typedef enum{
+  NA_MEMORY_ORDER_RELAXED,
+  NA_MEMORY_ORDER_ACQUIRE,
+  NA_MEMORY_ORDER_RELEASE,
+  NA_MEMORY_ORDER_ACQ_REL,
+  NA_MEMORY_ORDER_SEQ_CST
+} NAMemoryOrder;
+
+
+
+// Sets the value without any synchronization. Only use this function when no
+// other thread can access the atomic.
+NA_IAPI void   naInitAtomic32(NAAtomic32* atomic, int32 value);
+
+// Returns the value.
+NA_IAPI int32  naLoadAtomic32(const NAAtomic32* atomic, NAMemoryOrder order);
+
+// Stores the value.
+NA_IAPI void   naStoreAtomic32(NAAtomic32* atomic, int32 value, NAMemoryOrder order);
+
+// Stores the value and returns the value stored before.
+NA_IAPI int32  naExchangeAtomic32(NAAtomic32* atomic, int32 value, NAMemoryOrder order);
+
+// Stores desired if the atomic currently stores the value at expected and
+// returns NA_TRUE. Otherwise, the current value is written to expected and
+// NA_FALSE is returned. If the comparison fails, the operation is a load with
+// acquire semantics if order has acquire semantics and relaxed otherwise.
+NA_IAPI NABool naCompareExchangeAtomic32(
+  NAAtomic32* atomic,
+  int32* expected,
+  int32 desired,
+  NAMemoryOrder order);
+
+// Adds value and returns the value stored before. Use negative values to
+// subtract.
+NA_IAPI int32  naFetchAddAtomic32(NAAtomic32* atomic, int32 value, NAMemoryOrder order);
+
+#if defined NA_TYPE_INT64
+  // The same functions for 64 bits.
+  NA_IAPI void   naInitAtomic64(NAAtomic64* atomic, int64 value);
+  NA_IAPI int64  naLoadAtomic64(const NAAtomic64* atomic, NAMemoryOrder order);
+  NA_IAPI void   naStoreAtomic64(NAAtomic64* atomic, int64 value, NAMemoryOrder order);
+  NA_IAPI int64  naExchangeAtomic64(NAAtomic64* atomic, int64 value, NAMemoryOrder order);
+  NA_IAPI NABool naCompareExchangeAtomic64(
+    NAAtomic64* atomic,
+    int64* expected,
+    int64 desired,
+    NAMemoryOrder order);
+  NA_IAPI int64  naFetchAddAtomic64(NAAtomic64* atomic, int64 value, NAMemoryOrder order);
+#endif
+
+// The same functions for pointers, except for the addition.
+NA_IAPI void   naInitAtomicPtr(NAAtomicPtr* atomic, void* value);
+NA_IAPI void*  naLoadAtomicPtr(const NAAtomicPtr* atomic, NAMemoryOrder order);
+NA_IAPI void   naStoreAtomicPtr(NAAtomicPtr* atomic, void* value, NAMemoryOrder order);
+NA_IAPI void*  naExchangeAtomicPtr(NAAtomicPtr* atomic, void* value, NAMemoryOrder order);
+NA_IAPI NABool naCompareExchangeAtomicPtr(
+  NAAtomicPtr* atomic,
+  void** expected,
+  void* desired,
+  NAMemoryOrder order);
+
+// Orders the reads and writes of this thread around the fence according to
+// order without accessing any atomic. NA_MEMORY_ORDER_RELAXED does nothing.
+NA_IAPI void   naFenceAtomic(NAMemoryOrder order);
+
+// Tells the processor that the current thread is spinning in a loop waiting
+// for an atomic to change, which saves energy and gives resources to other
+// hyperthreads. Call it in every iteration of a spin loop.
+NA_IAPI void   naPauseAtomic(void);
+
+
+
+// Inline implementations are in a separate file:
+#include "Core/NAAtomicII.h"
+
+
+
+#ifdef __cplusplus
+  } // extern "C"
+#endif
+#endif // NA_ATOMIC_INCLUDED
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
@@ -110,6 +110,34 @@ NA_IAPI NABool naEqual128WithBytes(
 
 
 
+// Searches the byteSize bytes at ptr for the given byte and returns a pointer
+// to its first occurrence or, with the Reverse variant, its last occurrence.
+// Returns NA_NULL if the byte does not occur.
+NA_API const NAByte* naSearchBytesForByte(
+  const void* ptr,
+  size_t byteSize,
+  NAByte byte);
+NA_API const NAByte* naSearchBytesForByteReverse(
+  const void* ptr,
+  size_t byteSize,
+  NAByte byte);
+
+// Searches the byteSize bytes at ptr for the first occurrence of the given
+// pattern and returns a pointer to it or NA_NULL if there is none.
+NA_API const NAByte* naSearchBytesForPattern(
+  const void* ptr,
+  size_t byteSize,
+  const void* pattern,
+  size_t patternByteSize);
+
+// The searches compare 32 bytes at once using AVX2 or 16 bytes at once using
+// SSE2 or NEON, depending on what the compiler targets. The pattern search
+// first filters all positions where the first and the last byte of the
+// pattern match before comparing the bytes in between. Without any of these
+// instruction sets, memchr is used to find candidates.
+
+
+
 
 // ////////////////////
 // Endianness
@@ -0,0 +1,113 @@
+
+#ifndef NA_CLOCK_INCLUDED
+#define NA_CLOCK_INCLUDED
+#ifdef __cplusplus
+  extern "C"{
+#endif
+
+// Clock
+//
+// NAClock is a timestamp of a monotonic clock made for measuring durations,
+// for example for benchmarks, profiling and timeouts. The clock never jumps,
+// neither when the user changes the system time nor at leap seconds or
+// daylight saving changes, but its origin is unspecified. Use NADateTime if
+// you need the date and time of the calendar.
+//
+// The clock uses QueryPerformanceCounter on Windows, mach_absolute_time on
+// Mac and clock_gettime with CLOCK_MONOTONIC on all other systems. Its
+// resolution is in the range of nanoseconds to some tens of nanoseconds
+// depending on the system. Making a timestamp only reads the counter, the
+// conversion to seconds or nanoseconds happens when computing differences.
+//
+// Additionally, the cycle counter of the processor can be read directly,
+// which is even cheaper and has the finest resolution available. It is the
+// time stamp counter (TSC) on x86 and x64 and the virtual counter on ARM64.
+// On modern processors, these count with a constant frequency regardless of
+// the current speed of the processor. The frequency is measured once against
+// the monotonic clock the first time it is needed. If the processor or the
+// compiler offers no cycle counter, the nanoseconds of NAClock are returned
+// instead.
+//
+// All functions are only available if the system has a native 64 bit
+// integer type, which is the case if NA_TYPE_INT64 is defined.
+
+#include "../NABase.h"
+
+#if defined NA_TYPE_INT64
+
+// NAClock is a pure pod and does not require a call to naClearXXX.
+// The full type definition is in the file "NAClockII.h"
+typedef struct NAClock NAClock;
+
+
+
+// Returns a timestamp of now.
+NA_IAPI NAClock naMakeClockNow(void);
+
+// Returns the time between start and end in seconds or nanoseconds. The
+// result is negative if end is before start.
+NA_IAPI double  naGetClockDifference           (const NAClock* end, const NAClock* start);
+NA_IAPI int64   naGetClockDifferenceNanoseconds(const NAClock* end, const NAClock* start);
+
+// Returns the time since start in seconds. Same as making a timestamp now
+// and computing the difference.
+NA_IAPI double  naGetClockElapsed(const NAClock* start);
+
+// Returns the nanoseconds of the timestamp since the unspecified origin of
+// the clock, usually the startup of the system. Only use the differences of
+// such values.
+NA_IAPI int64   naGetClockNanoseconds(const NAClock* clock);
+
+
+
+// Returns the current value of the cycle counter.
+NA_IAPI uint64  naGetCycleCount(void);
+
+// Returns the number of cycles per second. The first call measures the
+// frequency which takes about 10 milliseconds. All later calls return the
+// stored value.
+NA_API  double  naGetCycleCountFrequency(void);
+
+// Converts a number of cycles into seconds.
+NA_IAPI double  naGetCycleCountSeconds(uint64 cycleCount);
+
+
+
+// Inline implementations are in a separate file:
+#include "Core/NAClockII.h"
+
+#endif // NA_TYPE_INT64
+
+
+
+#ifdef __cplusplus
+  } // extern "C"
+#endif
+#endif // NA_CLOCK_INCLUDED
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
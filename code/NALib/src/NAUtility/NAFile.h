@@ -7,9 +7,17 @@
 
 
 
-// The typedef needs to be here to resolve cyclic include problems.
+// The typedefs need to be here to resolve cyclic include problems.
 typedef struct NAFile NAFile;
 
+// Tells the system how the memory of a mapped file will be accessed such
+// that it can choose a suitable read-ahead strategy. See naMapFile.
+typedef enum{
+  NA_FILE_ACCESS_DEFAULT,     // No particular order
+  NA_FILE_ACCESS_SEQUENTIAL,  // From the first to the last byte
+  NA_FILE_ACCESS_RANDOM       // At arbitrary positions
+} NAFileAccess;
+
 
 
 // This file contains the declaration of the NAFile structure, which is a
@@ -104,6 +112,7 @@ NA_IAPI NAFileSize  naTell(int fd);
 NA_IAPI int         naOpen    (const char* path, int flags, int mode);
 NA_IAPI int         naClose   (int fd);
 NA_IAPI NAFileSize  naRead    (int fd, void* buf, NAFileSize byteSize);
+NA_IAPI NAFileSize  naPread   (int fd, void* buf, NAFileSize byteSize, NAFileSize byteOffset);
 NA_IAPI NAFileSize  naWrite   (int fd, const void* buf, NAFileSize byteSize);
 NA_IAPI int         naMkDir   (const char* path, int mode);
 NA_IAPI int         naChDir   (const char* path);
@@ -192,6 +201,18 @@ NA_IAPI NAFileSize naReadFileBytes( NAFile* file,
                                       void* buf,
                                  NAFileSize byteSize);
 
+// Reads the given number of bytes starting at the given byteOffset of the
+// file, no matter where the internal file pointer currently is. The internal
+// file pointer may or may not be changed. Unlike naReadFileBytes, this
+// function repeats reading until byteSize bytes are read or the end of the
+// file is reached.
+//
+// Returns the number of bytes read.
+NA_IAPI NAFileSize naReadFileBytesAt(NAFile* file,
+                                       void* buf,
+                                  NAFileSize byteSize,
+                                  NAFileSize byteOffset);
+
 // Writes the given number of bytes from ptr to the file without further
 // manipulation. The buffer must be big enough, no overflow check is made.
 // This is basically just an encapsulating method for naWrite(). Have a look
@@ -203,6 +224,49 @@ NA_IAPI NAFileSize naWriteFileBytes(  NAFile* file,
                                   const void* ptr,
                                    NAFileSize byteSize);
 
+// Writes count chunks of bytes one after another to the file. Chunk i starts
+// at ptrs[i] and has byteSizes[i] bytes. Chunks with zero bytes are allowed.
+// On Mac, the chunks are handed to the system in batches using writev which
+// requires only one system call per batch. On Windows, small chunks are
+// collected in a temporary buffer before being written. Writing stops at the
+// first write the system can not complete, hence the bytes written always
+// are the first bytes of the chunks.
+//
+// Returns the total number of bytes written.
+NA_API NAFileSize naWriteFileBytesGathered(NAFile* file,
+                                     const void* const* ptrs,
+                                    const size_t* byteSizes,
+                                           size_t count);
+
+
+
+// ///////////////////////////////////////////
+// File mappings
+//
+// Instead of reading a file, its contents can be mapped into memory. The
+// system then loads the pages of the file only when they are accessed and
+// can drop them again when memory gets scarce.
+//
+// The mapping is copy-on-write: The memory is mutable but any change stays
+// private to the process and never reaches the file.
+
+// Maps the whole file at the given path into memory and returns a pointer to
+// the first byte. The size of the file is stored in byteSize. Returns NA_NULL
+// if the file could not be mapped, for example because it does not exist,
+// is empty or is not a regular file.
+NA_API void* naMapFile(         const char* filePath,
+                                     size_t* byteSize,
+                                NAFileAccess access);
+
+// Unmaps a file mapped with naMapFile. The byteSize must be the one which
+// naMapFile returned.
+NA_API void naUnmapFile(void* data, size_t byteSize);
+
+// Tells the system that the given bytes of a mapped file will be accessed
+// soon. The system starts reading them in the background and returns
+// immediately.
+NA_API void naPrefetchFileMapping(void* data, size_t byteSize);
+
 
 // //////////////////////////
 // General input and output methods
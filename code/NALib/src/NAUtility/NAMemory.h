@@ -92,6 +92,9 @@ NA_IAPI size_t naGetSystemMemoryPagesizeMask(void);
 // naFree               Deallocates a pointer previously allocated with one of
 //                      the above functions or the default C memory allocation
 //                      functions like malloc.
+// naDetachMallocThread Tells naMalloc that the current thread will no longer
+//                      allocate memory. Only needed when the size classes are
+//                      in use, see below.
 //
 // naMallocAligned      The given byteSize is allocated and the returned pointer
 //                      is guaranteed to be aligned on the given bound. Such
@@ -107,7 +110,7 @@ NA_IAPI size_t naGetSystemMemoryPagesizeMask(void);
 //                      You always free aligned what you alloced aligned. See
 //                      implementation for more details.
 //
-// naMallocTmp          Allocates the given number of bytes with malloc and
+// naMallocTmp          Allocates the given number of bytes from an NAArena and
 //                      returns it as a mutable void pointer but is owned by
 //                      the runtime system and will be freed automatically
 //                      during a call to naCollectGarbage. Do not expect the
@@ -119,6 +122,25 @@ NA_IAPI size_t naGetSystemMemoryPagesizeMask(void);
 //                      custom runtime system described further below.
 // naDelete             Deletes a pointer created with naNew by properly
 //                      calling the correct destructor.
+// naNewBatch           Allocates count objects of the given type at once and
+// naCreateBatch        stores the pointers in the given array. Use these when
+//                      creating many objects in a row as the pool is only
+//                      looked up once per part and consecutive spaces are
+//                      handed out in one run. naCreateBatch is to be used
+//                      for reference-counting types.
+// naDeleteBatch        Deletes count pointers created with naNewBatch or
+//                      naNew. Pointers belonging to the same pool part are
+//                      given back at once, hence sorting the pointers by
+//                      address or keeping them in allocation order helps.
+//
+// Size classes:
+// When NA_MALLOC_SIZE_CLASSES is set to 1 in NAConfiguration.h, naMalloc
+// serves byte sizes up to 4096 from pool parts just like naNew, which is a
+// lot faster for many short-lived small allocations. Such pointers MUST be
+// freed with naFree, never with free. Every thread gets its own parts. When a
+// thread ends, call naDetachMallocThread such that another thread can reuse
+// its parts. Pointers allocated by a detached thread can still be freed by
+// any thread.
 //
 // Authors note:
 // Having only a handful allocation function helps detecting basic memory
@@ -131,6 +153,7 @@ NA_IAPI size_t naGetSystemMemoryPagesizeMask(void);
 NA_IAPI void* naMalloc             (size_t byteSize);
 #define       naAlloc              (type)
 NA_IAPI void  naFree               (void* ptr);
+NA_API  void  naDetachMallocThread (void);
 
 NA_IAPI void* naMallocAligned      (size_t byteSize, size_t align);
 NA_IAPI void* naMallocPageAligned  (size_t byteSize);
@@ -139,6 +162,9 @@ NA_IAPI void  naFreeAligned        (void* ptr);
 NA_API  void* naMallocTmp          (size_t byteSize);
 #define       naNew                (type)
 NA_API  void  naDelete             (void* pointer);
+#define       naNewBatch           (type, pointers, count)
+#define       naCreateBatch        (type, pointers, count)
+NA_API  void  naDeleteBatch        (void** pointers, size_t count);
 
 NA_API  void* naRetain             (void* pointer);
 NA_API  void  naRelease            (void* pointer);
@@ -173,6 +199,12 @@ typedef struct NARefCount NARefCount;
 // Initializes an NARefCount.
 NA_IAPI NARefCount* naInitRefCount(     NARefCount* refCount);
 
+// Initializes an NARefCount which can be retained and released from multiple
+// threads at the same time. Only has an effect if NA_ATOMIC_REFCOUNT is 1.
+// If it is 0, this function behaves like naInitRefCount, if it is 2, all
+// reference counts are atomic anyway. See NAConfiguration.h
+NA_IAPI NARefCount* naInitRefCountAtomic(NARefCount* refCount);
+
 // Returns true if the NATRefCount has reached zero.
 NA_IAPI NABool naIsRefCountZero(        NARefCount* refCount);
 
@@ -398,6 +430,59 @@ NA_IAPI       void* naGetPointerMutable(      NAPointer* pointer);
 
 
 
+// ////////////////////////
+// NAArena
+// ////////////////////////
+
+// An NAArena is a region of memory from which many small allocations can be
+// made very fast by simply moving a pointer forward. The memory of a single
+// allocation can not be freed. Instead, all allocations made after a certain
+// point in time are freed at once.
+//
+// To do so, call naPushArenaMark which returns a mark storing the current
+// state of the arena. Later on, calling naPopArenaMark with that mark frees
+// all memory allocated in the meantime. Marks can be nested like scopes but
+// must be popped in the reverse order they had been pushed. naResetArena
+// frees all allocations of the arena.
+//
+// The memory is taken from the system in blocks of the given byteSize.
+// Requests larger than that get a block on their own. One empty block is kept
+// for reuse, hence pushing and popping around the end of a block does not
+// result in freeing and allocating memory over and over again. Only
+// naClearArena frees all of the memory.
+//
+// All returned pointers are aligned like pointers returned by malloc.
+//
+// Note that naMallocTmp uses an NAArena for the temporary memory of each
+// thread. See runtime system below.
+
+// The full type definitions are in the file "NAMemoryII.h"
+typedef struct NAArena NAArena;
+typedef struct NAArenaMark NAArenaMark;
+
+// Initializes and clears an arena. The blockByteSize must not be zero.
+NA_API  NAArena*    naInitArena(NAArena* arena, size_t blockByteSize);
+NA_API  void        naClearArena(NAArena* arena);
+
+// Returns byteSize bytes of uninitialized memory from the arena.
+NA_IAPI void*       naMallocArena(NAArena* arena, size_t byteSize);
+
+// Stores the current state of the arena and goes back to such a state,
+// freeing all memory allocated since the mark had been pushed.
+NA_IAPI NAArenaMark naPushArenaMark(const NAArena* arena);
+NA_API  void        naPopArenaMark(NAArena* arena, NAArenaMark mark);
+
+// Frees all allocations but keeps one block of memory for reuse.
+NA_API  void        naResetArena(NAArena* arena);
+
+// Returns the number of bytes currently allocated from the arena and the
+// maximum number of bytes ever allocated at the same time.
+NA_IAPI size_t      naGetArenaByteSize(const NAArena* arena);
+NA_IAPI size_t      naGetArenaMaxByteSize(const NAArena* arena);
+
+
+
+
 // //////////////////////
 // Runtime system
 // //////////////////////
@@ -407,18 +492,113 @@ NA_IAPI       void* naGetPointerMutable(      NAPointer* pointer);
 // the end.
 //
 // Additionally, you can call naCollectGarbage to collect all temporary memory
-// which had been allocated with naMallocTmp.
+// which had been allocated with naMallocTmp. Each thread has its own memory
+// for naMallocTmp. naCollectGarbage and naGetRuntimeGarbageByteSize only work
+// on the memory of the calling thread.
 
 NA_API  void   naStartRuntime(void);
 NA_API  void   naStopRuntime(void);
 NA_IAPI NABool naIsRuntimeRunning(void);
 
 NA_API  void   naCollectGarbage(void);
-NA_IAPI size_t naGetRuntimeGarbageByteSize(void);
+NA_API  size_t naGetRuntimeGarbageByteSize(void);
 
 NA_IAPI size_t naGetRuntimeMemoryPageSize(void);
 NA_IAPI size_t naGetRuntimePoolPartSize(void);
 
+// Pool parts which become empty are kept in a cache shared by all types, up
+// to NA_MEMORY_POOL_SPARE_PART_COUNT parts. This function frees all of them.
+// Call it when your application is idle or memory is short.
+NA_API  void   naTrimRuntimeSpareParts(void);
+
+// When NA_MEMORY_POOL_THREAD_SAFE is set to 1, any thread can use naNew,
+// naCreate and naDelete concurrently. Retaining and releasing the same object
+// from multiple threads is only safe if its reference count is atomic, see
+// NA_RUNTIME_TYPE_ATOMIC and NA_ATOMIC_REFCOUNT. Each thread gets its own
+// pool parts upon its first allocation. Call naDetachRuntimeThread
+// at the end of a thread which used the runtime in order to hand its pool
+// parts over to the next thread which needs them. Threads started with
+// naRunThread on Windows do this automatically. Calling it on a thread which
+// never allocated anything does nothing. Pointers can be deleted on
+// any thread, also after the allocating thread has been detached.
+//
+// When NA_MEMORY_POOL_THREAD_SAFE is 0, this function does nothing.
+// naStartRuntime and naStopRuntime must always be called when no other
+// thread uses the runtime.
+NA_API  void   naDetachRuntimeThread(void);
+
+// The runtime can report how much memory its types use. naGetRuntimeStats
+// fills the given struct with the sums over all registered types and the
+// memory allocated with naMallocTmp. naIterateRuntimeTypeStats calls the
+// given callback once for every registered type with its own stats. This
+// allows you to find out which structures bloat memory without an external
+// heap profiler.
+//
+// objectCount      The number of objects currently alive.
+// capacityCount    The number of objects the current parts could hold.
+// partCount        The number of pool parts currently in use.
+// maxPartCount     The maximal number of pool parts used at the same time.
+// bytesReserved    The bytes occupied by the pool parts.
+// bytesUsed        The bytes occupied by the alive objects.
+// fragmentation    The fraction of the capacity not being used. 0 means all
+//                  parts are full, values near 1 mean the parts are mostly
+//                  empty.
+// typeSize         The byte size of one object, including the reference
+//                  counter for reference-counting types.
+//
+// The high water marks are reset with naStopRuntime. Note that objects which
+// have been deleted by a foreign thread in NA_MEMORY_POOL_THREAD_SAFE mode
+// are counted as alive until the owning thread recycles them. Also, the
+// counts of other threads may be slightly outdated. The callback is not
+// called while the runtime is locked, hence you can allocate inside.
+typedef struct NARuntimeStats NARuntimeStats;
+struct NARuntimeStats{
+  size_t typeCount;
+  size_t objectCount;
+  size_t capacityCount;
+  size_t partCount;
+  size_t bytesReserved;
+  size_t bytesUsed;
+  double fragmentation;
+  size_t sparePartCount;       // Empty parts kept for reuse
+  size_t garbageByteCount;     // Current bytes allocated with naMallocTmp
+  size_t maxGarbageByteCount;  // Maximal bytes allocated with naMallocTmp
+};
+
+typedef struct NARuntimeTypeStats NARuntimeTypeStats;
+struct NARuntimeTypeStats{
+  const char* typeName;
+  size_t typeSize;
+  size_t objectCount;
+  size_t capacityCount;
+  size_t partCount;
+  size_t maxPartCount;
+  size_t bytesReserved;
+  size_t maxBytesReserved;
+  size_t bytesUsed;
+  double fragmentation;
+};
+
+typedef void (*NARuntimeTypeStatsCallback)(const NARuntimeTypeStats* typeStats, void* data);
+
+NA_API  void   naGetRuntimeStats(NARuntimeStats* stats);
+NA_API  void   naIterateRuntimeTypeStats(
+  NARuntimeTypeStatsCallback callback,
+  void* data);
+
+// When NA_MEMORY_TRACE is set to 1 in NAConfiguration.h, every allocation
+// with naMalloc, naAlloc, naMallocAligned, naMallocPageAligned, naMallocTmp,
+// naNew, naCreate and their batch versions is recorded together with the
+// file and line it was called from. naPrintMemoryTrace prints a summary for
+// every call site with the number of allocations and frees, the total bytes
+// and the peak of bytes alive at the same time. Afterwards, it lists all
+// allocations which are still alive together with their call site.
+//
+// naStopRuntime prints the trace automatically. The allocations listed there
+// are the leaks of the runtime types as well as all naMalloc allocations not
+// freed yet. Without NA_MEMORY_TRACE, naPrintMemoryTrace does nothing.
+NA_API  void   naPrintMemoryTrace(void);
+
 // In order to work with specific types, each type trying to use the runtime
 // system needs to register itself to the runtime system upon compile time.
 // This is achieved by defining a very specific variable of type NATypeInfo.
@@ -427,6 +607,13 @@ NA_IAPI size_t naGetRuntimePoolPartSize(void);
 
 #define NA_RUNTIME_TYPE(typeName, destructor, refCounting)
 
+// Reference-counting types whose objects shall be retained and released from
+// multiple threads can use NA_RUNTIME_TYPE_ATOMIC instead. The reference count
+// of every object created with naCreate will be initialized with
+// naInitRefCountAtomic.
+
+#define NA_RUNTIME_TYPE_ATOMIC(typeName, destructor)
+
 // But note that this macro results in a variable definition and hence must be
 // written in an implementation file (.c). Also, the type must not be opaque
 // and the destructor must be declared before this macro.
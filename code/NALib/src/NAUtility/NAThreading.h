@@ -7,13 +7,15 @@
 
 #include "NABase.h"
 #include <stdlib.h>
+#include "../NAMath/NACoord.h"
 
 // Threading, Sleeping
 //
 // Note that in NALib, on Windows, the native threading functions of WINAPI are
-// used. On Mac, Grand Central Dispatch (GCD) is used. In the future, there
-// might be implementations planned for posix- as well as for C11-Threads. But
-// so far, they are not implemented yet.
+// used. On Mac, Grand Central Dispatch (GCD) is used. On all other systems
+// like Linux, posix threads (pthreads) are used. You can use posix threads on
+// Mac as well by setting NA_THREADING_USE_PTHREADS to 1. C11-Threads are not
+// implemented.
 
 // Threading works differently on many systems and many frameworks. The data
 // structures used are also completely different. Therefore, all datatypes here
@@ -21,6 +23,10 @@
 typedef void* NAThread;
 typedef void* NAMutex;
 typedef void* NAAlarm;
+typedef void* NARWLock;
+typedef void* NAAdaptiveMutex;
+typedef void* NABarrier;
+typedef void* NALatch;
 
 
 
@@ -145,6 +151,210 @@ NA_IAPI void naTriggerAlarm(NAAlarm alarm);
 
 
 
+// //////////////////////////////////
+// Reader-writer lock
+//
+// A reader-writer lock can be locked by any number of readers at the same
+// time or by exactly one writer. Use it for structures which are read often
+// and changed rarely. Whether waiting writers are preferred over new readers
+// depends on the system. A thread must not lock an NARWLock it already has
+// locked, neither for reading nor for writing.
+
+// Creates and clears a reader-writer lock.
+NA_IAPI NARWLock naMakeRWLock(void);
+NA_IAPI void naClearRWLock(NARWLock rwLock);
+
+// Locks and unlocks for reading. Waits while a writer has the lock.
+NA_IAPI void naLockRWLockRead(NARWLock rwLock);
+NA_IAPI void naUnlockRWLockRead(NARWLock rwLock);
+
+// Locks and unlocks for writing. Waits while anyone else has the lock.
+NA_IAPI void naLockRWLockWrite(NARWLock rwLock);
+NA_IAPI void naUnlockRWLockWrite(NARWLock rwLock);
+
+// Tries to lock but returns immediately. Returns NA_TRUE if the lock was
+// successful and NA_FALSE otherwise.
+NA_IAPI NABool naTryRWLockRead(NARWLock rwLock);
+NA_IAPI NABool naTryRWLockWrite(NARWLock rwLock);
+
+
+
+// //////////////////////////////////
+// Adaptive mutex
+//
+// An adaptive mutex behaves like a mutex but is made for very short critical
+// sections. A thread finding the mutex locked first spins for a short while,
+// expecting the mutex to be unlocked soon. Only then, it goes to sleep. If
+// the mutex is not contended, locking and unlocking does not call the system
+// at all. Do not lock an adaptive mutex twice on the same thread.
+
+// Creates and clears an adaptive mutex.
+NA_IAPI NAAdaptiveMutex naMakeAdaptiveMutex(void);
+NA_IAPI void naClearAdaptiveMutex(NAAdaptiveMutex mutex);
+
+// Locks and unlocks the mutex. Waiting threads wait forever.
+NA_IAPI void naLockAdaptiveMutex(NAAdaptiveMutex mutex);
+NA_IAPI void naUnlockAdaptiveMutex(NAAdaptiveMutex mutex);
+
+// Tries to lock the mutex without spinning or waiting. Returns NA_TRUE if the
+// lock was successful and NA_FALSE otherwise.
+NA_IAPI NABool naTryAdaptiveMutex(NAAdaptiveMutex mutex);
+
+
+
+// //////////////////////////////////
+// Barrier and Latch
+//
+// A barrier lets a fixed number of threads wait for each other. Every thread
+// calling naWaitBarrier waits until all threads have called it. Then, all of
+// them continue and the barrier can be used again for the next phase.
+//
+// A latch is a counter which is counted down by any thread. Threads calling
+// naWaitLatch wait until the counter reaches zero. A latch can only be used
+// once.
+//
+// Only clear a barrier or a latch after all threads have returned from
+// waiting on it.
+
+// Creates and clears a barrier for the given number of threads.
+NA_IAPI NABarrier naMakeBarrier(size_t threadCount);
+NA_IAPI void naClearBarrier(NABarrier barrier);
+
+// Waits until threadCount threads have called this function. Returns NA_TRUE
+// for exactly one of the threads of every phase and NA_FALSE for all others,
+// which can be used to let one thread do some serial work between phases.
+NA_IAPI NABool naWaitBarrier(NABarrier barrier);
+
+// Creates and clears a latch with the given count.
+NA_IAPI NALatch naMakeLatch(size_t count);
+NA_IAPI void naClearLatch(NALatch latch);
+
+// Decreases the count by one. The count must not go below zero.
+NA_IAPI void naCountDownLatch(NALatch latch);
+
+// Waits until the count reached zero. Returns immediately if it already is.
+NA_IAPI void naWaitLatch(NALatch latch);
+
+
+
+// //////////////////////////////////
+// Thread pool
+//
+// A thread pool is a fixed set of worker threads executing tasks. A task is
+// a function with an argument, just like the function of a thread. Instead of
+// creating a thread for every piece of parallel work, all work is dispatched
+// to a pool which keeps its workers busy for as long as there are tasks.
+//
+// Every worker owns a queue of tasks. Tasks dispatched from within a task are
+// put into the queue of the executing worker where they are executed last in,
+// first out, which keeps the data touched by a task hot in the cache. Tasks
+// dispatched by any other thread are put into a queue shared by all workers.
+// A worker running out of tasks steals the oldest task of another worker.
+// Workers which have nothing to do sleep until new tasks are dispatched.
+//
+// The order in which tasks are executed is undefined. If you need to know
+// when a set of tasks has been executed, use a task group.
+
+typedef struct NAThreadPool NAThreadPool;
+typedef struct NATaskGroup NATaskGroup;
+
+// Returns the number of processors available to the process, which is the
+// number of threads which can truly run in parallel.
+NA_API size_t naGetSystemProcessorCount(void);
+
+// Creates and clears a thread pool with the given number of workers. If
+// workerCount is 0, the number of processors is used. Clearing a pool waits
+// until all tasks dispatched to it have been executed. Do not dispatch tasks
+// to a pool being cleared from any thread other than its workers.
+NA_API NAThreadPool* naMakeThreadPool(size_t workerCount);
+NA_API void naClearThreadPool(NAThreadPool* pool);
+
+// Returns a pool with one worker per processor, shared by everyone. The pool
+// is created upon the first call and exists until the program ends. Use this
+// pool unless you have a good reason not to.
+NA_API NAThreadPool* naGetDefaultThreadPool(void);
+
+// Returns the number of workers of the pool.
+NA_API size_t naGetThreadPoolWorkerCount(const NAThreadPool* pool);
+
+// Dispatches the given task to the pool and returns immediately. The task
+// will be called with arg on one of the workers. arg is NOT owned by the pool.
+NA_API void naDispatchTask(NAThreadPool* pool, NAMutator task, void* arg);
+
+// Creates and clears a task group. A task group counts the tasks dispatched
+// with naDispatchGroupTask which have not been executed yet. A group must not
+// be cleared before all of its tasks have been executed, for example by
+// calling naWaitTaskGroup.
+NA_API NATaskGroup* naMakeTaskGroup(NAThreadPool* pool);
+NA_API void naClearTaskGroup(NATaskGroup* group);
+
+// Dispatches the given task to the pool of the group and adds it to the
+// group. Tasks of a group may dispatch further tasks to the same group.
+NA_API void naDispatchGroupTask(
+  NATaskGroup* group,
+  NAMutator task,
+  void* arg);
+
+// Returns when all tasks of the group have been executed. While waiting, the
+// calling thread executes tasks of the pool itself, therefore it is safe to
+// wait for a group from within a task. Only one thread at a time may wait for
+// a specific group. After returning, the group can be reused.
+NA_API void naWaitTaskGroup(NATaskGroup* group);
+
+
+
+// //////////////////////////////////
+// Parallel loops
+//
+// The following functions divide an index range into chunks and execute the
+// chunks in parallel on the default thread pool. The calling thread takes
+// part in the work and the functions return when the whole range has been
+// processed.
+//
+// The range is split adaptively: A thread processes its range chunk by chunk
+// and only splits off the second half of the remaining range if the halves it
+// split off before have been stolen by other workers. Therefore, the number of
+// chunks stays low when all workers are busy and ranges are split finely when
+// workers are idle. No chunk is ever smaller than the grain size except for
+// the last one. If grainSize is 0, a grain size is chosen such that there are
+// a few chunks for every worker. Choose a larger grain size if the body does
+// very little work per index.
+//
+// The body may be called with any subrange of the given range in any order on
+// any thread. Do not make assumptions about the size of the subranges.
+
+typedef void (*NAParallelForBody)(NARangei range, void* data);
+
+// result: Where the body accumulates its values of the given range.
+typedef void (*NAParallelReduceBody)(NARangei range, void* result, void* data);
+
+// Combines partial with result and stores it in result. partial contains the
+// result of a range immediately following the range of result.
+typedef void (*NAParallelCombiner)(void* result, const void* partial, void* data);
+
+// Calls body for subranges covering the whole range. data is passed to body.
+NA_API void naParallelFor(
+  NARangei range,
+  NAInt grainSize,
+  NAParallelForBody body,
+  void* data);
+
+// Computes the reduction of the range. When calling, result must contain the
+// identity value of the combiner, for example 0 for a sum. Every subrange is
+// accumulated into its own copy of that identity value of resultByteSize
+// bytes. The partial results are combined in the order of their ranges,
+// hence the combiner must be associative but not necessarily commutative.
+NA_API void naParallelReduce(
+  NARangei range,
+  NAInt grainSize,
+  void* result,
+  size_t resultByteSize,
+  NAParallelReduceBody body,
+  NAParallelCombiner combine,
+  void* data);
+
+
+
 
 
 
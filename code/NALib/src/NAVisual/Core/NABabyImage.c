@@ -74,7 +74,7 @@ NA_DEF NABabyImage* naCreateBabyImage(NASizei size, const NABabyColor color){
       naError("inanoSecondure color given");
   #endif
   image = naAlloc(NABabyImage);
-  naInitRefCount(&image->refCount);
+  naInitRefCountAtomic(&image->refCount);
   image->width = (int32)size.width;
   image->height = (int32)size.height;
   image->data = naMalloc(na_GetBabyImageDataSize(image));
@@ -99,7 +99,7 @@ NA_HDEF NABabyImage* naCreateBabyImageCopy(const NABabyImage* image){
     naCrash("given image is a Null pointer");
   #endif
   newImage = naAlloc(NABabyImage);
-  naInitRefCount(&newImage->refCount);
+  naInitRefCountAtomic(&newImage->refCount);
   newImage->width = image->width;
   newImage->height = image->height;
   size_t dataSize = na_GetBabyImageDataSize(newImage);
@@ -573,14 +573,18 @@ NA_DEF void naFillBufferWithZLIBCompression(NABuffer* output, NABuffer* input, N
   curOffset = 0;
   while(byteSize > 0){
     uint16 curByteSize;
-    NAByte headbyte = (0 << 1);
+    NABool isFinal;
     if(byteSize >= (1 << 15)){
       curByteSize = (1 << 15) - 1;
+      isFinal = NA_FALSE;
     }else{
       curByteSize = (uint16)byteSize;
-      headbyte |= 1;
+      isFinal = NA_TRUE;
     }
-    naWriteBufferu8(&iterOut, headbyte);
+    // Block header: BFINAL and BTYPE 00 (stored), padded to the next byte.
+    naWriteBufferBits(&iterOut, (uint32)isFinal, 1);
+    naWriteBufferBits(&iterOut, 0, 2);
+    naFlushBufferBits(&iterOut);
     naWriteBufferu16(&iterOut, curByteSize);
     naWriteBufferu16(&iterOut, ~curByteSize);
     naWriteBufferBuffer(&iterOut, input, naMakeRangei(curOffset, curByteSize));
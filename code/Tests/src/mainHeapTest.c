@@ -5,6 +5,7 @@
 //#include NA_TEST_NALIB_PATH(NAHeap.h)
 //#include NA_TEST_NALIB_PATH(NAHeap.h)
 //#include NA_TEST_NALIB_PATH(NARandom.h)
+//#include NA_TEST_NALIB_PATH(NAClock.h)
 //
 //#define TESTSIZE    1000000
 //#define SUBTESTSIZE  10000.
@@ -19,12 +20,12 @@
 //}
 //
 //void testQSort(double* keys){
-//  NADateTime t1, t2;
+//  NAClock t1, t2;
 //
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  qsort(keys, TESTSIZE, sizeof(keys[0]), compare);
-//  t2 = naMakeDateTimeNow();
-//  printf("QSort: %f" NA_NL, naGetDateTimeDifference(&t2, &t1));
+//  t2 = naMakeClockNow();
+//  printf("QSort: %f" NA_NL, naGetClockDifference(&t2, &t1));
 //
 //}
 //
@@ -32,20 +33,20 @@
 //
 //void testHeap(const double* keys){
 //  NAHeap heap;
-//  NADateTime t1;
-//  NADateTime t2;
-//  NADateTime t3;
+//  NAClock t1;
+//  NAClock t2;
+//  NAClock t3;
 //  int i;
 //  double prevkey = 0.;
 //
 //  naInitHeap(&heap, -1, NA_HEAP_USES_DOUBLE_KEY);
 //  
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  for(i = 0; i < TESTSIZE; i++){
 //    naInsertHeapElementConst(&heap, &(keys[i]), &(keys[i]), NA_NULL);
 //  }
 //
-//  t2 = naMakeDateTimeNow();
+//  t2 = naMakeClockNow();
 //
 //  for(i = 0; i < TESTSIZE; i++){
 //    const double* curkey = naRemoveHeapRootConst(&heap);
@@ -56,10 +57,10 @@
 ////    printf("%f" NA_NL, *curkey);
 //  }
 //
-//  t3 = naMakeDateTimeNow();
+//  t3 = naMakeClockNow();
 //
-//  printf("Heap Insert: %f" NA_NL, naGetDateTimeDifference(&t2, &t1));
-//  printf("Heap Iterate: %f" NA_NL, naGetDateTimeDifference(&t3, &t2));
+//  printf("Heap Insert: %f" NA_NL, naGetClockDifference(&t2, &t1));
+//  printf("Heap Iterate: %f" NA_NL, naGetClockDifference(&t3, &t2));
 //
 //  naClearHeap(&heap);
 //}
@@ -69,14 +70,14 @@
 //void testTree(){
 //  NATreeConfiguration* config = naCreateTreeConfiguration(NA_TREE_KEY_DOUBLE | NA_TREE_BALANCE_AVL);
 //  NATree tree;
-//  NADateTime t1, t2;
+//  NAClock t1, t2;
 //  NATreeIterator iter;
 //  int i;
 //  double prevkey = -1.;
 //
 //  naInitTree(&tree, config); 
 //
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  iter = naMakeTreeModifier(&tree);
 //  for(i = 0; i < TESTSIZE; i++){
 ////    NAInt key = (NAInt)(naUniformRandZE() * TESTSIZE);
@@ -87,10 +88,10 @@
 //    naAddTreeKeyConst(&iter, &key, NA_NULL, NA_TRUE);
 //  }
 //  naClearTreeIterator(&iter);
-//  t2 = naMakeDateTimeNow();
-//  printf("Tree Insert: %f" NA_NL, naGetDateTimeDifference(&t2, &t1));
+//  t2 = naMakeClockNow();
+//  printf("Tree Insert: %f" NA_NL, naGetClockDifference(&t2, &t1));
 //
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  iter = naMakeTreeAccessor(&tree);
 //  for(i = 0; i < TESTSIZE; i++){
 ////    NAInt key = (NAInt)(naUniformRandZE() * TESTSIZE);
@@ -103,11 +104,11 @@
 //    naLocateTreeKey(&iter, &key, NA_FALSE);
 //  }
 //  naClearTreeIterator(&iter);
-//  t2 = naMakeDateTimeNow();
-//  printf("Tree Locate: %f" NA_NL, naGetDateTimeDifference(&t2, &t1));
+//  t2 = naMakeClockNow();
+//  printf("Tree Locate: %f" NA_NL, naGetClockDifference(&t2, &t1));
 //
 ////  NAInt prevkey = -1.;
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  iter = naMakeTreeModifier(&tree);
 //  i = 0;
 //  while(naIterateTree(&iter, NA_NULL, NA_NULL)){
@@ -128,13 +129,13 @@
 ////    if(i < 50){printf("%f" NA_NL, *key);}
 //  }
 //  naClearTreeIterator(&iter);
-//  t2 = naMakeDateTimeNow();
-//  printf("Tree Iterate (%d): %f" NA_NL, i, naGetDateTimeDifference(&t2, &t1));
+//  t2 = naMakeClockNow();
+//  printf("Tree Iterate (%d): %f" NA_NL, i, naGetClockDifference(&t2, &t1));
 //
 //  // ////////////////
 //
 ////  naEmptyTree(&tree);
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  iter = naMakeTreeModifier(&tree);
 //  for(i = 0; i < TESTSIZE; i++){
 ////    NAInt key = (NAInt)(naUniformRandZE() * TESTSIZE);
@@ -148,8 +149,8 @@
 //    }
 //  }
 //  naClearTreeIterator(&iter);
-//  t2 = naMakeDateTimeNow();
-//  printf("Tree Insert/Remove: %f" NA_NL, naGetDateTimeDifference(&t2, &t1));
+//  t2 = naMakeClockNow();
+//  printf("Tree Insert/Remove: %f" NA_NL, naGetClockDifference(&t2, &t1));
 //
 //  naClearTree(&tree);
 //  naReleaseTreeConfiguration(config);
@@ -161,9 +162,9 @@
 //
 //void testDateTimeHeap(){
 //  NAHeap heap;
-//  NADateTime t1;
-//  NADateTime t2;
-//  NADateTime t3;
+//  NAClock t1;
+//  NAClock t2;
+//  NAClock t3;
 //  int i;
 //  NADateTime prevkey = naMakeDateTimeWithNALibSecondNumber(-1E20);
 //  NADateTime* keys;
@@ -175,12 +176,12 @@
 //
 //  naInitHeap(&heap, -1, NA_HEAP_USES_DATETIME_KEY);
 //  
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  for(i = 0; i < TESTSIZE; i++){
 //    naInsertHeapElementConst(&heap, &(keys[i]), &(keys[i]), NA_NULL);
 //  }
 //
-//  t2 = naMakeDateTimeNow();
+//  t2 = naMakeClockNow();
 //
 //  for(i = 0; i < TESTSIZE; i++){
 //    const NADateTime* curkey = naRemoveHeapRootConst(&heap);
@@ -193,10 +194,10 @@
 //    //naDelete(datestring);
 //  }
 //
-//  t3 = naMakeDateTimeNow();
+//  t3 = naMakeClockNow();
 //
-//  printf("Heap Insert: %f" NA_NL, naGetDateTimeDifference(&t2, &t1));
-//  printf("Heap Iterate: %f" NA_NL, naGetDateTimeDifference(&t3, &t2));
+//  printf("Heap Insert: %f" NA_NL, naGetClockDifference(&t2, &t1));
+//  printf("Heap Iterate: %f" NA_NL, naGetClockDifference(&t3, &t2));
 //
 //  naClearHeap(&heap);
 //  
@@ -4,6 +4,7 @@
 //#include NA_TEST_NALIB_PATH(NATree.h)
 //#include NA_TEST_NALIB_PATH(NAHeap.h)
 //#include NA_TEST_NALIB_PATH(NARandom.h)
+//#include NA_TEST_NALIB_PATH(NAClock.h)
 //#include NA_TEST_NALIB_PATH(NAMemory.h)
 //
 //#define TESTSIZE    1000000
@@ -17,7 +18,7 @@
 //}
 //
 //void testQSort(){
-//  NADateTime t1, t2;
+//  NAClock t1, t2;
 //  int i;
 //
 //  double* keys = naMalloc(TESTSIZE * sizeof(double));
@@ -25,10 +26,10 @@
 //    keys[i] = naUniformRandZE();
 //  }
 //
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  qsort(keys, TESTSIZE, sizeof(keys[0]), compare);
-//  t2 = naMakeDateTimeNow();
-//  printf("QSort: %f" NA_NL, naGetDateTimeDifference(&t2, &t1));
+//  t2 = naMakeClockNow();
+//  printf("QSort: %f" NA_NL, naGetClockDifference(&t2, &t1));
 //
 //  naFree(keys);
 //}
@@ -37,13 +38,13 @@
 //
 //void testHeap(){
 //  NAHeap heap;
-//  NADateTime t1, t2;
+//  NAClock t1, t2;
 //  int i;
 //
 //  double* keys = naMalloc(TESTSIZE * sizeof(double*));
 //  naInitHeap(&heap, -1, NA_HEAP_USES_DOUBLE_KEY);
 //
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 ////  iter = naMakeTreeModifier(&tree);
 //  for(i = 0; i < TESTSIZE; i++){
 //    keys[i] = naUniformRandZE();
@@ -52,11 +53,11 @@
 //    naInsertHeapElementConst(&heap, &(keys[i]), &(keys[i]), NA_NULL);
 //  }
 ////  naClearTreeIterator(&iter);
-//  t2 = naMakeDateTimeNow();
-//  printf("Heap Insert: %f" NA_NL, naGetDateTimeDifference(&t2, &t1));
+//  t2 = naMakeClockNow();
+//  printf("Heap Insert: %f" NA_NL, naGetClockDifference(&t2, &t1));
 //
 ////  double prevkey = -1;
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  for(i = 0; i < TESTSIZE; i++){
 ////    const double* key = naGetHeapRootKey(&heap);
 ////    if(*key < prevkey){
@@ -65,8 +66,8 @@
 ////    prevkey = *key;
 //    naRemoveHeapRootConst(&heap);
 //  }
-//  t2 = naMakeDateTimeNow();
-//  printf("Heap Iterate: %f" NA_NL, naGetDateTimeDifference(&t2, &t1));
+//  t2 = naMakeClockNow();
+//  printf("Heap Iterate: %f" NA_NL, naGetClockDifference(&t2, &t1));
 //
 //  naClearHeap(&heap);
 //  naFree(keys);
@@ -77,14 +78,14 @@
 //void testTree(){
 //  NATreeConfiguration* config = naCreateTreeConfiguration(NA_TREE_KEY_DOUBLE | NA_TREE_BALANCE_AVL);
 //  NATree tree;
-//  NADateTime t1, t2;
+//  NAClock t1, t2;
 //  NATreeIterator iter;
 //  int i;
 //  double prevkey;
 //
 //  naInitTree(&tree, config);
 //
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  iter = naMakeTreeModifier(&tree);
 //  for(i = 0; i < TESTSIZE; i++){
 ////    NAInt key = (NAInt)(naUniformRandZE() * TESTSIZE);
@@ -95,10 +96,10 @@
 //    naAddTreeKeyConst(&iter, &key, NA_NULL, NA_TRUE);
 //  }
 //  naClearTreeIterator(&iter);
-//  t2 = naMakeDateTimeNow();
-//  printf("Tree Insert: %f" NA_NL, naGetDateTimeDifference(&t2, &t1));
+//  t2 = naMakeClockNow();
+//  printf("Tree Insert: %f" NA_NL, naGetClockDifference(&t2, &t1));
 //
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  iter = naMakeTreeAccessor(&tree);
 //  for(i = 0; i < TESTSIZE; i++){
 ////    NAInt key = (NAInt)(naUniformRandZE() * TESTSIZE);
@@ -111,12 +112,12 @@
 //    naLocateTreeKey(&iter, &key, NA_FALSE);
 //  }
 //  naClearTreeIterator(&iter);
-//  t2 = naMakeDateTimeNow();
-//  printf("Tree Locate: %f" NA_NL, naGetDateTimeDifference(&t2, &t1));
+//  t2 = naMakeClockNow();
+//  printf("Tree Locate: %f" NA_NL, naGetClockDifference(&t2, &t1));
 //
 ////  NAInt prevkey = -1.;
 //  prevkey = -1.;
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  iter = naMakeTreeModifier(&tree);
 //  i = 0;
 //  while(naIterateTree(&iter, NA_NULL, NA_NULL)){
@@ -137,13 +138,13 @@
 ////    if(i < 5){printf("%f" NA_NL, *key);}
 //  }
 //  naClearTreeIterator(&iter);
-//  t2 = naMakeDateTimeNow();
-//  printf("Tree Iterate (%d): %f" NA_NL, i, naGetDateTimeDifference(&t2, &t1));
+//  t2 = naMakeClockNow();
+//  printf("Tree Iterate (%d): %f" NA_NL, i, naGetClockDifference(&t2, &t1));
 //
 //  // ////////////////
 //
 ////  naEmptyTree(&tree);
-//  t1 = naMakeDateTimeNow();
+//  t1 = naMakeClockNow();
 //  iter = naMakeTreeModifier(&tree);
 //  for(i = 0; i < TESTSIZE; i++){
 ////    NAInt key = (NAInt)(naUniformRandZE() * TESTSIZE);
@@ -157,8 +158,8 @@
 //    }
 //  }
 //  naClearTreeIterator(&iter);
-//  t2 = naMakeDateTimeNow();
-//  printf("Tree Insert/Remove: %f" NA_NL, naGetDateTimeDifference(&t2, &t1));
+//  t2 = naMakeClockNow();
+//  printf("Tree Insert/Remove: %f" NA_NL, naGetClockDifference(&t2, &t1));
 //
 //  naClearTree(&tree);
 //  naReleaseTreeConfiguration(config);
@@ -5,20 +5,30 @@
 
 
 // Prototypes
+void printNAMemory(void);
 void printNATesting(void);
 
+void testNAAtomic(void);
+void testNAClock(void);
+void testNAMemory(void);
 void testNATesting(void);
+void testNAThreading(void);
 void testNAValueHelper(void);
 
 
 
 void printNACore(void){
+  printNAMemory();
   printNATesting();
 }
 
 void testNACore(void){
   naTestFunction(testNATesting);
   naTestFunction(testNAValueHelper);
+  naTestFunction(testNAMemory);
+  naTestFunction(testNAAtomic);
+  naTestFunction(testNAThreading);
+  naTestFunction(testNAClock);
 }
 
 
@@ -0,0 +1,151 @@
+#include "NATest.h"
+#include <stdio.h>
+
+#include "NABase.h"
+#include "NAUtility/NAAtomic.h"
+
+#include "NAUtility/NAThreading.h"
+
+#define NA_TEST_ATOMIC_THREAD_COUNT 4
+#define NA_TEST_ATOMIC_LOOP_COUNT 10000
+
+// See testNAThreading.c
+void runTestThreads(NAMutator function, void* arg, size_t threadCount);
+
+
+
+void testAtomic32(void){
+  NAAtomic32 atomic;
+  naInitAtomic32(&atomic, 5);
+
+  naTestGroup("Loading and storing"){
+    naTest(naLoadAtomic32(&atomic, NA_MEMORY_ORDER_RELAXED) == 5);
+    naStoreAtomic32(&atomic, -3, NA_MEMORY_ORDER_RELEASE);
+    naTest(naLoadAtomic32(&atomic, NA_MEMORY_ORDER_ACQUIRE) == -3);
+    naStoreAtomic32(&atomic, NA_MAX_i32, NA_MEMORY_ORDER_SEQ_CST);
+    naTest(naLoadAtomic32(&atomic, NA_MEMORY_ORDER_SEQ_CST) == NA_MAX_i32);
+    naTestError(naLoadAtomic32(&atomic, NA_MEMORY_ORDER_RELEASE));
+    naTestError(naStoreAtomic32(&atomic, 0, NA_MEMORY_ORDER_ACQUIRE));
+  }
+
+  naTestGroup("Exchanging and adding"){
+    int32 expected = 7;
+    naStoreAtomic32(&atomic, 1, NA_MEMORY_ORDER_RELAXED);
+    naTest(naExchangeAtomic32(&atomic, 7, NA_MEMORY_ORDER_ACQ_REL) == 1);
+    naTest(naCompareExchangeAtomic32(&atomic, &expected, 8, NA_MEMORY_ORDER_SEQ_CST));
+    naTest(expected == 7);
+    naTest(!naCompareExchangeAtomic32(&atomic, &expected, 9, NA_MEMORY_ORDER_SEQ_CST));
+    naTest(expected == 8);
+    naTest(naFetchAddAtomic32(&atomic, 2, NA_MEMORY_ORDER_RELAXED) == 8);
+    naTest(naFetchAddAtomic32(&atomic, -10, NA_MEMORY_ORDER_RELAXED) == 10);
+    naTest(naLoadAtomic32(&atomic, NA_MEMORY_ORDER_RELAXED) == 0);
+  }
+}
+
+
+
+void testAtomic64(void){
+  #if defined NA_TYPE_INT64
+    NAAtomic64 atomic;
+    int64 expected = NA_MAX_i64;
+    naInitAtomic64(&atomic, NA_MAX_i64);
+
+    naTestGroup("64 bit operations"){
+      naTest(naLoadAtomic64(&atomic, NA_MEMORY_ORDER_RELAXED) == NA_MAX_i64);
+      naTest(naCompareExchangeAtomic64(&atomic, &expected, 1, NA_MEMORY_ORDER_SEQ_CST));
+      naTest(!naCompareExchangeAtomic64(&atomic, &expected, 2, NA_MEMORY_ORDER_SEQ_CST));
+      naTest(expected == 1);
+      naTest(naExchangeAtomic64(&atomic, -1, NA_MEMORY_ORDER_ACQ_REL) == 1);
+      naTest(naFetchAddAtomic64(&atomic, 1, NA_MEMORY_ORDER_RELAXED) == -1);
+      naStoreAtomic64(&atomic, NA_MIN_i64, NA_MEMORY_ORDER_RELEASE);
+      naTest(naLoadAtomic64(&atomic, NA_MEMORY_ORDER_ACQUIRE) == NA_MIN_i64);
+    }
+  #endif
+}
+
+
+
+void testAtomicPtr(void){
+  int values[2] = {0, 1};
+  NAAtomicPtr atomic;
+  void* expected = &(values[0]);
+  naInitAtomicPtr(&atomic, &(values[0]));
+
+  naTestGroup("Pointer operations"){
+    naTest(naLoadAtomicPtr(&atomic, NA_MEMORY_ORDER_ACQUIRE) == &(values[0]));
+    naTest(naCompareExchangeAtomicPtr(&atomic, &expected, &(values[1]), NA_MEMORY_ORDER_ACQ_REL));
+    naTest(!naCompareExchangeAtomicPtr(&atomic, &expected, NA_NULL, NA_MEMORY_ORDER_ACQ_REL));
+    naTest(expected == &(values[1]));
+    naTest(naExchangeAtomicPtr(&atomic, NA_NULL, NA_MEMORY_ORDER_SEQ_CST) == &(values[1]));
+    naStoreAtomicPtr(&atomic, &(values[0]), NA_MEMORY_ORDER_RELEASE);
+    naTest(naLoadAtomicPtr(&atomic, NA_MEMORY_ORDER_RELAXED) == &(values[0]));
+  }
+}
+
+
+
+typedef struct NATestAtomicCounters NATestAtomicCounters;
+struct NATestAtomicCounters{
+  NAAtomic32 addCounter;
+  NAAtomic32 casCounter;
+};
+
+void na_CountTestAtomics(void* arg){
+  NATestAtomicCounters* counters = (NATestAtomicCounters*)arg;
+  size_t i;
+  for(i = 0; i < NA_TEST_ATOMIC_LOOP_COUNT; i++){
+    int32 expected = naLoadAtomic32(&(counters->casCounter), NA_MEMORY_ORDER_RELAXED);
+    naFetchAddAtomic32(&(counters->addCounter), 1, NA_MEMORY_ORDER_RELAXED);
+    while(!naCompareExchangeAtomic32(&(counters->casCounter), &expected, expected + 1, NA_MEMORY_ORDER_RELAXED)){
+      naPauseAtomic();
+    }
+  }
+}
+
+void testAtomicConcurrency(void){
+  naTestGroup("Counting on multiple threads"){
+    NATestAtomicCounters counters;
+    naInitAtomic32(&(counters.addCounter), 0);
+    naInitAtomic32(&(counters.casCounter), 0);
+    runTestThreads(na_CountTestAtomics, &counters, NA_TEST_ATOMIC_THREAD_COUNT);
+    naTest(naLoadAtomic32(&(counters.addCounter), NA_MEMORY_ORDER_RELAXED) == NA_TEST_ATOMIC_THREAD_COUNT * NA_TEST_ATOMIC_LOOP_COUNT);
+    naTest(naLoadAtomic32(&(counters.casCounter), NA_MEMORY_ORDER_RELAXED) == NA_TEST_ATOMIC_THREAD_COUNT * NA_TEST_ATOMIC_LOOP_COUNT);
+  }
+}
+
+
+
+void testNAAtomic(void){
+  naTestFunction(testAtomic32);
+  naTestFunction(testAtomic64);
+  naTestFunction(testAtomicPtr);
+  naTestFunction(testAtomicConcurrency);
+}
+
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
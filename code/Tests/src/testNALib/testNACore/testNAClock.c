@@ -0,0 +1,93 @@
+#include "NATest.h"
+#include <stdio.h>
+
+#include "NABase.h"
+#include "NAUtility/NAClock.h"
+
+#include "NAUtility/NAThreading.h"
+
+
+
+void testClock(void){
+  #if defined NA_TYPE_INT64
+    naTestGroup("Measuring a sleep"){
+      NAClock start = naMakeClockNow();
+      NAClock end;
+      int64 nanoseconds;
+      naSleepM(20);
+      end = naMakeClockNow();
+      nanoseconds = naGetClockDifferenceNanoseconds(&end, &start);
+      naTest(nanoseconds >= 19000000);
+      naTest(naGetClockDifference(&end, &start) >= .019);
+      naTest(naGetClockDifference(&end, &start) < 10.);
+      naTest(naGetClockDifferenceNanoseconds(&start, &end) == -nanoseconds);
+      naTest(naGetClockNanoseconds(&end) > naGetClockNanoseconds(&start));
+      naTest(naGetClockElapsed(&start) >= naGetClockDifference(&end, &start));
+    }
+
+    naTestGroup("Never going backwards"){
+      NABool monotonic = NA_TRUE;
+      NAClock prev = naMakeClockNow();
+      size_t i;
+      for(i = 0; i < 10000; i++){
+        NAClock cur = naMakeClockNow();
+        monotonic = monotonic && naGetClockDifferenceNanoseconds(&cur, &prev) >= 0;
+        prev = cur;
+      }
+      naTest(monotonic);
+    }
+  #endif
+}
+
+
+
+void testCycleCount(void){
+  #if defined NA_TYPE_INT64
+    naTestGroup("Measuring a sleep in cycles"){
+      uint64 start;
+      double seconds;
+      naTest(naGetCycleCountFrequency() > 0.);
+      naTest(naGetCycleCountFrequency() == naGetCycleCountFrequency());
+      start = naGetCycleCount();
+      naSleepM(20);
+      seconds = naGetCycleCountSeconds(naGetCycleCount() - start);
+      naTest(seconds >= .015);
+      naTest(seconds < 10.);
+    }
+  #endif
+}
+
+
+
+void testNAClock(void){
+  naTestFunction(testClock);
+  naTestFunction(testCycleCount);
+}
+
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
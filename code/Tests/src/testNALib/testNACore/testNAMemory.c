@@ -0,0 +1,332 @@
+#include "NATest.h"
+#include <stdio.h>
+
+#include "NABase.h"
+#include "NAUtility/NAMemory.h"
+
+#include "NAUtility/NAAtomic.h"
+#include "NAUtility/NABinaryData.h"
+#include "NAUtility/NAThreading.h"
+
+#define NA_TEST_RUNTIME_OBJECT_COUNT 1000
+
+
+
+typedef struct NATestRuntimeObject NATestRuntimeObject;
+struct NATestRuntimeObject{
+  NAInt value;
+};
+
+NAAtomic32 na_TestRuntimeObjectDestructCount;
+
+void na_DestructTestRuntimeObject(NATestRuntimeObject* object){
+  NA_UNUSED(object);
+  naFetchAddAtomic32(&na_TestRuntimeObjectDestructCount, 1, NA_MEMORY_ORDER_RELAXED);
+}
+
+NA_RUNTIME_TYPE(NATestRuntimeObject, na_DestructTestRuntimeObject, NA_FALSE);
+
+typedef struct NATestRuntimeObjects NATestRuntimeObjects;
+struct NATestRuntimeObjects{
+  NATestRuntimeObject** objects;
+  size_t count;
+};
+
+// See testNAThreading.c
+void runTestThreads(NAMutator function, void* arg, size_t threadCount);
+
+void na_GetTestRuntimeObjectStats(const NARuntimeTypeStats* typeStats, void* data){
+  if(typeStats->typeName == na_NATestRuntimeObjectTypeInfo.typeName){
+    *(NARuntimeTypeStats*)data = *typeStats;
+  }
+}
+
+NARuntimeTypeStats getTestRuntimeObjectStats(void){
+  NARuntimeTypeStats typeStats;
+  naZeron(&typeStats, sizeof(NARuntimeTypeStats));
+  naIterateRuntimeTypeStats(na_GetTestRuntimeObjectStats, &typeStats);
+  return typeStats;
+}
+
+void na_NewTestRuntimeObjects(void* arg){
+  NATestRuntimeObjects* objects = (NATestRuntimeObjects*)arg;
+  size_t i;
+  for(i = 0; i < objects->count; i++){
+    objects->objects[i] = naNew(NATestRuntimeObject);
+    objects->objects[i]->value = (NAInt)i;
+  }
+}
+
+void na_DeleteTestRuntimeObjects(void* arg){
+  NATestRuntimeObjects* objects = (NATestRuntimeObjects*)arg;
+  size_t i;
+  for(i = 0; i < objects->count; i++){
+    naDelete(objects->objects[i]);
+  }
+}
+
+void na_FreeTestMallocPointers(void* arg){
+  NAByte** ptrs = (NAByte**)arg;
+  size_t i;
+  for(i = 0; i < NA_TEST_RUNTIME_OBJECT_COUNT; i++){
+    naFree(ptrs[i]);
+  }
+}
+
+
+
+void testRuntime(void){
+  naInitAtomic32(&na_TestRuntimeObjectDestructCount, 0);
+
+  naTestGroup("Batch allocation"){
+    NATestRuntimeObject* objects[NA_TEST_RUNTIME_OBJECT_COUNT];
+    NABool correct = NA_TRUE;
+    size_t i;
+    naNewBatch(NATestRuntimeObject, objects, NA_TEST_RUNTIME_OBJECT_COUNT);
+    for(i = 0; i < NA_TEST_RUNTIME_OBJECT_COUNT; i++){
+      objects[i]->value = (NAInt)i;
+    }
+    for(i = 0; i < NA_TEST_RUNTIME_OBJECT_COUNT; i++){
+      correct = correct && objects[i]->value == (NAInt)i;
+    }
+    naTest(correct);
+    naTest(getTestRuntimeObjectStats().objectCount == NA_TEST_RUNTIME_OBJECT_COUNT);
+    naDeleteBatch((void**)objects, NA_TEST_RUNTIME_OBJECT_COUNT);
+    naTest(getTestRuntimeObjectStats().objectCount == 0);
+    naTest(naLoadAtomic32(&na_TestRuntimeObjectDestructCount, NA_MEMORY_ORDER_RELAXED) == NA_TEST_RUNTIME_OBJECT_COUNT);
+  }
+
+  naTestGroup("Trimming spare parts"){
+    NARuntimeStats stats;
+    naTrimRuntimeSpareParts();
+    naGetRuntimeStats(&stats);
+    naTest(stats.sparePartCount == 0);
+  }
+
+  #if NA_MEMORY_POOL_THREAD_SAFE
+    naTestGroup("Deleting objects on a foreign thread"){
+      NATestRuntimeObjects objects;
+      NARuntimeTypeStats typeStats;
+      // Exactly fill the empty part of this thread.
+      NATestRuntimeObject* object = naNew(NATestRuntimeObject);
+      objects.count = getTestRuntimeObjectStats().capacityCount;
+      objects.objects = naMalloc(objects.count * sizeof(NATestRuntimeObject*));
+      naDelete(object);
+      na_NewTestRuntimeObjects(&objects);
+      naTest(getTestRuntimeObjectStats().partCount == 1);
+      naStoreAtomic32(&na_TestRuntimeObjectDestructCount, 0, NA_MEMORY_ORDER_RELAXED);
+
+      // The spaces go to the remote list of the part, hence they still count
+      // as alive until this thread collects them.
+      runTestThreads(na_DeleteTestRuntimeObjects, &objects, 1);
+      typeStats = getTestRuntimeObjectStats();
+      naTest(naLoadAtomic32(&na_TestRuntimeObjectDestructCount, NA_MEMORY_ORDER_RELAXED) == (int32)objects.count);
+      naTest(typeStats.objectCount == objects.count);
+
+      // The part is full, hence allocating collects the remote list and
+      // reuses its spaces instead of taking a new part.
+      na_NewTestRuntimeObjects(&objects);
+      typeStats = getTestRuntimeObjectStats();
+      naTest(typeStats.objectCount == objects.count);
+      naTest(typeStats.partCount == 1);
+      naDeleteBatch((void**)objects.objects, objects.count);
+      naTest(getTestRuntimeObjectStats().objectCount == 0);
+      naFree(objects.objects);
+    }
+
+    naTestGroup("Deleting objects of a detached thread"){
+      NATestRuntimeObjects objects;
+      NABool correct = NA_TRUE;
+      size_t i;
+      objects.count = NA_TEST_RUNTIME_OBJECT_COUNT;
+      objects.objects = naMalloc(objects.count * sizeof(NATestRuntimeObject*));
+      naStoreAtomic32(&na_TestRuntimeObjectDestructCount, 0, NA_MEMORY_ORDER_RELAXED);
+      runTestThreads(na_NewTestRuntimeObjects, &objects, 1);
+      for(i = 0; i < objects.count; i++){
+        correct = correct && objects.objects[i]->value == (NAInt)i;
+      }
+      naTest(correct);
+      naTestVoid(naDeleteBatch((void**)objects.objects, objects.count));
+      naTest(naLoadAtomic32(&na_TestRuntimeObjectDestructCount, NA_MEMORY_ORDER_RELAXED) == (int32)objects.count);
+      // Another thread can take over the parts of the detached thread.
+      naTestVoid(runTestThreads(na_NewTestRuntimeObjects, &objects, 1));
+      naTestVoid(runTestThreads(na_DeleteTestRuntimeObjects, &objects, 1));
+      naFree(objects.objects);
+    }
+  #endif
+}
+
+
+
+void testArena(void){
+  NAArena arena;
+  naInitArena(&arena, 1024);
+
+  naTestGroup("Allocating"){
+    NAByte* ptr1 = naMallocArena(&arena, 1);
+    NAByte* ptr2 = naMallocArena(&arena, 1);
+    NAByte* ptr3 = naMallocArena(&arena, 4992);
+    naTest(((size_t)ptr1 % (2 * NA_ADDRESS_BYTES)) == 0);
+    naTest(((size_t)ptr2 % (2 * NA_ADDRESS_BYTES)) == 0);
+    naTest(((size_t)ptr3 % (2 * NA_ADDRESS_BYTES)) == 0);
+    naTest(ptr2 == ptr1 + 2 * NA_ADDRESS_BYTES);
+    // The large allocation gets a block of its own.
+    naTest(naGetArenaByteSize(&arena) == 4 * NA_ADDRESS_BYTES + 4992);
+    naTestCrash(naMallocArena(&arena, 0));
+  }
+
+  naTestGroup("Pushing and popping marks"){
+    size_t byteSize = naGetArenaByteSize(&arena);
+    NAArenaMark mark = naPushArenaMark(&arena);
+    NAByte* ptr1 = naMallocArena(&arena, 96);
+    NAArenaMark innerMark = naPushArenaMark(&arena);
+    NAByte* ptr2;
+    size_t i;
+    for(i = 0; i < 100; i++){
+      naMallocArena(&arena, 96);
+    }
+    naTest(naGetArenaByteSize(&arena) == byteSize + 101 * 96);
+    naPopArenaMark(&arena, innerMark);
+    ptr2 = naMallocArena(&arena, 96);
+    naTest(ptr2 == ptr1 + 96);
+    naPopArenaMark(&arena, mark);
+    naTest(naGetArenaByteSize(&arena) == byteSize);
+  }
+
+  naTestGroup("Resetting"){
+    NAByte* ptr1;
+    NAByte* ptr2;
+    size_t i;
+    size_t maxByteSize = naGetArenaMaxByteSize(&arena);
+    naResetArena(&arena);
+    naTest(naGetArenaByteSize(&arena) == 0);
+    naTest(naGetArenaMaxByteSize(&arena) == maxByteSize);
+
+    // The spare block is reused after every reset.
+    ptr1 = naMallocArena(&arena, 96);
+    naResetArena(&arena);
+    ptr2 = naMallocArena(&arena, 96);
+    naTest(ptr1 == ptr2);
+    naTest(naGetArenaByteSize(&arena) == 96);
+
+    for(i = 0; i < 100; i++){
+      naMallocArena(&arena, 96);
+    }
+    naResetArena(&arena);
+    naTest(naGetArenaByteSize(&arena) == 0);
+    naTest(naGetArenaMaxByteSize(&arena) == maxByteSize);
+    naTestVoid(naMallocArena(&arena, 96));
+  }
+
+  naClearArena(&arena);
+}
+
+
+
+void testMallocSizeClasses(void){
+  naTestGroup("Allocating and freeing sizes up to 5000 bytes"){
+    NAByte* ptrs[5000];
+    NABool aligned = NA_TRUE;
+    NABool correct = NA_TRUE;
+    size_t i;
+    size_t j;
+    for(i = 0; i < 5000; i++){
+      ptrs[i] = naMalloc(i + 1);
+      aligned = aligned && ((size_t)ptrs[i] % (2 * NA_ADDRESS_BYTES)) == 0;
+      for(j = 0; j < i + 1; j++){
+        ptrs[i][j] = (NAByte)i;
+      }
+    }
+    naTest(aligned);
+    // No allocation overlaps another one.
+    for(i = 0; i < 5000; i++){
+      for(j = 0; j < i + 1; j++){
+        correct = correct && ptrs[i][j] == (NAByte)i;
+      }
+      naFree(ptrs[i]);
+    }
+    naTest(correct);
+  }
+
+  naTestGroup("Reusing freed space"){
+    void* ptr1 = naMalloc(100);
+    void* ptr2;
+    naFree(ptr1);
+    ptr2 = naMalloc(100);
+    #if NA_MALLOC_SIZE_CLASSES
+      naTest(ptr1 == ptr2);
+    #endif
+    naFree(ptr2);
+    naTestVoid(naFree(NA_NULL));
+  }
+
+  naTestGroup("Freeing on a foreign thread"){
+    NAByte* ptrs[NA_TEST_RUNTIME_OBJECT_COUNT];
+    NABool correct = NA_TRUE;
+    size_t i;
+    for(i = 0; i < NA_TEST_RUNTIME_OBJECT_COUNT; i++){
+      ptrs[i] = naMalloc(64);
+    }
+    naTestVoid(runTestThreads(na_FreeTestMallocPointers, ptrs, 1));
+    // Allocating again collects the spaces freed by the other thread.
+    for(i = 0; i < NA_TEST_RUNTIME_OBJECT_COUNT; i++){
+      ptrs[i] = naMalloc(64);
+      ptrs[i][0] = (NAByte)i;
+      ptrs[i][63] = (NAByte)i;
+    }
+    for(i = 0; i < NA_TEST_RUNTIME_OBJECT_COUNT; i++){
+      correct = correct && ptrs[i][0] == (NAByte)i && ptrs[i][63] == (NAByte)i;
+      naFree(ptrs[i]);
+    }
+    naTest(correct);
+  }
+}
+
+
+
+void printNAMemory(void){
+  printf("NAMemory.h:" NA_NL);
+
+  naPrintMacro(NA_MEMORY_POOL_THREAD_SAFE);
+  naPrintMacro(NA_MEMORY_POOL_SPARE_PART_COUNT);
+  naPrintMacro(NA_MALLOC_SIZE_CLASSES);
+  naPrintMacro(NA_MEMORY_TRACE);
+
+  printf(NA_NL);
+}
+
+
+
+void testNAMemory(void){
+  naTestFunction(testRuntime);
+  naTestFunction(testArena);
+  naTestFunction(testMallocSizeClasses);
+}
+
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
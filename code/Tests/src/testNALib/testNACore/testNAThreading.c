@@ -0,0 +1,419 @@
+#include "NATest.h"
+#include <stdio.h>
+
+#include "NABase.h"
+#include "NAUtility/NAThreading.h"
+
+#include "NAUtility/NAAtomic.h"
+#include "NAUtility/NABinaryData.h"
+#include "NAUtility/NAMemory.h"
+
+#define NA_TEST_THREAD_COUNT 4
+#define NA_TEST_THREAD_LOOP_COUNT 1000
+#define NA_TEST_TASK_COUNT 1000
+#define NA_TEST_TASK_TREE_COUNT 1023
+#define NA_TEST_PARALLEL_COUNT 10000
+
+
+
+typedef struct NATestThreadStart NATestThreadStart;
+struct NATestThreadStart{
+  NAMutator function;
+  void* arg;
+  NALatch latch;
+};
+
+void na_RunTestThread(void* arg){
+  NATestThreadStart* start = (NATestThreadStart*)arg;
+  start->function(start->arg);
+  // Threads detach themselves after the function anyway, but runTestThreads
+  // must not return before they are done with the runtime.
+  naDetachRuntimeThread();
+  naDetachMallocThread();
+  naCountDownLatch(start->latch);
+}
+
+// Runs the function with arg on threadCount new threads at the same time and
+// returns when all of them are done. Also used by other test files.
+void runTestThreads(NAMutator function, void* arg, size_t threadCount){
+  NATestThreadStart start;
+  NAThread* threads = naMalloc(threadCount * sizeof(NAThread));
+  size_t i;
+  start.function = function;
+  start.arg = arg;
+  start.latch = naMakeLatch(threadCount);
+  for(i = 0; i < threadCount; i++){
+    threads[i] = naMakeThread("NALib test", na_RunTestThread, &start);
+    naRunThread(threads[i]);
+  }
+  naWaitLatch(start.latch);
+  for(i = 0; i < threadCount; i++){
+    naClearThread(threads[i]);
+  }
+  naClearLatch(start.latch);
+  naFree(threads);
+}
+
+
+
+typedef struct NATestTaskTree NATestTaskTree;
+struct NATestTaskTree{
+  NATaskGroup* group;
+  NAAtomic32 counter;
+  NAAtomic32 stolen;
+  NALatch latch;
+  int32 indices[NA_TEST_TASK_TREE_COUNT];
+};
+
+NATestTaskTree na_TestTaskTree;
+
+void na_CountTestTask(void* arg){
+  naFetchAddAtomic32((NAAtomic32*)arg, 1, NA_MEMORY_ORDER_RELAXED);
+}
+
+// Counts and dispatches the two children of the node at the given index to
+// the same group.
+void na_RunTestTaskTreeNode(void* arg){
+  int32 index = *(int32*)arg;
+  naFetchAddAtomic32(&(na_TestTaskTree.counter), 1, NA_MEMORY_ORDER_RELAXED);
+  if(2 * index + 2 < NA_TEST_TASK_TREE_COUNT){
+    naDispatchGroupTask(na_TestTaskTree.group, na_RunTestTaskTreeNode, &(na_TestTaskTree.indices[2 * index + 1]));
+    naDispatchGroupTask(na_TestTaskTree.group, na_RunTestTaskTreeNode, &(na_TestTaskTree.indices[2 * index + 2]));
+  }
+}
+
+// Dispatches tasks to the queue of the current worker and blocks the worker
+// until the tasks are done, which is only possible if other workers steal them.
+void na_RunTestStolenTasks(void* arg){
+  NAThreadPool* pool = (NAThreadPool*)arg;
+  size_t i;
+  for(i = 0; i < NA_TEST_THREAD_COUNT; i++){
+    naDispatchTask(pool, na_CountTestTask, &(na_TestTaskTree.counter));
+  }
+  for(i = 0; i < 5000; i++){
+    if(naLoadAtomic32(&(na_TestTaskTree.counter), NA_MEMORY_ORDER_ACQUIRE) == NA_TEST_THREAD_COUNT){
+      naStoreAtomic32(&(na_TestTaskTree.stolen), 1, NA_MEMORY_ORDER_RELAXED);
+      break;
+    }
+    naSleepM(1);
+  }
+  naCountDownLatch(na_TestTaskTree.latch);
+}
+
+void testThreadPool(void){
+  NAThreadPool* pool = naMakeThreadPool(NA_TEST_THREAD_COUNT);
+  int32 i;
+
+  naTestGroup("Creating pools"){
+    naTest(naGetSystemProcessorCount() >= 1);
+    naTest(naGetThreadPoolWorkerCount(pool) == NA_TEST_THREAD_COUNT);
+    naTest(naGetDefaultThreadPool() == naGetDefaultThreadPool());
+    naTest(naGetThreadPoolWorkerCount(naGetDefaultThreadPool()) == naGetSystemProcessorCount());
+  }
+
+  naTestGroup("Waiting for a task group"){
+    NAAtomic32 counter;
+    NATaskGroup* group = naMakeTaskGroup(pool);
+    naInitAtomic32(&counter, 0);
+    for(i = 0; i < NA_TEST_TASK_COUNT; i++){
+      naDispatchGroupTask(group, na_CountTestTask, &counter);
+    }
+    naWaitTaskGroup(group);
+    naTest(naLoadAtomic32(&counter, NA_MEMORY_ORDER_RELAXED) == NA_TEST_TASK_COUNT);
+
+    // A group can be reused after waiting and waiting without tasks returns.
+    naDispatchGroupTask(group, na_CountTestTask, &counter);
+    naWaitTaskGroup(group);
+    naTest(naLoadAtomic32(&counter, NA_MEMORY_ORDER_RELAXED) == NA_TEST_TASK_COUNT + 1);
+    naTestVoid(naWaitTaskGroup(group));
+    naClearTaskGroup(group);
+  }
+
+  naTestGroup("Dispatching tasks from within tasks"){
+    for(i = 0; i < NA_TEST_TASK_TREE_COUNT; i++){
+      na_TestTaskTree.indices[i] = i;
+    }
+    naInitAtomic32(&(na_TestTaskTree.counter), 0);
+    na_TestTaskTree.group = naMakeTaskGroup(pool);
+    naDispatchGroupTask(na_TestTaskTree.group, na_RunTestTaskTreeNode, &(na_TestTaskTree.indices[0]));
+    naWaitTaskGroup(na_TestTaskTree.group);
+    naTest(naLoadAtomic32(&(na_TestTaskTree.counter), NA_MEMORY_ORDER_RELAXED) == NA_TEST_TASK_TREE_COUNT);
+    naClearTaskGroup(na_TestTaskTree.group);
+  }
+
+  naTestGroup("Stealing tasks of a blocked worker"){
+    naInitAtomic32(&(na_TestTaskTree.counter), 0);
+    naInitAtomic32(&(na_TestTaskTree.stolen), 0);
+    na_TestTaskTree.latch = naMakeLatch(1);
+    // Waiting for the latch instead of a group ensures that this thread does
+    // not execute any of the tasks.
+    naDispatchTask(pool, na_RunTestStolenTasks, pool);
+    naWaitLatch(na_TestTaskTree.latch);
+    naTest(naLoadAtomic32(&(na_TestTaskTree.stolen), NA_MEMORY_ORDER_RELAXED));
+    naClearLatch(na_TestTaskTree.latch);
+  }
+
+  naTestGroup("Clearing a pool with pending tasks"){
+    NAAtomic32 counter;
+    naInitAtomic32(&counter, 0);
+    for(i = 0; i < NA_TEST_TASK_COUNT; i++){
+      naDispatchTask(pool, na_CountTestTask, &counter);
+    }
+    naClearThreadPool(pool);
+    naTest(naLoadAtomic32(&counter, NA_MEMORY_ORDER_RELAXED) == NA_TEST_TASK_COUNT);
+  }
+}
+
+
+
+typedef struct NATestReduceResult NATestReduceResult;
+struct NATestReduceResult{
+  NAInt first;
+  NAInt end;
+  NABool contiguous;
+  int64 sum;
+};
+
+void na_MarkTestParallelRange(NARangei range, void* data){
+  int32* marks = (int32*)data;
+  NAInt i;
+  for(i = range.origin; i < range.origin + range.length; i++){
+    marks[i]++;
+  }
+}
+
+void na_SumTestParallelRange(NARangei range, void* result, void* data){
+  NATestReduceResult* reduceResult = (NATestReduceResult*)result;
+  NAInt i;
+  NA_UNUSED(data);
+  if(reduceResult->first < 0){
+    reduceResult->first = range.origin;
+    reduceResult->end = range.origin;
+  }
+  reduceResult->contiguous = reduceResult->contiguous && range.origin == reduceResult->end;
+  reduceResult->end = range.origin + range.length;
+  for(i = range.origin; i < range.origin + range.length; i++){
+    reduceResult->sum += i;
+  }
+}
+
+void na_CombineTestParallelSums(void* result, const void* partial, void* data){
+  NATestReduceResult* reduceResult = (NATestReduceResult*)result;
+  const NATestReduceResult* partialResult = (const NATestReduceResult*)partial;
+  NA_UNUSED(data);
+  if(partialResult->first < 0){return;}
+  if(reduceResult->first < 0){
+    *reduceResult = *partialResult;
+    return;
+  }
+  reduceResult->contiguous = reduceResult->contiguous && partialResult->contiguous && partialResult->first == reduceResult->end;
+  reduceResult->end = partialResult->end;
+  reduceResult->sum += partialResult->sum;
+}
+
+void testParallelLoops(void){
+  naTestGroup("Parallel for"){
+    int32* marks = naMalloc(NA_TEST_PARALLEL_COUNT * sizeof(int32));
+    NABool correct = NA_TRUE;
+    NAInt i;
+    naZeron(marks, NA_TEST_PARALLEL_COUNT * sizeof(int32));
+    naParallelFor(naMakeRangei(0, NA_TEST_PARALLEL_COUNT), 0, na_MarkTestParallelRange, marks);
+    naParallelFor(naMakeRangei(0, NA_TEST_PARALLEL_COUNT), 7, na_MarkTestParallelRange, marks);
+    naParallelFor(naMakeRangei(100, 1), 0, na_MarkTestParallelRange, marks);
+    for(i = 0; i < NA_TEST_PARALLEL_COUNT; i++){
+      correct = correct && marks[i] == (i == 100 ? 3 : 2);
+    }
+    naTest(correct);
+    naFree(marks);
+  }
+
+  naTestGroup("Parallel reduce"){
+    // The combiner checks that the partial results come in order.
+    NATestReduceResult result;
+    result.first = -1;
+    result.end = -1;
+    result.contiguous = NA_TRUE;
+    result.sum = 0;
+    naParallelReduce(naMakeRangei(0, NA_TEST_PARALLEL_COUNT), 0, &result, sizeof(NATestReduceResult), na_SumTestParallelRange, na_CombineTestParallelSums, NA_NULL);
+    naTest(result.first == 0);
+    naTest(result.end == NA_TEST_PARALLEL_COUNT);
+    naTest(result.contiguous);
+    naTest(result.sum == (int64)NA_TEST_PARALLEL_COUNT * (NA_TEST_PARALLEL_COUNT - 1) / 2);
+  }
+}
+
+
+
+typedef struct NATestLocking NATestLocking;
+struct NATestLocking{
+  NARWLock rwLock;
+  NAAdaptiveMutex mutex;
+  NABarrier barrier;
+  NALatch latch;
+  NAAtomic32 counter;
+  NAAtomic32 phaseErrorCount;
+  NAAtomic32 serialCount;
+  NAInt unprotectedCounter;
+  NABool canRead;
+  NABool canWrite;
+};
+
+void na_TryTestRWLock(void* arg){
+  NATestLocking* locking = (NATestLocking*)arg;
+  locking->canRead = naTryRWLockRead(locking->rwLock);
+  if(locking->canRead){naUnlockRWLockRead(locking->rwLock);}
+  locking->canWrite = naTryRWLockWrite(locking->rwLock);
+  if(locking->canWrite){naUnlockRWLockWrite(locking->rwLock);}
+}
+
+void na_CountWithTestRWLock(void* arg){
+  NATestLocking* locking = (NATestLocking*)arg;
+  size_t i;
+  for(i = 0; i < NA_TEST_THREAD_LOOP_COUNT; i++){
+    naLockRWLockWrite(locking->rwLock);
+    locking->unprotectedCounter++;
+    naUnlockRWLockWrite(locking->rwLock);
+    naLockRWLockRead(locking->rwLock);
+    naUnlockRWLockRead(locking->rwLock);
+  }
+}
+
+void na_CountWithTestAdaptiveMutex(void* arg){
+  NATestLocking* locking = (NATestLocking*)arg;
+  size_t i;
+  for(i = 0; i < NA_TEST_THREAD_LOOP_COUNT; i++){
+    naLockAdaptiveMutex(locking->mutex);
+    locking->unprotectedCounter++;
+    naUnlockAdaptiveMutex(locking->mutex);
+  }
+}
+
+// Every thread counts once per phase. After the barrier, all of them must
+// see the count of all threads.
+void na_RunTestBarrierPhases(void* arg){
+  NATestLocking* locking = (NATestLocking*)arg;
+  int32 phase;
+  for(phase = 1; phase <= 10; phase++){
+    naFetchAddAtomic32(&(locking->counter), 1, NA_MEMORY_ORDER_RELAXED);
+    if(naWaitBarrier(locking->barrier)){
+      naFetchAddAtomic32(&(locking->serialCount), 1, NA_MEMORY_ORDER_RELAXED);
+    }
+    if(naLoadAtomic32(&(locking->counter), NA_MEMORY_ORDER_RELAXED) != phase * NA_TEST_THREAD_COUNT){
+      naFetchAddAtomic32(&(locking->phaseErrorCount), 1, NA_MEMORY_ORDER_RELAXED);
+    }
+    naWaitBarrier(locking->barrier);
+  }
+}
+
+void na_CountDownTestLatch(void* arg){
+  NATestLocking* locking = (NATestLocking*)arg;
+  naFetchAddAtomic32(&(locking->counter), 1, NA_MEMORY_ORDER_RELAXED);
+  naCountDownLatch(locking->latch);
+}
+
+void testLocking(void){
+  NATestLocking locking;
+
+  naTestGroup("Reader-writer lock"){
+    locking.rwLock = naMakeRWLock();
+    naLockRWLockRead(locking.rwLock);
+    runTestThreads(na_TryTestRWLock, &locking, 1);
+    naTest(locking.canRead);
+    naTest(!locking.canWrite);
+    naUnlockRWLockRead(locking.rwLock);
+
+    naLockRWLockWrite(locking.rwLock);
+    runTestThreads(na_TryTestRWLock, &locking, 1);
+    naTest(!locking.canRead);
+    naTest(!locking.canWrite);
+    naUnlockRWLockWrite(locking.rwLock);
+
+    runTestThreads(na_TryTestRWLock, &locking, 1);
+    naTest(locking.canRead);
+    naTest(locking.canWrite);
+
+    locking.unprotectedCounter = 0;
+    runTestThreads(na_CountWithTestRWLock, &locking, NA_TEST_THREAD_COUNT);
+    naTest(locking.unprotectedCounter == NA_TEST_THREAD_COUNT * NA_TEST_THREAD_LOOP_COUNT);
+    naClearRWLock(locking.rwLock);
+  }
+
+  naTestGroup("Adaptive mutex"){
+    locking.mutex = naMakeAdaptiveMutex();
+    naTest(naTryAdaptiveMutex(locking.mutex));
+    naTest(!naTryAdaptiveMutex(locking.mutex));
+    naUnlockAdaptiveMutex(locking.mutex);
+
+    locking.unprotectedCounter = 0;
+    runTestThreads(na_CountWithTestAdaptiveMutex, &locking, NA_TEST_THREAD_COUNT);
+    naTest(locking.unprotectedCounter == NA_TEST_THREAD_COUNT * NA_TEST_THREAD_LOOP_COUNT);
+    naClearAdaptiveMutex(locking.mutex);
+  }
+
+  naTestGroup("Barrier"){
+    locking.barrier = naMakeBarrier(NA_TEST_THREAD_COUNT);
+    naInitAtomic32(&(locking.counter), 0);
+    naInitAtomic32(&(locking.phaseErrorCount), 0);
+    naInitAtomic32(&(locking.serialCount), 0);
+    runTestThreads(na_RunTestBarrierPhases, &locking, NA_TEST_THREAD_COUNT);
+    naTest(naLoadAtomic32(&(locking.phaseErrorCount), NA_MEMORY_ORDER_RELAXED) == 0);
+    naTest(naLoadAtomic32(&(locking.serialCount), NA_MEMORY_ORDER_RELAXED) == 10);
+    naClearBarrier(locking.barrier);
+
+    // A barrier for one thread never waits.
+    locking.barrier = naMakeBarrier(1);
+    naTest(naWaitBarrier(locking.barrier));
+    naTest(naWaitBarrier(locking.barrier));
+    naClearBarrier(locking.barrier);
+  }
+
+  naTestGroup("Latch"){
+    locking.latch = naMakeLatch(NA_TEST_THREAD_COUNT);
+    naInitAtomic32(&(locking.counter), 0);
+    runTestThreads(na_CountDownTestLatch, &locking, NA_TEST_THREAD_COUNT);
+    naWaitLatch(locking.latch);
+    naTest(naLoadAtomic32(&(locking.counter), NA_MEMORY_ORDER_RELAXED) == NA_TEST_THREAD_COUNT);
+    naTestVoid(naWaitLatch(locking.latch));
+    naClearLatch(locking.latch);
+
+    locking.latch = naMakeLatch(0);
+    naTestVoid(naWaitLatch(locking.latch));
+    naClearLatch(locking.latch);
+  }
+}
+
+
+
+void testNAThreading(void){
+  naTestFunction(testThreadPool);
+  naTestFunction(testParallelLoops);
+  naTestFunction(testLocking);
+}
+
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>
@@ -9,6 +9,7 @@ void printNABuffer(void);
 void printNAStack(void);
 
 void testNABuffer(void);
+void testNARing(void);
 void testNAStack(void);
 
 void benchmarkNAStack(void);
@@ -20,6 +21,7 @@ void printNAStruct(void){
 
 void testNAStruct(void){
   naTestFunction(testNABuffer);
+  naTestFunction(testNARing);
   naTestFunction(testNAStack);
 }
 
@@ -274,11 +274,564 @@ void testBufferPart(void){
 
 
 
+// Creates a buffer reading the file positionally, just like
+// naCreateBufferWithInputPath does for files which can not be mapped.
+NABuffer* createBufferReadingFile(const char* filePath){
+  NAFile* file = naCreateFileReadingPath(filePath);
+  NAFileSize byteSize = naComputeFileByteSize(file);
+  NABuffer* buffer = naCreateBufferWithCustomSource(na_CreateBufferSourceWithFileReading(file, (size_t)byteSize), 0);
+  na_EnsureBufferRange(buffer, 0, (NAInt)byteSize);
+  naFixBufferRange(buffer);
+  return buffer;
+}
+
+NABool isBufferFileContent(const NAByte* bytes, NAInt offset, NAInt byteCount){
+  NABool correct = NA_TRUE;
+  NAInt i;
+  for(i = 0; i < byteCount; i++){
+    correct = correct && bytes[i] == (NAByte)((offset + i) * 31 + ((offset + i) >> 8));
+  }
+  return correct;
+}
+
+void testBufferFile(void){
+  const char* filePath = "testNABufferFile.bin";
+  NAByte data[10000];
+  NAInt i;
+  NAFile* file;
+  for(i = 0; i < 10000; i++){
+    data[i] = (NAByte)(i * 31 + (i >> 8));
+  }
+  file = naCreateFileWritingPath(filePath, NA_FILEMODE_DEFAULT);
+  naWriteFileBytes(file, data, 10000);
+  naReleaseFile(file);
+
+  naTestGroup("Reading a file at positions"){
+    NAByte buf[4];
+    file = naCreateFileReadingPath(filePath);
+    naTest(naReadFileBytesAt(file, buf, 4, 9000) == 4 && buf[0] == data[9000] && buf[3] == data[9003]);
+    naTest(naReadFileBytesAt(file, buf, 4, 10) == 4 && buf[0] == data[10]);
+    naTest(naReadFileBytesAt(file, buf, 4, 9998) == 2 && buf[1] == data[9999]);
+    naTest(naReadFileBytesAt(file, buf, 4, 20000) == 0);
+    naReleaseFile(file);
+  }
+
+  naTestGroup("Reading a file buffer in any order"){
+    NABuffer* buffer = naCreateBufferWithInputPath(filePath);
+    NABufferIterator iter = naMakeBufferAccessor(buffer);
+    naTest(naGetBufferRange(buffer).length == 10000);
+    naLocateBufferAbsolute(&iter, 9999);
+    naTest(naReadBufferu8(&iter) == data[9999]);
+    naLocateBufferAbsolute(&iter, 5000);
+    naTest(naReadBufferu8(&iter) == data[5000]);
+    naLocateBufferAbsolute(&iter, 3);
+    naTest(naReadBufferu8(&iter) == data[3]);
+    naClearBufferIterator(&iter);
+    naRelease(buffer);
+  }
+
+  naTestGroup("Reading a file buffer without mapping"){
+    NAByte buf[20];
+    NAByte* copy = naMalloc(10000);
+    NABuffer* buffer = createBufferReadingFile(filePath);
+    NABufferIterator iter = naMakeBufferAccessor(buffer);
+    naTest(naGetBufferRange(buffer).length == 10000);
+    naLocateBufferAbsolute(&iter, 5000);
+    naTest(naReadBufferu8(&iter) == data[5000]);
+    naLocateBufferAbsolute(&iter, 4990);
+    naReadBufferBytes(&iter, buf, 20);
+    naTest(isBufferFileContent(buf, 4990, 20));
+    naLocateBufferAbsolute(&iter, 9990);
+    naReadBufferBytes(&iter, buf, 10);
+    naTest(isBufferFileContent(buf, 9990, 10));
+    naLocateBufferAbsolute(&iter, 3);
+    naTest(naReadBufferu8(&iter) == data[3]);
+    naLocateBufferAbsolute(&iter, 0);
+    naReadBufferBytes(&iter, buf, 20);
+    naTest(isBufferFileContent(buf, 0, 20));
+    naClearBufferIterator(&iter);
+    naWriteBufferToData(buffer, copy);
+    naTest(isBufferFileContent(copy, 0, 10000));
+    naRelease(buffer);
+    naFree(copy);
+  }
+
+  naTestGroup("Prefetching a file buffer"){
+    NABuffer* buffer = naCreateBufferWithInputPath(filePath);
+    NABufferIterator iter = naMakeBufferAccessor(buffer);
+    naTestVoid(naPrefetchBufferRange(buffer, naMakeRangei(4000, 6000)));
+    naLocateBufferAbsolute(&iter, 9000);
+    naTest(naReadBufferu8(&iter) == data[9000]);
+    naClearBufferIterator(&iter);
+    naTestVoid(naPrefetchBufferRange(buffer, naMakeRangei(0, 10000)));
+    naRelease(buffer);
+  }
+
+  naTestGroup("Writing a buffer of many parts to a file"){
+    NAByte buf[4];
+    NABuffer* buffer = naCreateBuffer(NA_FALSE);
+    NABufferIterator iter = naMakeBufferModifier(buffer);
+    for(i = 0; i < 1000; i++){
+      naWriteBufferu8(&iter, data[i * 10]);
+      naWriteBufferBytes(&iter, &(data[i * 10 + 1]), 9);
+    }
+    naClearBufferIterator(&iter);
+    naFixBufferRange(buffer);
+    file = naCreateFileWritingPath(filePath, NA_FILEMODE_DEFAULT);
+    naTestVoid(naWriteBufferToFile(buffer, file));
+    naReleaseFile(file);
+    naRelease(buffer);
+    file = naCreateFileReadingPath(filePath);
+    naTest(naReadFileBytesAt(file, buf, 4, 9996) == 4 && buf[3] == data[9999]);
+    naTest(naReadFileBytesAt(file, buf, 4, 4000) == 4 && buf[0] == data[4000]);
+    naReleaseFile(file);
+  }
+
+  naTestGroup("Reading a big file buffer through the read-ahead windows"){
+    // More windows are needed than there are, hence some get replaced.
+    NAInt byteSize = (NA_BUFFER_FILE_READ_AHEAD_COUNT + 2) * NA_BUFFER_FILE_READ_AHEAD_BYTESIZE;
+    NAInt offsets[] = {5, 1, 3, 0, 4, 2, 5, 1};
+    NAByte* bigData = naMalloc((size_t)byteSize);
+    NAByte buf[20];
+    NABool correct = NA_TRUE;
+    NABuffer* buffer;
+    NABufferIterator iter;
+    for(i = 0; i < byteSize; i++){
+      bigData[i] = (NAByte)(i * 31 + (i >> 8));
+    }
+    file = naCreateFileWritingPath(filePath, NA_FILEMODE_DEFAULT);
+    naWriteFileBytes(file, bigData, byteSize);
+    naReleaseFile(file);
+
+    buffer = createBufferReadingFile(filePath);
+    iter = naMakeBufferAccessor(buffer);
+    for(i = 0; i < 8; i++){
+      // The offset is the start of a part, see NA_BUFFER_PART_BYTESIZE.
+      NAInt offset = offsets[i] * NA_BUFFER_FILE_READ_AHEAD_BYTESIZE + (NAInt)naGetSystemMemoryPagesize();
+      naLocateBufferAbsolute(&iter, offset);
+      naReadBufferBytes(&iter, buf, 20);
+      correct = correct && isBufferFileContent(buf, offset, 20);
+      // Step back into the part before which has not been read yet.
+      naLocateBufferAbsolute(&iter, offset - 10);
+      naReadBufferBytes(&iter, buf, 20);
+      correct = correct && isBufferFileContent(buf, offset - 10, 20);
+    }
+    naTest(correct);
+    naClearBufferIterator(&iter);
+    naWriteBufferToData(buffer, bigData);
+    naTest(isBufferFileContent(bigData, 0, byteSize));
+    naRelease(buffer);
+    naFree(bigData);
+  }
+
+  naRemove(filePath);
+}
+
+
+
+// Fills the bytes with a pattern only after a while such that prefetched
+// parts are still being filled when they are accessed.
+void na_SlowBufferFiller(void* dst, NARangei sourceRange, void* sourceData){
+  NAByte* bytes = (NAByte*)dst;
+  NAInt i;
+  NA_UNUSED(sourceData);
+  naSleepM(50);
+  for(i = 0; i < sourceRange.length; i++){
+    bytes[i] = (NAByte)((sourceRange.origin + i) * 7);
+  }
+}
+
+NABuffer* createPrefetchedSlowBuffer(void){
+  NABuffer* buffer;
+  NABufferSource* source = naCreateBufferSource(na_SlowBufferFiller, NA_NULL);
+  naSetBufferSourceLimit(source, naMakeRangei(0, 4000));
+  buffer = naCreateBufferWithCustomSource(source, 0);
+  naPrefetchBufferRange(buffer, naMakeRangei(0, 4000));
+  naFixBufferRange(buffer);
+  return buffer;
+}
+
+void testBufferPrefetch(void){
+  NAByte data[4000];
+  NAInt i;
+  for(i = 0; i < 4000; i++){
+    data[i] = (NAByte)(i * 7);
+  }
+
+  naTestGroup("Searching right after prefetching"){
+    NAByte pattern[4] = {88, 95, 102, 109};
+    NABuffer* buffer = createPrefetchedSlowBuffer();
+    naTest(naSearchBufferByteOffset(buffer, 21, 0, NA_TRUE) == 3);
+    naRelease(buffer);
+    buffer = createPrefetchedSlowBuffer();
+    naTest(naSearchBufferPattern(buffer, pattern, 4, 500) == 744);
+    naRelease(buffer);
+  }
+
+  naTestGroup("Reading bits right after prefetching"){
+    NABuffer* buffer = createPrefetchedSlowBuffer();
+    NABufferIterator iter = naMakeBufferAccessor(buffer);
+    naTest(naReadBufferBits32(&iter, 16) == 0x0700);
+    naTest(naReadBufferBits32(&iter, 16) == 0x150e);
+    naClearBufferIterator(&iter);
+    naRelease(buffer);
+  }
+
+  naTestGroup("Copying right after prefetching"){
+    NAByte copy[4000];
+    NABool correct = NA_TRUE;
+    NABuffer* buffer = createPrefetchedSlowBuffer();
+    naTestVoid(naWriteBufferToData(buffer, copy));
+    for(i = 0; i < 4000; i++){
+      correct = correct && copy[i] == data[i];
+    }
+    naTest(correct);
+    naRelease(buffer);
+    buffer = createPrefetchedSlowBuffer();
+    naTest(naEqualBufferToData(buffer, data, 4000, NA_TRUE));
+    naRelease(buffer);
+  }
+}
+
+
+
+void testBufferBits(void){
+  NABuffer* buffer = naCreateBuffer(NA_FALSE);
+  NABufferIterator iter = naMakeBufferModifier(buffer);
+  NAInt i;
+  // Write the bytes in small pieces to get many parts.
+  for(i = 0; i < 100; i++){
+    naWriteBufferu8(&iter, 0xa5);
+    naWriteBufferu8(&iter, 0x0f);
+    naWriteBufferu8(&iter, 0xc3);
+  }
+  naClearBufferIterator(&iter);
+  naFixBufferRange(buffer);
+
+  naTestGroup("Reading bits"){
+    iter = naMakeBufferAccessor(buffer);
+    naTest(naReadBufferBit(&iter) == NA_TRUE);
+    naTest(naReadBufferBit(&iter) == NA_FALSE);
+    naTest(naReadBufferBits32(&iter, 6) == 0x29);
+    naTest(naReadBufferBits32(&iter, 12) == 0x30f);
+    naTest(naReadBufferBits32(&iter, 32) == 0x5c30fa5c);
+    naClearBufferIterator(&iter);
+  }
+
+  naTestGroup("Peeking and consuming bits"){
+    iter = naMakeBufferAccessor(buffer);
+    naTest(naPeekBufferBits(&iter, 4) == 0x5);
+    naTest(naPeekBufferBits(&iter, 16) == 0x0fa5);
+    naTestVoid(naConsumeBufferBits(&iter, 4));
+    naTest(naPeekBufferBits(&iter, 8) == 0xfa);
+    naTestVoid(naRefillBufferBits(&iter));
+    naTestVoid(naConsumeBufferBits(&iter, 28));
+    naTest(naGetBufferCurBit(&iter) == 0);
+    naTest(naGetBufferLocation(&iter) == 4);
+    naTestError(naConsumeBufferBits(&iter, 64));
+    naClearBufferIterator(&iter);
+  }
+
+  naTestGroup("Mixing bits and bytes"){
+    iter = naMakeBufferAccessor(buffer);
+    naTest(naReadBufferBits32(&iter, 3) == 0x5);
+    naTestVoid(naPadBufferBits(&iter));
+    naTest(naReadBufferu8(&iter) == 0x0f);
+    naTest(naReadBufferBits32(&iter, 8) == 0xc3);
+    naLocateBufferAbsolute(&iter, 298);
+    naTest(naPeekBufferBits(&iter, 32) == 0xc30f);
+    naClearBufferIterator(&iter);
+  }
+
+  naTestGroup("Writing bits"){
+    NABuffer* bitBuffer = naCreateBuffer(NA_FALSE);
+    iter = naMakeBufferModifier(bitBuffer);
+    naTestVoid(naWriteBufferBits(&iter, 1, 1));
+    naTestVoid(naWriteBufferBits(&iter, 0x29, 6));
+    naTestVoid(naWriteBufferBits(&iter, 0x5c30fa5c, 32));
+    naTestVoid(naFlushBufferBits(&iter));
+    naTestVoid(naWriteBufferu8(&iter, 0x99));
+    naClearBufferIterator(&iter);
+    naTest(naGetBufferRange(bitBuffer).length == 6);
+    iter = naMakeBufferAccessor(bitBuffer);
+    naTest(naReadBufferu8(&iter) == 0x53);
+    naTest(naReadBufferu8(&iter) == 0x2e);
+    naLocateBufferAbsolute(&iter, 5);
+    naTest(naReadBufferu8(&iter) == 0x99);
+    naClearBufferIterator(&iter);
+    naRelease(bitBuffer);
+  }
+
+  naTestGroup("Writing a value wider than its bit count"){
+    // The value is written anyway, hence it gets a buffer of its own.
+    NABuffer* bitBuffer = naCreateBuffer(NA_FALSE);
+    iter = naMakeBufferModifier(bitBuffer);
+    naTestError(naWriteBufferBits(&iter, 0x10, 4));
+    naFlushBufferBits(&iter);
+    naClearBufferIterator(&iter);
+    naRelease(bitBuffer);
+  }
+
+  naRelease(buffer);
+}
+
+
+
+void testBufferSearch(void){
+  NABuffer* buffer = naCreateBuffer(NA_FALSE);
+  NABufferIterator iter = naMakeBufferModifier(buffer);
+  NAInt i;
+  // Write the text in small pieces such that words span multiple parts.
+  for(i = 0; i < 50; i++){
+    naWriteBufferBytes(&iter, "Hel", 3);
+    naWriteBufferBytes(&iter, "lo, world", 9);
+    naWriteBufferBytes(&iter, "!\n", 2);
+  }
+  naClearBufferIterator(&iter);
+  naFixBufferRange(buffer);
+
+  naTestGroup("Searching bytes"){
+    naTest(naSearchBufferByteOffset(buffer, 'H', 0, NA_TRUE) == 0);
+    naTest(naSearchBufferByteOffset(buffer, '\n', 0, NA_TRUE) == 13);
+    naTest(naSearchBufferByteOffset(buffer, 'H', 13, NA_FALSE) == 0);
+    naTest(naSearchBufferByteOffset(buffer, 'w', 699, NA_FALSE) == 693);
+    naTest(naSearchBufferByteOffset(buffer, 'x', 0, NA_TRUE) == NA_INVALID_MEMORY_INDEX);
+  }
+
+  naTestGroup("Searching patterns"){
+    naTest(naSearchBufferPattern(buffer, "Hello", 5, 0) == 0);
+    naTest(naSearchBufferPattern(buffer, "Hello", 5, 1) == 14);
+    naTest(naSearchBufferPattern(buffer, "!\nHel", 5, 0) == 12);
+    naTest(naSearchBufferPattern(buffer, "world!\n", 7, 694) == NA_INVALID_MEMORY_INDEX);
+    naTest(naSearchBufferPattern(buffer, "world!\n", 7, 600) == 609);
+    naTest(naSearchBufferPattern(buffer, "Hallo", 5, 0) == NA_INVALID_MEMORY_INDEX);
+  }
+
+  naRelease(buffer);
+}
+
+
+
+void testBufferLocation(void){
+  NABuffer* buffer = naCreateBuffer(NA_FALSE);
+  NABufferIterator iter = naMakeBufferModifier(buffer);
+  NAInt i;
+  // Every write creates a new part.
+  for(i = 0; i < 1000; i++){
+    naWriteBufferi32(&iter, (int32)i);
+  }
+  naClearBufferIterator(&iter);
+
+  naTestGroup("Locating in many parts"){
+    NABool correct = NA_TRUE;
+    iter = naMakeBufferAccessor(buffer);
+    for(i = 0; i < 1000; i++){
+      NAInt index = (i * 617) % 1000;
+      naLocateBufferAbsolute(&iter, index * 4);
+      correct = correct && naGetBufferLocation(&iter) == index * 4;
+      correct = correct && naReadBufferi32(&iter) == (int32)index;
+    }
+    naTest(correct);
+
+    correct = NA_TRUE;
+    naLocateBufferAbsolute(&iter, 0);
+    for(i = 0; i < 1000; i++){
+      correct = correct && naGetBufferLocation(&iter) == i * 4;
+      correct = correct && naReadBufferi32(&iter) == (int32)i;
+    }
+    naTest(correct);
+
+    naTest(naLocateBufferAbsolute(&iter, 3999));
+    naTest(!naLocateBufferAbsolute(&iter, 4000));
+    naTest(!naLocateBufferAbsolute(&iter, -1));
+    naClearBufferIterator(&iter);
+  }
+
+  naTestGroup("Locating after the parts changed"){
+    iter = naMakeBufferModifier(buffer);
+    naLocateBufferAbsolute(&iter, 2000);
+    naTest(naReadBufferi32(&iter) == 500);
+    naLocateBufferFromEnd(&iter, 0);
+    naWriteBufferi32(&iter, 1000);
+    naLocateBufferAbsolute(&iter, 4000);
+    naTest(naGetBufferLocation(&iter) == 4000);
+    naTest(naReadBufferi32(&iter) == 1000);
+    naClearBufferIterator(&iter);
+  }
+
+  naRelease(buffer);
+}
+
+
+
+// Fills the bytes with the same pattern as na_SlowBufferFiller but at once.
+void na_PatternBufferFiller(void* dst, NARangei sourceRange, void* sourceData){
+  NAByte* bytes = (NAByte*)dst;
+  NAInt i;
+  NA_UNUSED(sourceData);
+  for(i = 0; i < sourceRange.length; i++){
+    bytes[i] = (NAByte)((sourceRange.origin + i) * 7);
+  }
+}
+
+void testBufferCompaction(void){
+  NABuffer* buffer = naCreateBuffer(NA_FALSE);
+  NABufferIterator iter = naMakeBufferModifier(buffer);
+  NAInt i;
+  size_t partCount;
+  // Every write creates a new part. Clearing the iterator compacts the buffer
+  // if NA_BUFFER_COMPACT_PART_COUNT is set.
+  for(i = 0; i < 3000; i++){
+    naWriteBufferi32(&iter, (int32)i);
+  }
+  naClearBufferIterator(&iter);
+
+  naTestGroup("Reading after many small writes"){
+    NABool correct = NA_TRUE;
+    iter = naMakeBufferAccessor(buffer);
+    naTest(naGetBufferRange(buffer).length == 12000);
+    for(i = 0; i < 3000; i++){
+      correct = correct && naReadBufferi32(&iter) == (int32)i;
+    }
+    naTest(correct);
+    naLocateBufferAbsolute(&iter, 6000);
+    naTest(naReadBufferi32(&iter) == 1500);
+    naClearBufferIterator(&iter);
+  }
+
+  naTestGroup("Writing and reading after explicit compaction"){
+    NABool correct = NA_TRUE;
+    iter = naMakeBufferModifier(buffer);
+    naLocateBufferFromEnd(&iter, 0);
+    for(i = 3000; i < 3100; i++){
+      naWriteBufferi32(&iter, (int32)i);
+    }
+    naClearBufferIterator(&iter);
+    naTest(buffer->partCount >= 100);
+
+    // 12400 bytes in parts of at least 64 bytes each.
+    naCompactBuffer(buffer, 64);
+    naTest(buffer->partCount <= 12400 / 64 + 1);
+    partCount = buffer->partCount;
+    naCompactBuffer(buffer, 64);
+    naTest(buffer->partCount == partCount);
+
+    iter = naMakeBufferAccessor(buffer);
+    for(i = 0; i < 3100; i++){
+      correct = correct && naReadBufferi32(&iter) == (int32)i;
+    }
+    naTest(correct);
+    naTest(naIsBufferAtEnd(&iter));
+    naClearBufferIterator(&iter);
+  }
+
+  naRelease(buffer);
+
+  naTestGroup("Compacting around sparse parts"){
+    NABool correct = NA_TRUE;
+    NABufferSource* source = naCreateBufferSource(na_PatternBufferFiller, NA_NULL);
+    naSetBufferSourceLimit(source, naMakeRangei(0, 40000));
+    buffer = naCreateBufferWithCustomSource(source, 0);
+
+    // Two runs of small parts with the unread source bytes in between.
+    iter = naMakeBufferModifier(buffer);
+    for(i = 0; i < 100; i++){
+      naWriteBufferu8(&iter, (NAByte)i);
+    }
+    naLocateBufferAbsolute(&iter, 20000);
+    for(i = 0; i < 100; i++){
+      naWriteBufferu8(&iter, (NAByte)i);
+    }
+    naClearBufferIterator(&iter);
+    naTest(buffer->partCount > 200);
+
+    naCompactBuffer(buffer, 64);
+    naTest(buffer->partCount > 1);
+    naTest(buffer->partCount < 10);
+
+    iter = naMakeBufferAccessor(buffer);
+    for(i = 0; i < 100; i++){
+      correct = correct && naReadBufferu8(&iter) == (NAByte)i;
+    }
+    naLocateBufferAbsolute(&iter, 20000);
+    for(i = 0; i < 100; i++){
+      correct = correct && naReadBufferu8(&iter) == (NAByte)i;
+    }
+    naTest(correct);
+    // The sparse parts still get filled from the source.
+    naLocateBufferAbsolute(&iter, 10000);
+    naTest(naReadBufferu8(&iter) == (NAByte)(10000 * 7));
+    naLocateBufferAbsolute(&iter, 30000);
+    naTest(naReadBufferu8(&iter) == (NAByte)(30000 * 7));
+    naClearBufferIterator(&iter);
+    naRelease(buffer);
+  }
+
+  naTestGroup("Compacting parts shared with an appended buffer"){
+    NABool correct = NA_TRUE;
+    NABuffer* srcBuffer = naCreateBuffer(NA_FALSE);
+    buffer = naCreateBuffer(NA_FALSE);
+
+    iter = naMakeBufferModifier(srcBuffer);
+    for(i = 0; i < 100; i++){
+      naWriteBufferi32(&iter, (int32)i);
+    }
+    naClearBufferIterator(&iter);
+    iter = naMakeBufferModifier(buffer);
+    for(i = 0; i < 10; i++){
+      naWriteBufferi32(&iter, (int32)-i);
+    }
+    naClearBufferIterator(&iter);
+
+    naAppendBufferToBuffer(buffer, srcBuffer);
+    naTest(buffer->partCount == 110);
+    naTest(srcBuffer->partCount == 100);
+
+    // 440 bytes in parts of at least 64 bytes each.
+    naCompactBuffer(buffer, 64);
+    naTest(buffer->partCount <= 440 / 64 + 1);
+    naTest(srcBuffer->partCount == 100);
+
+    // The compacted buffer got copies, hence the source stays untouched.
+    iter = naMakeBufferModifier(buffer);
+    naLocateBufferAbsolute(&iter, 40);
+    naWriteBufferi32(&iter, 1234);
+    naClearBufferIterator(&iter);
+
+    iter = naMakeBufferAccessor(buffer);
+    for(i = 0; i < 10; i++){
+      correct = correct && naReadBufferi32(&iter) == (int32)-i;
+    }
+    correct = correct && naReadBufferi32(&iter) == 1234;
+    for(i = 1; i < 100; i++){
+      correct = correct && naReadBufferi32(&iter) == (int32)i;
+    }
+    naTest(correct);
+    naTest(naIsBufferAtEnd(&iter));
+    naClearBufferIterator(&iter);
+
+    correct = NA_TRUE;
+    iter = naMakeBufferAccessor(srcBuffer);
+    for(i = 0; i < 100; i++){
+      correct = correct && naReadBufferi32(&iter) == (int32)i;
+    }
+    naTest(correct);
+    naTest(naIsBufferAtEnd(&iter));
+    naClearBufferIterator(&iter);
+
+    naRelease(srcBuffer);
+    naRelease(buffer);
+  }
+}
+
+
+
 void printNABuffer(void){
   printf("NABuffer.h:" NA_NL);
 
   naPrintMacro(NA_BUFFER_SOURCE_RANGE_LIMITED);
   naPrintMacro(NA_INTERNAL_BUFFER_PART_BYTESIZE);
+  naPrintMacro(NA_BUFFER_COMPACT_PART_COUNT);
 
   printf(NA_NL);
 }
@@ -289,6 +842,12 @@ void testNABuffer(void){
   naTestFunction(testMemoryBlock);  
   naTestFunction(testBufferSource);  
   naTestFunction(testBufferPart);  
+  naTestFunction(testBufferFile);
+  naTestFunction(testBufferPrefetch);
+  naTestFunction(testBufferBits);
+  naTestFunction(testBufferSearch);
+  naTestFunction(testBufferLocation);
+  naTestFunction(testBufferCompaction);
 }
 
 
@@ -0,0 +1,219 @@
+#include "NATest.h"
+#include <stdio.h>
+
+#include "NAStruct/NARing.h"
+
+#include "NAUtility/NAAtomic.h"
+#include "NAUtility/NAThreading.h"
+
+#define NA_TEST_RING_ELEMENT_COUNT 100000
+#define NA_TEST_RING_PRODUCER_COUNT 4
+
+// See testNAThreading.c
+void runTestThreads(NAMutator function, void* arg, size_t threadCount);
+
+// The elements are numbers starting at 1 such that no element is Null.
+#define naMakeTestRingElement(i) ((void*)(size_t)((i) + 1))
+#define naGetTestRingElementIndex(element) ((size_t)(element) - 1)
+
+
+
+void testSPSCRing(void){
+  NASPSCRing ring;
+
+  naTestGroup("Initializing"){
+    naTestVoid(naInitSPSCRing(&ring, 100));
+    naTest(naGetSPSCRingCapacity(&ring) == 128);
+    naClearSPSCRing(&ring);
+    naTestVoid(naInitSPSCRing(&ring, 64));
+    naTest(naGetSPSCRingCapacity(&ring) == 64);
+  }
+
+  naTestGroup("Pushing and pulling in order"){
+    NABool correct = NA_TRUE;
+    void* element;
+    size_t i;
+    for(i = 0; i < 64; i++){
+      correct = correct && naTryPushSPSCRing(&ring, naMakeTestRingElement(i));
+    }
+    naTest(correct);
+    naTest(!naTryPushSPSCRing(&ring, naMakeTestRingElement(64)));
+    for(i = 0; i < 64; i++){
+      correct = correct && naTryPullSPSCRing(&ring, &element) && element == naMakeTestRingElement(i);
+    }
+    naTest(correct);
+    naTest(!naTryPullSPSCRing(&ring, &element));
+  }
+
+  naTestGroup("Pushing and pulling batches"){
+    void* elements[100];
+    void* pulled[100];
+    NABool correct = NA_TRUE;
+    size_t i;
+    for(i = 0; i < 100; i++){
+      elements[i] = naMakeTestRingElement(i);
+    }
+    naTest(naPushSPSCRingBatch(&ring, elements, 40) == 40);
+    naTest(naPushSPSCRingBatch(&ring, &(elements[40]), 60) == 24);
+    naTest(naPullSPSCRingBatch(&ring, pulled, 10) == 10);
+    naTest(naPullSPSCRingBatch(&ring, &(pulled[10]), 90) == 54);
+    naTest(naPullSPSCRingBatch(&ring, pulled, 90) == 0);
+    for(i = 0; i < 64; i++){
+      correct = correct && pulled[i] == elements[i];
+    }
+    naTest(correct);
+  }
+
+  naClearSPSCRing(&ring);
+}
+
+
+
+typedef struct NATestSPSCRing NATestSPSCRing;
+struct NATestSPSCRing{
+  NASPSCRing ring;
+  NAAtomic32 threadIndex;
+  NABool correct;
+};
+
+// The first thread pushes, the second one pulls and checks the order.
+void na_RunTestSPSCRing(void* arg){
+  NATestSPSCRing* testRing = (NATestSPSCRing*)arg;
+  size_t i;
+  if(naFetchAddAtomic32(&(testRing->threadIndex), 1, NA_MEMORY_ORDER_RELAXED) == 0){
+    for(i = 0; i < NA_TEST_RING_ELEMENT_COUNT; i++){
+      naPushSPSCRing(&(testRing->ring), naMakeTestRingElement(i));
+    }
+  }else{
+    for(i = 0; i < NA_TEST_RING_ELEMENT_COUNT; i++){
+      testRing->correct = testRing->correct && naPullSPSCRing(&(testRing->ring)) == naMakeTestRingElement(i);
+    }
+  }
+}
+
+void testSPSCRingBlocking(void){
+  naTestGroup("Pushing and pulling on two threads"){
+    NATestSPSCRing testRing;
+    naInitSPSCRing(&(testRing.ring), 16);
+    naInitAtomic32(&(testRing.threadIndex), 0);
+    testRing.correct = NA_TRUE;
+    runTestThreads(na_RunTestSPSCRing, &testRing, 2);
+    naTest(testRing.correct);
+    naClearSPSCRing(&(testRing.ring));
+  }
+}
+
+
+
+typedef struct NATestMPMCRing NATestMPMCRing;
+struct NATestMPMCRing{
+  NAMPMCRing ring;
+  NAAtomic32 threadIndex;
+  NABool correct;
+};
+
+// The first thread pulls, all others push their own sequence with the
+// producer stored in the lowest digit of the elements. The elements of every
+// single producer must arrive in order.
+void na_RunTestMPMCRing(void* arg){
+  NATestMPMCRing* testRing = (NATestMPMCRing*)arg;
+  size_t threadIndex = (size_t)naFetchAddAtomic32(&(testRing->threadIndex), 1, NA_MEMORY_ORDER_RELAXED);
+  size_t i;
+  if(threadIndex == 0){
+    size_t nextIndex[NA_TEST_RING_PRODUCER_COUNT] = {0};
+    for(i = 0; i < NA_TEST_RING_ELEMENT_COUNT; i++){
+      size_t index = naGetTestRingElementIndex(naPullMPMCRing(&(testRing->ring)));
+      size_t producer = index % NA_TEST_RING_PRODUCER_COUNT;
+      testRing->correct = testRing->correct && index / NA_TEST_RING_PRODUCER_COUNT == nextIndex[producer];
+      nextIndex[producer]++;
+    }
+  }else{
+    size_t producer = threadIndex - 1;
+    for(i = 0; i < NA_TEST_RING_ELEMENT_COUNT / NA_TEST_RING_PRODUCER_COUNT; i++){
+      naPushMPMCRing(&(testRing->ring), naMakeTestRingElement(i * NA_TEST_RING_PRODUCER_COUNT + producer));
+    }
+  }
+}
+
+void testMPMCRing(void){
+  NATestMPMCRing testRing;
+  naInitMPMCRing(&(testRing.ring), 100);
+
+  naTestGroup("Pushing and pulling in order"){
+    NABool correct = NA_TRUE;
+    void* element;
+    size_t i;
+    naTest(naGetMPMCRingCapacity(&(testRing.ring)) == 128);
+    for(i = 0; i < 128; i++){
+      correct = correct && naTryPushMPMCRing(&(testRing.ring), naMakeTestRingElement(i));
+    }
+    naTest(correct);
+    naTest(!naTryPushMPMCRing(&(testRing.ring), naMakeTestRingElement(128)));
+    for(i = 0; i < 128; i++){
+      correct = correct && naTryPullMPMCRing(&(testRing.ring), &element) && element == naMakeTestRingElement(i);
+    }
+    naTest(correct);
+    naTest(!naTryPullMPMCRing(&(testRing.ring), &element));
+  }
+
+  naTestGroup("Pushing and pulling batches"){
+    void* elements[200];
+    void* pulled[200];
+    NABool correct = NA_TRUE;
+    size_t i;
+    for(i = 0; i < 200; i++){
+      elements[i] = naMakeTestRingElement(i);
+    }
+    naTest(naPushMPMCRingBatch(&(testRing.ring), elements, 200) == 128);
+    naTest(naPullMPMCRingBatch(&(testRing.ring), pulled, 200) == 128);
+    for(i = 0; i < 128; i++){
+      correct = correct && pulled[i] == elements[i];
+    }
+    naTest(correct);
+  }
+
+  naTestGroup("Pulling while multiple threads push"){
+    naInitAtomic32(&(testRing.threadIndex), 0);
+    testRing.correct = NA_TRUE;
+    runTestThreads(na_RunTestMPMCRing, &testRing, NA_TEST_RING_PRODUCER_COUNT + 1);
+    naTest(testRing.correct);
+  }
+
+  naClearMPMCRing(&(testRing.ring));
+}
+
+
+
+void testNARing(void){
+  naTestFunction(testSPSCRing);
+  naTestFunction(testSPSCRingBlocking);
+  naTestFunction(testMPMCRing);
+}
+
+
+
+
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+// For more information, please refer to <http://unlicense.org/>